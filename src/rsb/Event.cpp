@@ -48,6 +48,7 @@ public:
     ScopePtr scope;
 
     VoidPtr content;
+    Event::DataLoader loader;
 
     // is this a single type, a hierarchy or a set?
     std::string type;
@@ -142,9 +143,18 @@ Scope Event::getScope() const {
 
 void Event::setData(VoidPtr data) {
     d->content = data;
+    d->loader.clear();
+}
+
+void Event::setDataLoader(const DataLoader& loader) {
+    d->content.reset();
+    d->loader = loader;
 }
 
 VoidPtr Event::getData() {
+    if (d->loader) {
+        return d->loader();
+    }
     return d->content;
 }
 
@@ -34,6 +34,7 @@
 #include <boost/cstdint.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <boost/function.hpp>
 
 #include <rsc/misc/langutils.h>
 #include <rsc/misc/UUID.h>
@@ -125,6 +126,27 @@ public:
     VoidPtr getData();
     void setData(VoidPtr d);
 
+    /**
+     * Function which produces the payload of an event on demand.
+     */
+    typedef boost::function<VoidPtr ()> DataLoader;
+
+    /**
+     * Installs @a loader as the source of the payload of this
+     * event. The payload is only produced when it is requested via
+     * @ref getData. This allows transports to defer deserialization
+     * until the payload is actually needed, for example after
+     * filters which do not inspect the payload accepted the event.
+     *
+     * @a loader may be called multiple times and from multiple
+     * threads; it is responsible for producing the payload only
+     * once. Copies of this event share @a loader. A subsequent call
+     * to @ref setData replaces @a loader.
+     *
+     * @param loader The function producing the payload.
+     */
+    void setDataLoader(const DataLoader& loader);
+
     /**
      * Events are often caused by other events, which e.g. means that their
      * contained payload was calculated on the payload of one or more other
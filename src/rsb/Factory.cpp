@@ -27,6 +27,7 @@
 
 #include "Factory.h"
 
+#include <boost/lexical_cast.hpp>
 #include <boost/filesystem/fstream.hpp>
 
 #include <rsc/config/Configuration.h>
@@ -40,6 +41,7 @@
 #include <rsb/Version.h>
 
 #include "eventprocessing/strategies.h"
+#include "eventprocessing/ParallelEventReceivingStrategy.h"
 
 #include "converter/converters.h"
 #include "converter/Repository.h"
@@ -150,6 +152,23 @@ prepareConnectorOptions(const rsb::ParticipantConfig::Transport& config,
     return options;
 }
 
+/**
+ * Handles process-wide event processing options, currently
+ * eventprocessing.executor.threads.
+ */
+class ExecutorConfigurator: public OptionHandler {
+public:
+    void handleOption(const vector<string>& key, const string& value) {
+        if ((key.size() == 3)
+            && (key[0] == "eventprocessing")
+            && (key[1] == "executor")
+            && (key[2] == "threads")) {
+            rsb::eventprocessing::ParallelEventReceivingStrategy::setExecutorThreads(
+                boost::lexical_cast<unsigned int>(value));
+        }
+    }
+};
+
 }
 
 namespace rsb {
@@ -245,6 +264,14 @@ Factory::Factory() :
     }
     factoryWhileLoadingPlugins = NULL;
 
+    // Configure executors shared by event receiving strategies.
+    {
+        ConfigDebugPrinter printer("event processing", debugConfig);
+
+        ExecutorConfigurator configurator;
+        provideConfigOptions("RSB_", configurator);
+    }
+
     // Setup default participant config
     //
     // Collect all available connector implementations:
@@ -26,6 +26,8 @@
 
 #include "Handler.h"
 
+#include <stdexcept>
+
 using namespace std;
 
 namespace rsb {
@@ -69,4 +71,25 @@ void EventFunctionHandler::handle(EventPtr event) {
     this->function(event);
 }
 
+BatchHandler::BatchHandler(unsigned int  maxBatchSize,
+                           unsigned int  maxDelay,
+                           const string& method) :
+    Handler(method), maxBatchSize(maxBatchSize), maxDelay(maxDelay) {
+    if (maxBatchSize == 0) {
+        throw invalid_argument("Maximum batch size has to be at least 1.");
+    }
+}
+
+unsigned int BatchHandler::getMaxBatchSize() const {
+    return this->maxBatchSize;
+}
+
+unsigned int BatchHandler::getMaxDelay() const {
+    return this->maxDelay;
+}
+
+void BatchHandler::handle(EventPtr event) {
+    handleBatch(EventBatch(1, event));
+}
+
 }
@@ -27,6 +27,7 @@
 #pragma once
 
 #include <set>
+#include <vector>
 
 #include <boost/shared_ptr.hpp>
 #include <boost/function.hpp>
@@ -167,6 +168,56 @@ public:
 
 };
 
+/**
+ * A handler which receives events in batches.
+ *
+ * Event receiving strategies which queue events (such as the parallel
+ * strategy) deliver up to @ref getMaxBatchSize queued events in one
+ * call of @ref handleBatch. If fewer events are queued, they wait at
+ * most @ref getMaxDelay milliseconds for the batch to fill up. Other
+ * strategies call @ref handle for each event, which delivers a batch
+ * of a single event.
+ *
+ * @author jmoringe
+ */
+class RSB_EXPORT BatchHandler: public Handler {
+public:
+    typedef std::vector<EventPtr> EventBatch;
+
+    unsigned int getMaxBatchSize() const;
+    unsigned int getMaxDelay() const;
+
+    /**
+     * Handles the events in @a events in order.
+     *
+     * @param events A non-empty list of events.
+     */
+    virtual void handleBatch(const EventBatch& events) = 0;
+
+    void handle(EventPtr event);
+
+protected:
+    /**
+     * @param maxBatchSize Maximum number of events in one batch. Has
+     *                     to be at least 1.
+     * @param maxDelay Maximum time in milliseconds for which the
+     *                 first event of a batch waits for more
+     *                 events. @c 0 means batches contain whatever is
+     *                 queued when the handler becomes available.
+     * @param method the accepted method of this handler or empty
+     *               string for all methods
+     */
+    explicit BatchHandler(unsigned int       maxBatchSize,
+                          unsigned int       maxDelay = 0,
+                          const std::string& method   = "");
+
+private:
+    unsigned int maxBatchSize;
+    unsigned int maxDelay;
+};
+
+typedef boost::shared_ptr<BatchHandler> BatchHandlerPtr;
+
 /**
  * A utility class that forwards events to another @ref rsb::Handler
  * object if they match a given @ref rsb::filter::Filter.
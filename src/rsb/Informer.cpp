@@ -41,7 +41,7 @@ InformerBase::InformerBase(const vector<transport::OutConnectorPtr>& connectors,
                            const ParticipantConfig&                  config,
                            const string&                             defaultType) :
     Participant(scope, config), defaultType(defaultType),
-    configurator(new eventprocessing::OutRouteConfigurator(scope)),
+    configurator(new eventprocessing::OutRouteConfigurator(scope, config)),
     currentSequenceNumber(0) {
     // TODO evaluate configuration
     for (vector<transport::OutConnectorPtr>::const_iterator it =
@@ -106,7 +106,18 @@ EventPtr InformerBase::publish(EventPtr event) {
     return event;
 }
 
+InformerBase::CompletionFuturePtr InformerBase::publishAsync(EventPtr event) {
+    checkEvent(event);
+    event->setId(getId(), nextSequenceNumber());
+    return configurator->publishWithCompletion(event);
+}
+
 void InformerBase::checkedPublish(EventPtr event) {
+    checkEvent(event);
+    this->uncheckedPublish(event);
+}
+
+void InformerBase::checkEvent(EventPtr event) {
     if (event->getType().empty()) {
         throw invalid_argument(
                 boost::str(
@@ -130,8 +141,6 @@ void InformerBase::checkedPublish(EventPtr event) {
                                 "Specified event scope %1% does not match informer scope %2%.")
                                 % event->getScopePtr() % getScope()));
     }
-
-    this->uncheckedPublish(event);
 }
 
 void InformerBase::uncheckedPublish(EventPtr event) {
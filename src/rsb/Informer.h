@@ -199,8 +199,36 @@ public:
      */
     EventPtr publish(EventPtr event);
 
+    /**
+     * Shared pointer to a future which receives a published event
+     * once it has been passed to all transports.
+     */
+    typedef eventprocessing::EventSendingStrategy::CompletionFuturePtr
+        CompletionFuturePtr;
+
+    /**
+     * Like @ref publish but returns a future which is completed once
+     * @a event has been passed to all transports. With the "async"
+     * event sending strategy, this happens in a background thread and
+     * the future receives the copy of @a event which has been sent,
+     * including its send time. Transport errors are reported via the
+     * future instead of being thrown. With other strategies, the
+     * returned future is already completed.
+     *
+     * @param event The event to publish.
+     * @return A future receiving the sent event.
+     * @throw std::invalid_argument If the type of the payload of @a
+     *                              event is incompatible with the
+     *                              actual type of the informer or if
+     *                              the scope of @a event is not a
+     *                              subscope of the scope of the
+     *                              informer.
+     */
+    CompletionFuturePtr publishAsync(EventPtr event);
+
 protected:
     void checkedPublish(EventPtr event);
+    void checkEvent(EventPtr event);
     void uncheckedPublish(EventPtr event);
 
     boost::uint32_t nextSequenceNumber();
@@ -339,6 +339,9 @@ void ParticipantConfig::handleOption(const vector<string>& key,
             strategy = &this->eventReceivingStrategy;
         } else if (key[1] == "sendingstrategy") {
             strategy = &this->eventSendingStrategy;
+        } else if (key[1] == "executor") {
+            // Process-wide option, handled by the Factory.
+            return;
         } else {
             throw invalid_argument(
                 str(format("`%2%' is not a valid sub-key of `%1%'.")
@@ -31,6 +31,9 @@
 #include <iterator>
 
 #include <boost/format.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/thread/mutex.hpp>
 
 using namespace std;
 
@@ -119,6 +122,7 @@ Scope::Scope(const string& s) :
     // realistic scopes. This speeds up parsing.
     components.reserve(10);
     verifyAndSplit(s, this->components, this->scopestring);
+    this->hash = boost::hash_value(this->scopestring);
 }
 
 Scope::Scope(const char *scope) :
@@ -127,10 +131,11 @@ Scope::Scope(const char *scope) :
     // realistic scopes. This speeds up parsing.
     components.reserve(10);
     verifyAndSplit(string(scope), this->components, this->scopestring);
+    this->hash = boost::hash_value(this->scopestring);
 }
 
 Scope::Scope() :
-        scopestring("/") {
+        scopestring("/"), hash(boost::hash_value(this->scopestring)) {
 }
 
 Scope::~Scope() {
@@ -144,6 +149,10 @@ const std::string& Scope::toString() const {
     return this->scopestring;
 }
 
+size_t Scope::getHash() const {
+    return this->hash;
+}
+
 Scope Scope::concat(const Scope& childScope) const {
     Scope result; // start with empty string cache
     result.components = this->components;
@@ -158,33 +167,16 @@ Scope Scope::concat(const Scope& childScope) const {
 }
 
 bool Scope::isSubScopeOf(const Scope& other) const {
-
-    if (components.size() <= other.components.size()) {
-        return false;
-    }
-
-    for (size_t i = 0; i < other.components.size(); ++i) {
-        if (components[i] != other.components[i]) {
-            return false;
-        }
-    }
-
-    return true;
+    // Normalized string representations end with a separator, so
+    // other is a super-scope if and only if its string
+    // representation is a proper prefix of ours.
+    return (this->scopestring.size() > other.scopestring.size())
+        && (this->scopestring.compare(0, other.scopestring.size(),
+                                      other.scopestring) == 0);
 }
 
 bool Scope::isSuperScopeOf(const Scope& other) const {
-
-    if (components.size() >= other.components.size()) {
-        return false;
-    }
-
-    for (size_t i = 0; i < components.size(); ++i) {
-        if (components[i] != other.components[i]) {
-            return false;
-        }
-    }
-
-    return true;
+    return other.isSubScopeOf(*this);
 }
 
 void Scope::updateStringCache() {
@@ -203,6 +195,8 @@ void Scope::updateStringCache() {
         cursor += it->size();
         *cursor++ = COMPONENT_SEPARATOR;
     }
+
+    this->hash = boost::hash_value(this->scopestring);
 }
 
 vector<Scope> Scope::superScopes(const bool& includeSelf) const {
@@ -235,6 +229,15 @@ vector<Scope> Scope::superScopes(const bool& includeSelf) const {
 }
 
 bool Scope::operator==(const Scope& other) const {
+    // Interned scopes are frequently compared with themselves. Hash
+    // values allow rejecting most unequal scopes without comparing
+    // strings.
+    if (this == &other) {
+        return true;
+    }
+    if (this->hash != other.hash) {
+        return false;
+    }
     return toString() == other.toString();
 }
 
@@ -242,6 +245,35 @@ bool Scope::operator<(const Scope& other) const {
     return toString() < other.toString();
 }
 
+// Maximum number of scopes in the cache used by internScope. Bounds
+// the memory consumption for applications which use many distinct
+// scopes.
+static const size_t MAX_INTERNED_SCOPES = 10000;
+
+ScopePtr internScope(const string& scope) {
+    typedef boost::unordered_map<string, ScopePtr> ScopeCache;
+    static boost::mutex mutex;
+    static ScopeCache cache;
+
+    {
+        boost::mutex::scoped_lock lock(mutex);
+        ScopeCache::const_iterator it = cache.find(scope);
+        if (it != cache.end()) {
+            return it->second;
+        }
+    }
+
+    // Parse outside of the lock. Invalid scopes throw before
+    // anything is inserted.
+    ScopePtr result(new Scope(scope));
+
+    boost::mutex::scoped_lock lock(mutex);
+    if (cache.size() < MAX_INTERNED_SCOPES) {
+        result = cache.insert(make_pair(scope, result)).first->second;
+    }
+    return result;
+}
+
 ostream& operator<<(ostream& stream, const Scope& scope) {
     return stream << "Scope[" << scope.toString() << "]";
 }
@@ -91,6 +91,14 @@ public:
      */
     const std::string& toString() const;
 
+    /**
+     * Returns a hash value of the scope which is computed when the
+     * scope is constructed. Equal scopes have equal hash values.
+     *
+     * @return hash value of the scope
+     */
+    std::size_t getHash() const;
+
     /**
      * Creates a new scope that is a sub-scope of this one with the subordinated
      * scope described by the given argument. E.g. "/this/is/".concat("/a/test/")
@@ -148,11 +156,29 @@ private:
 
     std::string scopestring;
     std::vector<std::string> components;
+    std::size_t hash;
 
 };
 
 typedef boost::shared_ptr<Scope> ScopePtr;
 
+/**
+ * Returns a shared scope object for the string representation @a
+ * scope from a process-wide cache, parsing @a scope only if it has
+ * not been requested before. This avoids repeatedly parsing the same
+ * scope strings, e.g. in transports which receive many events on a
+ * limited number of scopes.
+ *
+ * The returned object is shared and must not be modified. The number
+ * of cached scopes is bounded; when the cache is full, a new object
+ * is returned for scopes that are not in the cache.
+ *
+ * @param scope string representation of the desired scope
+ * @return shared pointer to the scope object
+ * @throw std::invalid_argument invalid syntax
+ */
+RSB_EXPORT ScopePtr internScope(const std::string& scope);
+
 RSB_EXPORT std::ostream& operator<<(std::ostream& stream, const Scope& scope);
 
 }
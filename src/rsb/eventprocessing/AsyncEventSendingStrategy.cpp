@@ -0,0 +1,175 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#include "AsyncEventSendingStrategy.h"
+
+#include <stdexcept>
+
+#include <boost/bind.hpp>
+
+#include <rsc/runtime/ContainerIO.h>
+
+#include "../transport/OutConnector.h"
+
+using namespace std;
+
+using namespace rsc::logging;
+using namespace rsc::runtime;
+
+namespace rsb {
+namespace eventprocessing {
+
+EventSendingStrategy* AsyncEventSendingStrategy::create(const Properties& props) {
+    return new AsyncEventSendingStrategy(props.getAs<unsigned int>("queuecapacity", 0));
+}
+
+AsyncEventSendingStrategy::AsyncEventSendingStrategy(unsigned int queueCapacity) :
+    logger(Logger::getLogger("rsb.eventprocessing.AsyncEventSendingStrategy")),
+    queueCapacity(queueCapacity), sending(false), stopping(false) {
+    // Start the thread after all members have been initialized.
+    this->thread = boost::thread(boost::bind(&AsyncEventSendingStrategy::run, this));
+}
+
+AsyncEventSendingStrategy::~AsyncEventSendingStrategy() {
+    {
+        boost::mutex::scoped_lock lock(this->queueMutex);
+        this->stopping = true;
+    }
+    this->queueChanged.notify_all();
+    this->thread.join();
+}
+
+void AsyncEventSendingStrategy::printContents(ostream& stream) const {
+    size_t queued;
+    {
+        boost::mutex::scoped_lock lock(this->queueMutex);
+        queued = this->queue.size();
+    }
+    boost::mutex::scoped_lock lock(this->connectorsMutex);
+    stream << "connectors = " << this->connectors
+           << ", queueCapacity = " << this->queueCapacity
+           << ", queued = " << queued;
+}
+
+void AsyncEventSendingStrategy::addConnector(transport::OutConnectorPtr connector) {
+    boost::mutex::scoped_lock lock(this->connectorsMutex);
+    this->connectors.push_back(connector);
+}
+
+void AsyncEventSendingStrategy::removeConnector(transport::OutConnectorPtr connector) {
+    boost::mutex::scoped_lock lock(this->connectorsMutex);
+    this->connectors.remove(connector);
+}
+
+void AsyncEventSendingStrategy::process(EventPtr e) {
+    enqueue(e, CompletionFuturePtr());
+}
+
+EventSendingStrategy::CompletionFuturePtr
+AsyncEventSendingStrategy::processWithCompletion(EventPtr e) {
+    CompletionFuturePtr future(new CompletionFuture());
+    enqueue(e, future);
+    return future;
+}
+
+void AsyncEventSendingStrategy::enqueue(EventPtr e, CompletionFuturePtr future) {
+    // Connectors modify the event in the background thread while the
+    // caller may still access its event.
+    EventPtr copy(new Event(*e));
+    {
+        boost::mutex::scoped_lock lock(this->queueMutex);
+        while ((this->queueCapacity != 0)
+               && (this->queue.size() >= this->queueCapacity)
+               && !this->stopping) {
+            this->queueChanged.wait(lock);
+        }
+        if (this->stopping) {
+            throw runtime_error("Event sending strategy is shutting down.");
+        }
+        this->queue.push_back(make_pair(copy, future));
+    }
+    this->queueChanged.notify_all();
+}
+
+void AsyncEventSendingStrategy::flush() {
+    boost::mutex::scoped_lock lock(this->queueMutex);
+    while (!this->queue.empty() || this->sending) {
+        this->queueChanged.wait(lock);
+    }
+}
+
+void AsyncEventSendingStrategy::run() {
+    Queue batch;
+    while (true) {
+        {
+            boost::mutex::scoped_lock lock(this->queueMutex);
+            this->sending = false;
+            if (!batch.empty()) {
+                batch.clear();
+                this->queueChanged.notify_all();
+            }
+            while (this->queue.empty() && !this->stopping) {
+                this->queueChanged.wait(lock);
+            }
+            // Queued events are delivered even when stopping.
+            if (this->queue.empty()) {
+                return;
+            }
+            batch.swap(this->queue);
+            this->sending = true;
+        }
+        // Wakes up threads blocked on a full queue.
+        this->queueChanged.notify_all();
+
+        RSCTRACE(logger, "Sending batch of " << batch.size() << " event(s)");
+        for (Queue::const_iterator it = batch.begin(); it != batch.end(); ++it) {
+            send(*it);
+        }
+    }
+}
+
+void AsyncEventSendingStrategy::send(const Entry& entry) {
+    try {
+        {
+            boost::mutex::scoped_lock lock(this->connectorsMutex);
+            for (ConnectorList::const_iterator it = this->connectors.begin();
+                 it != this->connectors.end(); ++it) {
+                (*it)->handle(entry.first);
+            }
+        }
+        if (entry.second) {
+            entry.second->set(entry.first);
+        }
+    } catch (const std::exception& e) {
+        RSCERROR(logger, "Failed to send event " << entry.first << ": " << e.what());
+        if (entry.second) {
+            entry.second->setError(e.what());
+        }
+    }
+}
+
+}
+}
@@ -0,0 +1,119 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#pragma once
+
+#include <deque>
+#include <list>
+#include <utility>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <rsc/logging/Logger.h>
+#include <rsc/runtime/Properties.h>
+
+#include "../Event.h"
+#include "../transport/Connector.h"
+#include "EventSendingStrategy.h"
+
+#include "rsb/rsbexports.h"
+
+namespace rsb {
+namespace eventprocessing {
+
+/**
+ * This event sending strategy queues events and passes them to its
+ * associated @ref rsb::transport::OutConnector s in a background
+ * thread. Threads calling @ref process therefore do not block on
+ * serialization or socket writes.
+ *
+ * The background thread takes all queued events at once and sends
+ * them in order, so bursts of events cause a single wakeup. If a
+ * queue capacity is configured, @ref process blocks while the queue
+ * is full.
+ *
+ * Connectors modify the events they send, for example by setting the
+ * send time. Since the caller may still use its event, a copy of
+ * each event is queued and sent. The copy is passed to the futures
+ * returned by @ref processWithCompletion.
+ *
+ * @author jmoringe
+ */
+class RSB_EXPORT AsyncEventSendingStrategy: public EventSendingStrategy {
+public:
+    static EventSendingStrategy* create(const rsc::runtime::Properties& props);
+
+    /**
+     * @param queueCapacity Maximum number of queued events, @c 0
+     *                      means unbounded.
+     */
+    AsyncEventSendingStrategy(unsigned int queueCapacity = 0);
+
+    /**
+     * Delivers all queued events, then stops the background thread.
+     */
+    virtual ~AsyncEventSendingStrategy();
+
+    void printContents(std::ostream& stream) const;
+
+    void addConnector(transport::OutConnectorPtr connector);
+    void removeConnector(transport::OutConnectorPtr connector);
+
+    void process(EventPtr e);
+
+    CompletionFuturePtr processWithCompletion(EventPtr e);
+
+    void flush();
+private:
+    typedef std::list<transport::OutConnectorPtr> ConnectorList;
+    typedef std::pair<EventPtr, CompletionFuturePtr> Entry;
+    typedef std::deque<Entry>                     Queue;
+
+    void enqueue(EventPtr e, CompletionFuturePtr future);
+    void run();
+    void send(const Entry& entry);
+
+    rsc::logging::LoggerPtr logger;
+
+    ConnectorList         connectors;
+    mutable boost::mutex  connectorsMutex;
+
+    const unsigned int    queueCapacity;
+    mutable boost::mutex  queueMutex;
+    boost::condition      queueChanged;
+    Queue                 queue;
+    // Set while the background thread sends a batch of events.
+    bool                  sending;
+    bool                  stopping;
+
+    boost::thread         thread;
+};
+
+}
+}
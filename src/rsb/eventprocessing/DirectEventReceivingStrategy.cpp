@@ -26,6 +26,8 @@
 
 #include "DirectEventReceivingStrategy.h"
 
+#include <algorithm>
+
 #include <boost/thread/shared_mutex.hpp>
 #include <boost/thread/locks.hpp>
 
@@ -53,30 +55,31 @@ EventReceivingStrategy* DirectEventReceivingStrategy::create(const Properties& p
 DirectEventReceivingStrategy::DirectEventReceivingStrategy(bool singleThreaded) :
     logger(Logger::getLogger("rsb.eventprocessing.DirectEventReceivingStrategy")),
     errorStrategy(ParticipantConfig::ERROR_STRATEGY_LOG),
-    singleThreaded(singleThreaded) {
+    configuration(new Configuration()), singleThreaded(singleThreaded) {
 }
 
 DirectEventReceivingStrategy::~DirectEventReceivingStrategy() {
 }
 
 void DirectEventReceivingStrategy::printContents(ostream& stream) const {
-    boost::shared_lock<boost::shared_mutex> filtersLock(this->filtersMutex);
+    ConstConfigurationPtr configuration = getConfiguration();
     boost::shared_lock<boost::shared_mutex> errorLock(this->errorStrategyMutex);
-    stream << "filters = " << this->filters
+    stream << "filters = " << configuration->filters
            << ", errorStrategy = " << this->errorStrategy
            << ", singleThreaded = " << this->singleThreaded;
 }
 
-bool DirectEventReceivingStrategy::filter(EventPtr e) {
+bool DirectEventReceivingStrategy::filter(const FilterList& filters,
+                                          EventPtr          e) {
     // match event
     try {
-        if (this->singleThreaded) {
-            return filterNoLock(e);
-        } else {
-            boost::shared_lock<boost::shared_mutex> lock(filtersMutex);
-
-            return filterNoLock(e);
+        for (FilterList::const_iterator filterIt = filters.begin();
+             filterIt != filters.end(); ++filterIt) {
+            if (!(*filterIt)->match(e)) {
+                return false;
+            }
         }
+        return true;
     } catch (const std::exception& ex) {
 
         stringstream s;
@@ -102,16 +105,6 @@ bool DirectEventReceivingStrategy::filter(EventPtr e) {
 
 }
 
-bool DirectEventReceivingStrategy::filterNoLock(EventPtr e) {
-    for (set<filter::FilterPtr>::const_iterator filterIt =
-             filters.begin(); filterIt != filters.end(); ++filterIt) {
-        if (!(*filterIt)->match(e)) {
-            return false;
-        }
-    }
-    return true;
-}
-
 void DirectEventReceivingStrategy::handleDispatchError(const string& message) {
     boost::shared_lock<boost::shared_mutex> strategyLock(errorStrategyMutex);
 
@@ -167,37 +160,55 @@ void DirectEventReceivingStrategy::deliver(rsb::HandlerPtr handler, EventPtr e)
 }
 
 void DirectEventReceivingStrategy::handle(EventPtr event) {
+    // Handlers and filters are used without holding a lock since the
+    // snapshot is immutable.
+    ConstConfigurationPtr configuration = getConfiguration();
+
+    event->mutableMetaData().setDeliverTime(rsc::misc::currentTimeMicros());
+
+    if (filter(configuration->filters, event)) {
+        for (HandlerList::const_iterator it = configuration->handlers.begin();
+             it != configuration->handlers.end(); ++it)
+            deliver(*it, event);
+    }
+}
+
+DirectEventReceivingStrategy::ConstConfigurationPtr
+DirectEventReceivingStrategy::getConfiguration() const {
     if (this->singleThreaded) {
-        handleNoLock(event);
+        return this->configuration;
     } else {
-        boost::shared_lock<boost::shared_mutex> lock(this->handlerMutex);
-
-        handleNoLock(event);
+        return boost::atomic_load(&this->configuration);
     }
 }
 
-void DirectEventReceivingStrategy::handleNoLock(EventPtr event) {
-    event->mutableMetaData().setDeliverTime(rsc::misc::currentTimeMicros());
+DirectEventReceivingStrategy::ConfigurationPtr
+DirectEventReceivingStrategy::copyConfiguration() const {
+    return ConfigurationPtr(new Configuration(*getConfiguration()));
+}
 
-    if (filter(event)) {
-        for (HandlerList::const_iterator it = this->handlers.begin(); it
-                 != this->handlers.end(); ++it)
-            deliver(*it, event);
-    }
+void DirectEventReceivingStrategy::setConfiguration(ConstConfigurationPtr configuration) {
+    boost::atomic_store(&this->configuration, configuration);
 }
 
 void DirectEventReceivingStrategy::addHandler(rsb::HandlerPtr handler,
         const bool& /*wait*/) {
-    boost::shared_lock<boost::shared_mutex> lock(this->handlerMutex);
+    boost::mutex::scoped_lock lock(this->modificationMutex);
 
-    this->handlers.push_back(handler);
+    ConfigurationPtr configuration = copyConfiguration();
+    configuration->handlers.push_back(handler);
+    setConfiguration(configuration);
 }
 
 void DirectEventReceivingStrategy::removeHandler(rsb::HandlerPtr handler,
         const bool& /*wait*/) {
-    boost::shared_lock<boost::shared_mutex> lock(this->handlerMutex);
+    boost::mutex::scoped_lock lock(this->modificationMutex);
 
-    this->handlers.remove(handler);
+    ConfigurationPtr configuration = copyConfiguration();
+    HandlerList& handlers = configuration->handlers;
+    handlers.erase(remove(handlers.begin(), handlers.end(), handler),
+                   handlers.end());
+    setConfiguration(configuration);
 }
 
 void DirectEventReceivingStrategy::setHandlerErrorStrategy(const ParticipantConfig::ErrorStrategy& strategy) {
@@ -206,15 +217,24 @@ void DirectEventReceivingStrategy::setHandlerErrorStrategy(const ParticipantConf
 }
 
 void DirectEventReceivingStrategy::addFilter(filter::FilterPtr filter) {
-    boost::unique_lock<boost::shared_mutex> lock(filtersMutex);
+    boost::mutex::scoped_lock lock(this->modificationMutex);
 
-    this->filters.insert(filter);
+    ConfigurationPtr configuration = copyConfiguration();
+    FilterList& filters = configuration->filters;
+    if (find(filters.begin(), filters.end(), filter) == filters.end()) {
+        filters.push_back(filter);
+    }
+    setConfiguration(configuration);
 }
 
 void DirectEventReceivingStrategy::removeFilter(filter::FilterPtr filter) {
-    boost::unique_lock<boost::shared_mutex> lock(filtersMutex);
+    boost::mutex::scoped_lock lock(this->modificationMutex);
 
-    this->filters.erase(filter);
+    ConfigurationPtr configuration = copyConfiguration();
+    FilterList& filters = configuration->filters;
+    filters.erase(remove(filters.begin(), filters.end(), filter),
+                  filters.end());
+    setConfiguration(configuration);
 }
 
 }
@@ -26,10 +26,11 @@
 
 #pragma once
 
-#include <list>
-#include <set>
+#include <vector>
 #include <iostream>
 
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 #include <boost/thread/shared_mutex.hpp>
 
 #include <rsc/runtime/Properties.h>
@@ -52,6 +53,13 @@ namespace eventprocessing {
  * Even calls to @ref rsb::Handler s run in this thread, so stack
  * exhaustion and deadlocks are possible.
  *
+ * Since events are not queued, @ref rsb::BatchHandler s receive each
+ * event as a batch of one event.
+ *
+ * Handlers and filters are stored in an immutable snapshot which is
+ * replaced when handlers or filters are added or removed. Handling
+ * an event only requires loading the current snapshot atomically.
+ *
  * Additionally, all locking can be disabled for situation in which it
  * can be guaranteed that only one thread at a time calls any of the
  * classes methods.
@@ -79,29 +87,42 @@ public:
     void handle(EventPtr e);
 
 private:
-    typedef std::list<rsb::HandlerPtr> HandlerList;
+    typedef std::vector<rsb::HandlerPtr>   HandlerList;
+    typedef std::vector<filter::FilterPtr> FilterList;
+
+    struct Configuration {
+        HandlerList handlers;
+        FilterList  filters;
+    };
+    typedef boost::shared_ptr<Configuration>       ConfigurationPtr;
+    typedef boost::shared_ptr<const Configuration> ConstConfigurationPtr;
 
     // Qualification of HandlerPtr is required since there is another
     // HandlerPtr type in eventprocessing.
-    bool filter(EventPtr event);
+    bool filter(const FilterList& filters, EventPtr event);
     void deliver(rsb::HandlerPtr handler, EventPtr event);
 
     void handleDispatchError(const std::string& message);
 
-    bool filterNoLock(EventPtr e);
+    ConstConfigurationPtr getConfiguration() const;
 
-    void handleNoLock(EventPtr e);
+    /**
+     * Returns a copy of the current configuration for
+     * modification. Has to be called while holding @ref
+     * modificationMutex.
+     */
+    ConfigurationPtr copyConfiguration() const;
+    void setConfiguration(ConstConfigurationPtr configuration);
 
     rsc::logging::LoggerPtr logger;
 
-    mutable boost::shared_mutex filtersMutex;
-    std::set<filter::FilterPtr> filters;
-
     mutable boost::shared_mutex errorStrategyMutex;
     ParticipantConfig::ErrorStrategy errorStrategy;
 
-    mutable boost::shared_mutex handlerMutex;
-    HandlerList handlers;
+    // Accessed atomically unless singleThreaded is set.
+    ConstConfigurationPtr configuration;
+    // Serializes modifications of the configuration.
+    boost::mutex modificationMutex;
 
     bool singleThreaded;
 };
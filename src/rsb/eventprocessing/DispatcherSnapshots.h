@@ -0,0 +1,253 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#pragma once
+
+#include <list>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+
+namespace rsb {
+namespace eventprocessing {
+
+/**
+ * Holds immutable snapshots of a dispatcher of type @a Dispatcher,
+ * for example a @ref ScopeDispatcher, which are replaced when sinks
+ * are added or removed.
+ *
+ * Events are dispatched using the current snapshot without holding a
+ * lock while calling sinks (see @ref Dispatch). Therefore, dispatches
+ * which started before a sink has been removed may still call the
+ * sink afterwards. Callers which remove sinks use @ref
+ * waitForDispatches to wait for these dispatches to finish before
+ * the removed sink is torn down.
+ *
+ * Starting and finishing a dispatch only updates an atomic counter
+ * of the snapshot. The mutex of this object is only acquired when
+ * snapshots are replaced, when waiting for dispatches and when
+ * dispatches using a replaced snapshot finish.
+ *
+ * @author jmoringe
+ */
+template <typename Dispatcher>
+class DispatcherSnapshots: private boost::noncopyable {
+public:
+    typedef boost::shared_ptr<const Dispatcher> DispatcherPtr;
+private:
+    struct Snapshot {
+        Snapshot(DispatcherPtr dispatcher, boost::uint64_t generation) :
+            dispatcher(dispatcher), generation(generation), dispatches(0),
+            retired(false), waiting(0) {
+        }
+
+        DispatcherPtr               dispatcher;
+        boost::uint64_t             generation;
+        // Number of running dispatches using this snapshot.
+        boost::atomic<unsigned int> dispatches;
+        // Set when the snapshot has been replaced.
+        boost::atomic<bool>         retired;
+        // Number of dispatches using this snapshot whose threads are
+        // blocked in waitForDispatches. Protected by the mutex.
+        unsigned int                waiting;
+    };
+    typedef boost::shared_ptr<Snapshot> SnapshotPtr;
+public:
+
+    /**
+     * Uses the current snapshot for the lifetime of the object. The
+     * object must be destroyed by the thread which created it.
+     *
+     * @author jmoringe
+     */
+    class Dispatch: private boost::noncopyable {
+    public:
+        Dispatch(DispatcherSnapshots& snapshots) :
+            snapshots(snapshots) {
+            while (true) {
+                this->snapshot = boost::atomic_load(&this->snapshots.current);
+                ++this->snapshot->dispatches;
+                // A snapshot which has been replaced concurrently may
+                // already have been checked by waitForDispatches. The
+                // dispatch is therefore retried with the new snapshot.
+                if (!this->snapshot->retired) {
+                    break;
+                }
+                this->snapshots.finish(*this->snapshot);
+            }
+            this->snapshots.getThreadDispatches().push_back(this->snapshot.get());
+        }
+
+        ~Dispatch() {
+            this->snapshots.getThreadDispatches().pop_back();
+            this->snapshots.finish(*this->snapshot);
+        }
+
+        const Dispatcher& operator*() const {
+            return *this->snapshot->dispatcher;
+        }
+
+        const Dispatcher* operator->() const {
+            return this->snapshot->dispatcher.get();
+        }
+    private:
+        DispatcherSnapshots& snapshots;
+        SnapshotPtr          snapshot;
+    };
+
+    DispatcherSnapshots() :
+        current(new Snapshot(DispatcherPtr(new Dispatcher()), 0)) {
+    }
+
+    /**
+     * Returns the current snapshot.
+     *
+     * @return The current snapshot.
+     */
+    DispatcherPtr get() const {
+        return boost::atomic_load(&this->current)->dispatcher;
+    }
+
+    /**
+     * Replaces the current snapshot with @a dispatcher. Dispatches
+     * which started before are not affected.
+     *
+     * @param dispatcher The new snapshot.
+     * @return The generation of the new snapshot for use with @ref
+     *         waitForDispatches.
+     */
+    boost::uint64_t set(DispatcherPtr dispatcher) {
+        boost::mutex::scoped_lock lock(this->mutex);
+
+        SnapshotPtr previous = this->current;
+        SnapshotPtr snapshot(new Snapshot(dispatcher, previous->generation + 1));
+        boost::atomic_store(&this->current, snapshot);
+        previous->retired = true;
+
+        // Only retired snapshots which may still be in use are
+        // remembered.
+        this->retired.push_back(previous);
+        pruneRetired();
+
+        return snapshot->generation;
+    }
+
+    /**
+     * Waits until all dispatches using snapshots older than @a
+     * generation have finished.
+     *
+     * Dispatches of threads which are themselves blocked in this
+     * method, including the calling thread, are not waited for. This
+     * allows removing sinks while handling an event, even if handlers
+     * in several threads do so concurrently. Such dispatches may call
+     * removed sinks after they resume.
+     *
+     * Must not be called while holding a lock which is also acquired
+     * by sinks.
+     *
+     * @param generation A generation returned by @ref set.
+     */
+    void waitForDispatches(boost::uint64_t generation) {
+        std::vector<Snapshot*>& own = getThreadDispatches();
+
+        boost::mutex::scoped_lock lock(this->mutex);
+        for (typename std::vector<Snapshot*>::const_iterator it = own.begin();
+             it != own.end(); ++it) {
+            ++(*it)->waiting;
+        }
+        // Other waiting threads may now be able to proceed.
+        this->dispatchFinished.notify_all();
+
+        while (hasDispatches(generation)) {
+            this->dispatchFinished.wait(lock);
+        }
+
+        for (typename std::vector<Snapshot*>::const_iterator it = own.begin();
+             it != own.end(); ++it) {
+            --(*it)->waiting;
+        }
+        pruneRetired();
+    }
+private:
+    SnapshotPtr                                        current;
+    // Replaced snapshots which may still be in use.
+    std::list<SnapshotPtr>                             retired;
+    // Snapshots used by running dispatches of each thread.
+    boost::thread_specific_ptr<std::vector<Snapshot*> > threadDispatches;
+
+    boost::mutex                                       mutex;
+    boost::condition                                   dispatchFinished;
+
+    std::vector<Snapshot*>& getThreadDispatches() {
+        if (!this->threadDispatches.get()) {
+            this->threadDispatches.reset(new std::vector<Snapshot*>());
+        }
+        return *this->threadDispatches;
+    }
+
+    void finish(Snapshot& snapshot) {
+        // Notifying waiters is only required for replaced
+        // snapshots. Since the counter is decremented before checking
+        // the flag and set() sets the flag before waiters check the
+        // counter, a waiter cannot miss the notification.
+        --snapshot.dispatches;
+        if (snapshot.retired) {
+            boost::mutex::scoped_lock lock(this->mutex);
+            this->dispatchFinished.notify_all();
+        }
+    }
+
+    bool hasDispatches(boost::uint64_t generation) const {
+        for (typename std::list<SnapshotPtr>::const_iterator it
+                 = this->retired.begin(); it != this->retired.end(); ++it) {
+            if (((*it)->generation < generation)
+                && ((*it)->dispatches > (*it)->waiting)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void pruneRetired() {
+        for (typename std::list<SnapshotPtr>::iterator it = this->retired.begin();
+             it != this->retired.end();) {
+            if ((*it)->dispatches == 0) {
+                it = this->retired.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+};
+
+}
+}
@@ -0,0 +1,189 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#include "EventQueue.h"
+
+#include <stdexcept>
+
+using namespace std;
+
+namespace rsb {
+namespace eventprocessing {
+
+EventQueue::OverflowPolicy EventQueue::parseOverflowPolicy(const string& name) {
+    if (name == "block") {
+        return OVERFLOW_BLOCK;
+    } else if (name == "drop-oldest") {
+        return OVERFLOW_DROP_OLDEST;
+    } else if (name == "drop-newest") {
+        return OVERFLOW_DROP_NEWEST;
+    } else if (name == "keep-latest-per-scope") {
+        return OVERFLOW_KEEP_LATEST_PER_SCOPE;
+    } else {
+        throw invalid_argument("Invalid overflow policy `" + name + "'.");
+    }
+}
+
+EventQueue::EventQueue(unsigned int capacity, OverflowPolicy policy) :
+    capacity(capacity), policy(policy), removed(0), dropped(0), closed(false) {
+}
+
+unsigned int EventQueue::getCapacity() const {
+    return this->capacity;
+}
+
+EventQueue::OverflowPolicy EventQueue::getOverflowPolicy() const {
+    return this->policy;
+}
+
+bool EventQueue::isFull() const {
+    return (this->capacity != 0) && (this->queue.size() >= this->capacity);
+}
+
+bool EventQueue::isConflating() const {
+    // Only bounded queues conflate events, unbounded queues behave
+    // like ordinary queues.
+    return (this->policy == OVERFLOW_KEEP_LATEST_PER_SCOPE)
+        && (this->capacity != 0);
+}
+
+EventPtr EventQueue::popFront() {
+    EventPtr event = this->queue.front();
+    this->queue.pop_front();
+    ++this->removed;
+    if (isConflating()) {
+        // Each scope has at most one queued event, so the front event
+        // is the indexed one.
+        if (ScopePtr scope = event->getScopePtr()) {
+            this->scopeIndex.erase(*scope);
+        }
+    }
+    this->notFull.notify_one();
+    return event;
+}
+
+bool EventQueue::push(EventPtr event) {
+    boost::mutex::scoped_lock lock(this->mutex);
+
+    if (this->closed) {
+        return false;
+    }
+
+    switch (this->policy) {
+    case OVERFLOW_BLOCK:
+        while (isFull() && !this->closed) {
+            this->notFull.wait(lock);
+        }
+        if (this->closed) {
+            return false;
+        }
+        break;
+
+    case OVERFLOW_DROP_OLDEST:
+        if (isFull()) {
+            popFront();
+            ++this->dropped;
+        }
+        break;
+
+    case OVERFLOW_DROP_NEWEST:
+        if (isFull()) {
+            ++this->dropped;
+            return false;
+        }
+        break;
+
+    case OVERFLOW_KEEP_LATEST_PER_SCOPE:
+        if (isConflating()) {
+            ScopePtr scope = event->getScopePtr();
+            ScopeIndex::const_iterator it = scope
+                ? this->scopeIndex.find(*scope) : this->scopeIndex.end();
+            if (it != this->scopeIndex.end()) {
+                this->queue[it->second - this->removed] = event;
+                ++this->dropped;
+                return true;
+            }
+            if (isFull()) {
+                popFront();
+                ++this->dropped;
+            }
+            if (scope) {
+                this->scopeIndex[*scope] = this->removed + this->queue.size();
+            }
+        }
+        break;
+    }
+
+    this->queue.push_back(event);
+    this->notEmpty.notify_one();
+    return true;
+}
+
+EventPtr EventQueue::pop() {
+    boost::mutex::scoped_lock lock(this->mutex);
+
+    while (this->queue.empty() && !this->closed) {
+        this->notEmpty.wait(lock);
+    }
+    if (this->queue.empty()) {
+        return EventPtr();
+    }
+
+    return popFront();
+}
+
+EventPtr EventQueue::tryPop() {
+    boost::mutex::scoped_lock lock(this->mutex);
+
+    if (this->queue.empty()) {
+        return EventPtr();
+    }
+
+    return popFront();
+}
+
+size_t EventQueue::size() const {
+    boost::mutex::scoped_lock lock(this->mutex);
+    return this->queue.size();
+}
+
+boost::uint64_t EventQueue::getDroppedCount() const {
+    boost::mutex::scoped_lock lock(this->mutex);
+    return this->dropped;
+}
+
+void EventQueue::close() {
+    boost::mutex::scoped_lock lock(this->mutex);
+    this->closed = true;
+    this->removed += this->queue.size();
+    this->queue.clear();
+    this->scopeIndex.clear();
+    this->notEmpty.notify_all();
+    this->notFull.notify_all();
+}
+
+}
+}
@@ -0,0 +1,182 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#pragma once
+
+#include <deque>
+#include <map>
+#include <string>
+
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "../Event.h"
+#include "../Scope.h"
+
+#include "rsb/rsbexports.h"
+
+namespace rsb {
+namespace eventprocessing {
+
+/**
+ * A queue of events with an optional capacity.
+ *
+ * When a bounded queue is full, the @ref OverflowPolicy decides
+ * whether @ref push blocks or which event is discarded. Discarded
+ * events are counted.
+ *
+ * With @ref OVERFLOW_KEEP_LATEST_PER_SCOPE, bounded queues index
+ * queued events by scope such that finding the event to replace does
+ * not require scanning the queue.
+ *
+ * @author jmoringe
+ */
+class RSB_EXPORT EventQueue: private boost::noncopyable {
+public:
+    enum OverflowPolicy {
+        /**
+         * Block the pushing thread until space is available.
+         *
+         * @note If the pushing thread delivers the events of a
+         *       transport, blocking it stalls all participants
+         *       served by that thread.
+         */
+        OVERFLOW_BLOCK,
+        /**
+         * Discard the oldest queued event.
+         */
+        OVERFLOW_DROP_OLDEST,
+        /**
+         * Discard the event that is being pushed.
+         */
+        OVERFLOW_DROP_NEWEST,
+        /**
+         * Replace queued events with newer events on the same
+         * scope. If the queue is full nonetheless, discard the oldest
+         * queued event.
+         */
+        OVERFLOW_KEEP_LATEST_PER_SCOPE
+    };
+
+    /**
+     * Parses the policy names "block", "drop-oldest", "drop-newest"
+     * and "keep-latest-per-scope".
+     *
+     * @throw std::invalid_argument If @a name is not a valid policy
+     *                              name.
+     */
+    static OverflowPolicy parseOverflowPolicy(const std::string& name);
+
+    /**
+     * @param capacity Maximum number of queued events, @c 0 means
+     *                 unbounded.
+     * @param policy Policy to apply if the queue is full.
+     */
+    EventQueue(unsigned int   capacity = 0,
+               OverflowPolicy policy   = OVERFLOW_BLOCK);
+
+    unsigned int getCapacity() const;
+    OverflowPolicy getOverflowPolicy() const;
+
+    /**
+     * Adds @a event to the queue, applying the overflow policy if the
+     * queue is full.
+     *
+     * @return @c true if @a event has been queued, @c false if it has
+     *         been discarded or the queue has been closed.
+     */
+    bool push(EventPtr event);
+
+    /**
+     * Removes the oldest event, blocking until one is available.
+     *
+     * @return The event or an empty pointer if the queue has been
+     *         closed.
+     */
+    EventPtr pop();
+
+    /**
+     * Removes the oldest event if one is available.
+     *
+     * @return The event or an empty pointer.
+     */
+    EventPtr tryPop();
+
+    std::size_t size() const;
+
+    /**
+     * Returns the number of events which have been discarded due to
+     * the overflow policy.
+     */
+    boost::uint64_t getDroppedCount() const;
+
+    /**
+     * Discards all queued events and wakes up blocked threads.
+     * Subsequently pushed events are discarded.
+     */
+    void close();
+private:
+    typedef std::deque<EventPtr> Queue;
+    // Maps scopes to the absolute position of the queued event,
+    // counting from the first event ever pushed.
+    typedef std::map<Scope, boost::uint64_t> ScopeIndex;
+
+    const unsigned int   capacity;
+    const OverflowPolicy policy;
+
+    mutable boost::mutex mutex;
+    boost::condition     notEmpty;
+    boost::condition     notFull;
+    Queue                queue;
+    // Number of events which have been removed from the front of the
+    // queue. Converts positions in scopeIndex into queue indices.
+    boost::uint64_t      removed;
+    ScopeIndex           scopeIndex;
+    boost::uint64_t      dropped;
+    bool                 closed;
+
+    bool isFull() const;
+
+    /**
+     * Returns @c true if queued events are replaced by newer events
+     * on the same scope and therefore tracked in @ref scopeIndex.
+     */
+    bool isConflating() const;
+
+    /**
+     * Removes and returns the oldest event. The queue must not be
+     * empty and the mutex must be held.
+     */
+    EventPtr popFront();
+};
+
+typedef boost::shared_ptr<EventQueue> EventQueuePtr;
+
+}
+}
@@ -32,5 +32,16 @@ namespace eventprocessing {
 EventSendingStrategy::~EventSendingStrategy() {
 }
 
+EventSendingStrategy::CompletionFuturePtr
+EventSendingStrategy::processWithCompletion(EventPtr event) {
+    process(event);
+    CompletionFuturePtr future(new CompletionFuture());
+    future->set(event);
+    return future;
+}
+
+void EventSendingStrategy::flush() {
+}
+
 }
 }
@@ -30,6 +30,7 @@
 #include <boost/shared_ptr.hpp>
 
 #include <rsc/runtime/Printable.h>
+#include <rsc/threading/Future.h>
 
 #include "rsb/rsbexports.h"
 
@@ -81,6 +82,30 @@ public:
      *              the connectors.
      */
     virtual void process(EventPtr event) = 0;
+
+    typedef rsc::threading::Future<EventPtr>   CompletionFuture;
+    typedef boost::shared_ptr<CompletionFuture> CompletionFuturePtr;
+
+    /**
+     * Like @ref process but returns a future which is completed
+     * after @a event has been passed to all connectors. The default
+     * implementation calls @ref process and returns a completed
+     * future.
+     *
+     * @param event An @ref rsb::Event that should be delivered to
+     *              the connectors.
+     * @return A future which receives the delivered event or an
+     *         error if a connector failed to send it.
+     */
+    virtual CompletionFuturePtr processWithCompletion(EventPtr event);
+
+    /**
+     * Blocks until all events passed to @ref process have been
+     * delivered to the connectors. The default implementation does
+     * nothing since strategies deliver events in @ref process unless
+     * they queue events.
+     */
+    virtual void flush();
 };
 
 typedef boost::shared_ptr<EventSendingStrategy> EventSendingStrategyPtr;
@@ -30,13 +30,14 @@
 #include <rsc/logging/Logger.h>
 
 #include "../Scope.h"
+#include "../ParticipantConfig.h"
 #include "../QualityOfServiceSpec.h"
 
 #include "../transport/OutConnector.h"
 #include "../transport/Connector.h"
 
-#include "DirectEventSendingStrategy.h"
 #include "EventSendingStrategy.h"
+#include "EventSendingStrategyFactory.h"
 
 using namespace std;
 
@@ -52,16 +53,24 @@ typedef std::list<transport::OutConnectorPtr> ConnectorList;
 
 class OutRouteConfigurator::Impl {
 public:
+
+    Impl(const ParticipantConfig::EventProcessingStrategy& sendingStrategyConfig) :
+        sendingStrategyConfig(sendingStrategyConfig) {
+    }
+
     rsc::logging::LoggerPtr logger;
 
+    ParticipantConfig::EventProcessingStrategy sendingStrategyConfig;
+
     Scope                   scope;
     ConnectorList           connectors;
     EventSendingStrategyPtr eventSendingStrategy;
     volatile bool           shutdown;
 };
 
-OutRouteConfigurator::OutRouteConfigurator(const Scope& scope) :
-    d(new Impl) {
+OutRouteConfigurator::OutRouteConfigurator(const Scope&             scope,
+                                           const ParticipantConfig& config) :
+    d(new Impl(config.getEventSendingStrategy())) {
     d->logger   = Logger::getLogger("rsb.eventprocessing.OutRouteConfigurator");
     d->scope    = scope;
     d->shutdown = false;
@@ -101,8 +110,16 @@ void OutRouteConfigurator::activate() {
         (*it)->activate();
     }
 
-    // Create a strategy object and add all connectors to it.
-    d->eventSendingStrategy.reset(new DirectEventSendingStrategy());
+    // Create the configured strategy object and add all connectors
+    // to it.
+    {
+        string impl = d->sendingStrategyConfig.getName();
+        rsc::runtime::Properties options = d->sendingStrategyConfig.getOptions();
+        RSCDEBUG(d->logger, "Instantiating event sending strategy with config "
+                 << d->sendingStrategyConfig);
+        d->eventSendingStrategy
+            .reset(getEventSendingStrategyFactory().createInst(impl, options));
+    }
     for (ConnectorList::iterator it = d->connectors.begin(); it
             != d->connectors.end(); ++it) {
         RSCDEBUG(d->logger, "Adding connector " << *it
@@ -114,8 +131,11 @@ void OutRouteConfigurator::activate() {
 void OutRouteConfigurator::deactivate() {
     RSCDEBUG(d->logger, "Deactivating");
 
-    // Remove all connectors from the strategy object, the release the
-    // strategy.
+    // Let the strategy deliver queued events, then remove all
+    // connectors from the strategy object and release the strategy.
+    if (d->eventSendingStrategy) {
+        d->eventSendingStrategy->flush();
+    }
     for (ConnectorList::iterator it = d->connectors.begin(); it
             != d->connectors.end(); ++it) {
         RSCDEBUG(d->logger, "Removing connector " << *it
@@ -150,6 +170,12 @@ void OutRouteConfigurator::publish(EventPtr e) {
     d->eventSendingStrategy->process(e);
 }
 
+EventSendingStrategy::CompletionFuturePtr
+OutRouteConfigurator::publishWithCompletion(EventPtr e) {
+    RSCDEBUG(d->logger, "OutRouteConfigurator::publishWithCompletion(Event) publishing new event: " << e);
+    return d->eventSendingStrategy->processWithCompletion(e);
+}
+
 void OutRouteConfigurator::setQualityOfServiceSpecs(
         const QualityOfServiceSpec& specs) {
     for (ConnectorList::iterator it = d->connectors.begin(); it
@@ -34,11 +34,14 @@
 
 #include <rsc/runtime/Printable.h>
 
+#include "EventSendingStrategy.h"
+
 #include "rsb/rsbexports.h"
 
 namespace rsb {
 
 class Scope;
+class ParticipantConfig;
 
 class Event;
 typedef boost::shared_ptr<Event> EventPtr;
@@ -60,7 +63,8 @@ namespace eventprocessing {
 class RSB_EXPORT OutRouteConfigurator: public virtual rsc::runtime::Printable,
                                        private boost::noncopyable {
 public:
-    OutRouteConfigurator(const Scope& scope);
+    OutRouteConfigurator(const Scope&             scope,
+                         const ParticipantConfig& config);
     virtual ~OutRouteConfigurator();
 
     std::string getClassName() const;
@@ -81,6 +85,16 @@ public:
      */
     void publish(EventPtr e);
 
+    /**
+     * Publish event to out ports of this router and return a future
+     * which is completed once the event has been passed to all out
+     * ports.
+     *
+     * @param e event to publish
+     * @return future receiving the published event
+     */
+    EventSendingStrategy::CompletionFuturePtr publishWithCompletion(EventPtr e);
+
     /**
      * Define the desired quality of service specifications for published
      * events.
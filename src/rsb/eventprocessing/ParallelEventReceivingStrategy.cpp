@@ -27,11 +27,22 @@
 
 #include "ParallelEventReceivingStrategy.h"
 
+#include <algorithm>
+#include <map>
+
+#include <boost/bind.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/thread/condition.hpp>
+#include <boost/weak_ptr.hpp>
+
 #include <rsc/debug/DebugTools.h>
 #include <rsc/runtime/ContainerIO.h>
 #include <rsc/misc/langutils.h>
+#include <rsc/misc/IllegalStateException.h>
 
+#include "../EventId.h"
 #include "../MetaData.h"
+#include "../Scope.h"
 #include "../filter/Filter.h"
 
 using namespace std;
@@ -40,27 +51,186 @@ using namespace rsc::runtime;
 using namespace rsc::logging;
 using namespace rsc::debug;
 
+using namespace rsb::transport;
+
 namespace rsb {
 namespace eventprocessing {
 
+namespace {
+
+/**
+ * One serial lane of a handler. Its state other than the queue is
+ * protected by the mutex of the handler's @ref Lane.
+ */
+class Partition {
+public:
+    Partition(boost::asio::io_service&   service,
+              unsigned int               queueCapacity,
+              EventQueue::OverflowPolicy overflowPolicy) :
+        queue(queueCapacity, overflowPolicy),
+        pending(0), running(false),
+        timer(service), timerArmed(false), flushDue(false) {
+    }
+
+    EventQueue                      queue;
+
+    // Number of submitted process() calls which have not started yet.
+    size_t                          pending;
+    bool                            running;
+
+    // For batch handlers: expires when an incomplete batch has to be
+    // delivered.
+    boost::asio::deadline_timer     timer;
+    bool                            timerArmed;
+    bool                            flushDue;
+};
+
+typedef boost::shared_ptr<Partition> PartitionPtr;
+
+}
+
+/**
+ * The partitions of one handler. Calls of the handler are tracked
+ * such that removing the handler can wait for them.
+ *
+ * Work submitted to the executor and timer callbacks refer to the
+ * lane instead of the strategy since they may run after the strategy
+ * has been destroyed. @ref strategy may only be used while holding
+ * @ref mutex with @ref removed not set or by a thread listed in @ref
+ * callingThreads.
+ */
+class ParallelEventReceivingStrategy::Lane {
+public:
+    Lane(ParallelEventReceivingStrategy* strategy,
+         rsb::HandlerPtr                 handler,
+         boost::asio::io_service&        service,
+         unsigned int                    partitions,
+         unsigned int                    queueCapacity,
+         EventQueue::OverflowPolicy      overflowPolicy) :
+        strategy(strategy), handler(handler),
+        batchHandler(boost::dynamic_pointer_cast<BatchHandler>(handler)),
+        removed(false) {
+        for (unsigned int i = 0; i < partitions; ++i) {
+            this->partitions.push_back(
+                PartitionPtr(new Partition(service, queueCapacity,
+                                           overflowPolicy)));
+        }
+    }
+
+    ParallelEventReceivingStrategy* strategy;
+    rsb::HandlerPtr                 handler;
+    // Set if handler accepts batches.
+    BatchHandlerPtr                 batchHandler;
+    vector<PartitionPtr>            partitions;
+
+    boost::mutex                    mutex;
+    boost::condition                callsDone;
+    bool                            removed;
+    vector<boost::thread::id>       callingThreads;
+};
+
+namespace {
+
+boost::mutex executorMutex;
+map<string, boost::weak_ptr<AsioServiceContext> > sharedExecutors;
+unsigned int sharedExecutorThreads = 0;
+
+/**
+ * Returns the executor named @a name, creating it if necessary. The
+ * "private" executor is created for each caller. Other executors are
+ * shared within the process and grown to at least @a threads threads
+ * unless their size has been configured.
+ */
+AsioServiceContextPtr getExecutor(const string& name, unsigned int threads) {
+    if (name == "private") {
+        return AsioServiceContextPtr(new AsioServiceContext(threads));
+    }
+
+    boost::mutex::scoped_lock lock(executorMutex);
+
+    AsioServiceContextPtr executor = sharedExecutors[name].lock();
+    if (!executor) {
+        executor.reset(new AsioServiceContext(sharedExecutorThreads != 0
+                                              ? sharedExecutorThreads
+                                              : threads));
+        sharedExecutors[name] = executor;
+    } else if (sharedExecutorThreads == 0) {
+        executor->ensureThreads(threads);
+    }
+    return executor;
+}
+
+}
+
+void ParallelEventReceivingStrategy::setExecutorThreads(unsigned int threads) {
+    boost::mutex::scoped_lock lock(executorMutex);
+
+    sharedExecutorThreads = threads;
+    if (threads == 0) {
+        return;
+    }
+    for (map<string, boost::weak_ptr<AsioServiceContext> >::iterator it
+             = sharedExecutors.begin(); it != sharedExecutors.end(); ++it) {
+        if (AsioServiceContextPtr executor = it->second.lock()) {
+            executor->ensureThreads(threads);
+        }
+    }
+}
+
 EventReceivingStrategy* ParallelEventReceivingStrategy::create(const Properties& props) {
     return new ParallelEventReceivingStrategy(props.getAs<unsigned int>("threads", 5),
-                                              props.getAs<bool>("parallelhandlercalls", false));
+                                              props.getAs<bool>("parallelhandlercalls", false),
+                                              props.getAs<unsigned int>("queuecapacity", 0),
+                                              EventQueue::parseOverflowPolicy(
+                                                  props.getAs<string>("overflowpolicy", "drop-oldest")),
+                                              props.getAs<string>("partitionkey", ""),
+                                              props.getAs<unsigned int>("partitions", 0),
+                                              props.getAs<string>("executor", "shared"));
 }
 
 ParallelEventReceivingStrategy::ParallelEventReceivingStrategy(unsigned int numThreads,
-        bool parallelHandlerCalls) :
+        bool parallelHandlerCalls, unsigned int queueCapacity,
+        EventQueue::OverflowPolicy overflowPolicy, const string& partitionKey,
+        unsigned int partitions, const string& executor) :
     logger(Logger::getLogger("rsb.eventprocessing.ParallelEventReceivingStrategy")),
-    pool(numThreads,
-         boost::bind(&ParallelEventReceivingStrategy::deliver, this, _1, _2),
-         boost::bind(&ParallelEventReceivingStrategy::filter, this, _1, _2)),
-    errorStrategy(ParticipantConfig::ERROR_STRATEGY_LOG) {
-    pool.setParallelCalls(parallelHandlerCalls);
-    pool.start();
+    executor(getExecutor(executor, std::max(numThreads, 1u))),
+    parallelHandlerCalls(parallelHandlerCalls), queueCapacity(queueCapacity),
+    overflowPolicy(overflowPolicy), partitionKey(PARTITION_KEY_NONE),
+    partitions(1), lanes(new LaneList()),
+    filters(new FilterList()), errorStrategy(ParticipantConfig::ERROR_STRATEGY_LOG) {
+    static const string USER_INFO_PREFIX = "user-info:";
+
+    if (partitionKey.empty() || (partitionKey == "none")) {
+        return;
+    } else if (partitionKey == "sender") {
+        this->partitionKey = PARTITION_KEY_SENDER;
+    } else if (partitionKey == "scope") {
+        this->partitionKey = PARTITION_KEY_SCOPE;
+    } else if ((partitionKey.size() > USER_INFO_PREFIX.size())
+               && (partitionKey.compare(0, USER_INFO_PREFIX.size(),
+                                        USER_INFO_PREFIX) == 0)) {
+        this->partitionKey = PARTITION_KEY_USER_INFO;
+        this->partitionUserInfoKey = partitionKey.substr(USER_INFO_PREFIX.size());
+    } else {
+        throw invalid_argument("Invalid partition key `" + partitionKey + "'.");
+    }
+
+    if (parallelHandlerCalls) {
+        throw invalid_argument("Partitioning cannot be combined with"
+                               " parallel handler calls.");
+    }
+
+    // By default, use one partition per requested thread.
+    this->partitions = (partitions != 0) ? partitions : std::max(numThreads, 1u);
 }
 
 ParallelEventReceivingStrategy::~ParallelEventReceivingStrategy() {
-    pool.stop();
+    // Events which are still queued in the shared executor must not
+    // reach handlers after this point.
+    LaneListPtr lanes = getLanes();
+    for (LaneList::const_iterator it = lanes->begin(); it != lanes->end(); ++it) {
+        retire(*it, true);
+    }
 }
 
 string ParallelEventReceivingStrategy::getClassName() const {
@@ -68,9 +238,12 @@ string ParallelEventReceivingStrategy::getClassName() const {
 }
 
 void ParallelEventReceivingStrategy::printContents(ostream& stream) const {
-    boost::shared_lock<boost::shared_mutex> filtersLock(filtersMutex);
+    FilterListPtr filters = getFilters();
     boost::recursive_mutex::scoped_lock errorLock(errorStrategyMutex);
-    stream << "filters = " << filters << ", errorStrategy = " << errorStrategy;
+    stream << "filters = " << *filters << ", errorStrategy = " << errorStrategy
+           << ", partitions = " << this->partitions
+           << ", queueCapacity = " << this->queueCapacity
+           << ", droppedEvents = " << getDroppedEvents();
 }
 
 bool ParallelEventReceivingStrategy::filter(rsb::HandlerPtr handler, EventPtr e) {
@@ -79,13 +252,42 @@ bool ParallelEventReceivingStrategy::filter(rsb::HandlerPtr handler, EventPtr e)
     // match event
     try {
 
-        if (!handler->acceptsMethod(e->getMethod())) {
-            return false;
-        }
+        // Filters have already been applied in handle().
+        return handler->acceptsMethod(e->getMethod());
+
+    } catch (const std::exception& ex) {
+
+        stringstream s;
+        s << "Exception matching event " << e << " for handler " << handler
+                << ":" << endl;
+        s << ex.what() << endl;
+        s << DebugTools::newInstance()->exceptionInfo(ex);
 
-        boost::shared_lock<boost::shared_mutex> lock(filtersMutex);
-        for (set<filter::FilterPtr>::const_iterator filterIt = filters.begin(); filterIt
-                != filters.end(); ++filterIt) {
+        handleDispatchError(s.str());
+
+    } catch (...) {
+
+        stringstream s;
+        s << "Catch-all handler called matching event " << e << " for handler "
+                << handler << endl;
+        DebugToolsPtr tool = DebugTools::newInstance();
+        vector<string> trace = tool->createBacktrace();
+        s << tool->formatBacktrace(trace);
+
+        handleDispatchError(s.str());
+
+    }
+
+    return false;
+
+}
+
+bool ParallelEventReceivingStrategy::matches(const FilterList& filters,
+                                             EventPtr          e) {
+    try {
+
+        for (FilterList::const_iterator filterIt = filters.begin();
+             filterIt != filters.end(); ++filterIt) {
             if (!(*filterIt)->match(e)) {
                 return false;
             }
@@ -96,8 +298,7 @@ bool ParallelEventReceivingStrategy::filter(rsb::HandlerPtr handler, EventPtr e)
     } catch (const std::exception& ex) {
 
         stringstream s;
-        s << "Exception matching event " << e << " for handler " << handler
-                << ":" << endl;
+        s << "Exception matching event " << e << ":" << endl;
         s << ex.what() << endl;
         s << DebugTools::newInstance()->exceptionInfo(ex);
 
@@ -106,8 +307,7 @@ bool ParallelEventReceivingStrategy::filter(rsb::HandlerPtr handler, EventPtr e)
     } catch (...) {
 
         stringstream s;
-        s << "Catch-all handler called matching event " << e << " for handler "
-                << handler << endl;
+        s << "Catch-all handler called matching event " << e << endl;
         DebugToolsPtr tool = DebugTools::newInstance();
         vector<string> trace = tool->createBacktrace();
         s << tool->formatBacktrace(trace);
@@ -177,31 +377,339 @@ void ParallelEventReceivingStrategy::deliver(rsb::HandlerPtr handler, EventPtr e
 
 }
 
+void ParallelEventReceivingStrategy::deliverBatch(BatchHandlerPtr handler,
+                                                  const BatchHandler::EventBatch& events) {
+    RSCDEBUG(logger, "Delivering " << events.size() << " event(s) to handler "
+             << handler);
+
+    try {
+
+        handler->handleBatch(events);
+
+    } catch (const std::exception& ex) {
+
+        stringstream s;
+        s << "Exception dispatching " << events.size()
+                << " event(s) to handler " << handler << ":" << endl;
+        s << ex.what() << endl;
+        s << DebugTools::newInstance()->exceptionInfo(ex);
+
+        handleDispatchError(s.str());
+
+    } catch (...) {
+
+        stringstream s;
+        s << "Catch-all handler called dispatching " << events.size()
+                << " event(s) to handler " << handler << endl;
+        DebugToolsPtr tool = DebugTools::newInstance();
+        vector<string> trace = tool->createBacktrace();
+        s << tool->formatBacktrace(trace);
+
+        handleDispatchError(s.str());
+
+    }
+
+}
+
 void ParallelEventReceivingStrategy::handle(EventPtr event) {
     event->mutableMetaData().setDeliverTime(rsc::misc::currentTimeMicros());
-    pool.push(event);
+
+    // The filters are the same for all handlers. Applying them once
+    // before queuing avoids queuing rejected events and evaluating
+    // filters for every handler.
+    if (!matches(*getFilters(), event)) {
+        return;
+    }
+
+    size_t partition = partitionOf(event);
+    LaneListPtr lanes = getLanes();
+    for (LaneList::const_iterator it = lanes->begin(); it != lanes->end(); ++it) {
+        if (!(*it)->partitions[partition]->queue.push(event)) {
+            RSCDEBUG(logger, "Discarded event " << event << " for handler "
+                     << (*it)->handler << " due to full queue");
+        }
+        schedule(*it, partition);
+    }
+}
+
+size_t ParallelEventReceivingStrategy::partitionOf(EventPtr event) const {
+    size_t hash = 0;
+    switch (this->partitionKey) {
+    case PARTITION_KEY_NONE:
+        return 0;
+
+    case PARTITION_KEY_SENDER:
+        try {
+            hash = boost::uuids::hash_value(
+                event->getId().getParticipantId().getId());
+        } catch (const rsc::misc::IllegalStateException&) {
+            // Events without id all end up in the first partition.
+        }
+        break;
+
+    case PARTITION_KEY_SCOPE:
+        if (ScopePtr scope = event->getScopePtr()) {
+            hash = scope->getHash();
+        }
+        break;
+
+    case PARTITION_KEY_USER_INFO:
+        if (event->getMetaData().hasUserInfo(this->partitionUserInfoKey)) {
+            hash = boost::hash<string>()(
+                event->getMetaData().getUserInfo(this->partitionUserInfoKey));
+        }
+        break;
+    }
+    return hash % this->partitions;
+}
+
+boost::uint64_t ParallelEventReceivingStrategy::getDroppedEvents() const {
+    boost::uint64_t result = 0;
+    LaneListPtr lanes = getLanes();
+    for (LaneList::const_iterator it = lanes->begin(); it != lanes->end(); ++it) {
+        for (vector<PartitionPtr>::const_iterator partitionIt
+                 = (*it)->partitions.begin();
+             partitionIt != (*it)->partitions.end(); ++partitionIt) {
+            result += (*partitionIt)->queue.getDroppedCount();
+        }
+    }
+    return result;
+}
+
+void ParallelEventReceivingStrategy::schedule(LanePtr lane, size_t partition) {
+    boost::mutex::scoped_lock lock(lane->mutex);
+    scheduleLocked(lane, partition);
+}
+
+void ParallelEventReceivingStrategy::scheduleLocked(LanePtr lane, size_t partition) {
+    Partition& p = *lane->partitions[partition];
+
+    // Without parallel handler calls, at most one call is submitted
+    // or running per partition. Since the end of a call and the
+    // submission of the next one happen under the lane mutex, calls
+    // can be posted to the executor directly.
+    while (!lane->removed
+           && (p.pending < p.queue.size())
+           && (this->parallelHandlerCalls
+               || ((p.pending == 0) && !p.running))) {
+        if (lane->batchHandler) {
+            // One submitted call takes all events of a batch.
+            if (p.pending != 0) {
+                break;
+            }
+            // Incomplete batches wait for the timer unless it
+            // already expired.
+            if ((lane->batchHandler->getMaxDelay() != 0)
+                && (p.queue.size() < lane->batchHandler->getMaxBatchSize())
+                && !p.flushDue) {
+                if (!p.timerArmed) {
+                    p.timerArmed = true;
+                    p.timer.expires_from_now(boost::posix_time::milliseconds(
+                        lane->batchHandler->getMaxDelay()));
+                    p.timer.async_wait(
+                        boost::bind(&ParallelEventReceivingStrategy::flush,
+                                    lane, partition,
+                                    boost::asio::placeholders::error));
+                }
+                break;
+            }
+        }
+
+        ++p.pending;
+        this->executor->getService()->post(
+            boost::bind(&ParallelEventReceivingStrategy::process,
+                        lane, partition));
+    }
+}
+
+void ParallelEventReceivingStrategy::flush(LanePtr                          lane,
+                                           size_t                           partition,
+                                           const boost::system::error_code& error) {
+    if (error) {
+        return;
+    }
+
+    boost::mutex::scoped_lock lock(lane->mutex);
+    Partition& p = *lane->partitions[partition];
+    p.timerArmed = false;
+    if (lane->removed) {
+        return;
+    }
+    p.flushDue = true;
+    lane->strategy->scheduleLocked(lane, partition);
+}
+
+void ParallelEventReceivingStrategy::process(LanePtr lane, size_t partition) {
+    ParallelEventReceivingStrategy* strategy = lane->strategy;
+    Partition& p = *lane->partitions[partition];
+    BatchHandler::EventBatch events;
+    {
+        boost::mutex::scoped_lock lock(lane->mutex);
+        --p.pending;
+        if (lane->removed) {
+            return;
+        }
+        unsigned int maxEvents
+            = lane->batchHandler ? lane->batchHandler->getMaxBatchSize() : 1;
+        while (events.size() < maxEvents) {
+            EventPtr event = p.queue.tryPop();
+            if (!event) {
+                break;
+            }
+            events.push_back(event);
+        }
+        if (events.empty()) {
+            return;
+        }
+        if (p.timerArmed) {
+            p.timer.cancel();
+            p.timerArmed = false;
+        }
+        p.flushDue = false;
+        p.running = true;
+        lane->callingThreads.push_back(boost::this_thread::get_id());
+    }
+
+    if (lane->batchHandler) {
+        BatchHandler::EventBatch accepted;
+        for (BatchHandler::EventBatch::const_iterator it = events.begin();
+             it != events.end(); ++it) {
+            if (strategy->filter(lane->handler, *it)) {
+                accepted.push_back(*it);
+            }
+        }
+        if (!accepted.empty()) {
+            strategy->deliverBatch(lane->batchHandler, accepted);
+        }
+    } else if (strategy->filter(lane->handler, events.front())) {
+        strategy->deliver(lane->handler, events.front());
+    }
+
+    // Submit the next call before leaving callingThreads. Afterwards,
+    // the strategy may be destroyed at any time.
+    {
+        boost::mutex::scoped_lock lock(lane->mutex);
+        p.running = false;
+        if (!lane->removed) {
+            strategy->scheduleLocked(lane, partition);
+        }
+        lane->callingThreads.erase(find(lane->callingThreads.begin(),
+                                        lane->callingThreads.end(),
+                                        boost::this_thread::get_id()));
+    }
+    lane->callsDone.notify_all();
+}
+
+void ParallelEventReceivingStrategy::retire(LanePtr lane, bool wait) {
+    for (vector<PartitionPtr>::const_iterator it = lane->partitions.begin();
+         it != lane->partitions.end(); ++it) {
+        (*it)->queue.close();
+    }
+
+    boost::mutex::scoped_lock lock(lane->mutex);
+    lane->removed = true;
+    for (vector<PartitionPtr>::const_iterator it = lane->partitions.begin();
+         it != lane->partitions.end(); ++it) {
+        if ((*it)->timerArmed) {
+            (*it)->timer.cancel();
+            (*it)->timerArmed = false;
+        }
+    }
+
+    // A handler removing itself cannot wait for its own call.
+    if (wait) {
+        while (!lane->callingThreads.empty()
+               && !((lane->callingThreads.size() == 1)
+                    && (lane->callingThreads.front()
+                        == boost::this_thread::get_id()))) {
+            lane->callsDone.wait(lock);
+        }
+    }
+}
+
+ParallelEventReceivingStrategy::LaneListPtr
+ParallelEventReceivingStrategy::getLanes() const {
+    boost::mutex::scoped_lock lock(this->lanesMutex);
+    return this->lanes;
+}
+
+void ParallelEventReceivingStrategy::setLanes(LaneListPtr lanes) {
+    boost::mutex::scoped_lock lock(this->lanesMutex);
+    this->lanes = lanes;
+}
+
+ParallelEventReceivingStrategy::FilterListPtr
+ParallelEventReceivingStrategy::getFilters() const {
+    boost::mutex::scoped_lock lock(this->filtersMutex);
+    return this->filters;
 }
 
 void ParallelEventReceivingStrategy::addHandler(rsb::HandlerPtr handler,
         const bool& /*wait*/) {
-    // wait can be ignored because the pool always ensures this
-    pool.registerReceiver(handler);
+    // wait can be ignored since the new snapshot is used by all
+    // subsequent calls of handle()
+    boost::mutex::scoped_lock lock(this->lanesModificationMutex);
+
+    LaneListPtr current = getLanes();
+    for (LaneList::const_iterator it = current->begin(); it != current->end(); ++it) {
+        if ((*it)->handler == handler) {
+            return;
+        }
+    }
+
+    boost::shared_ptr<LaneList> lanes(new LaneList(*current));
+    lanes->push_back(LanePtr(new Lane(this, handler,
+                                      *this->executor->getService(),
+                                      this->partitions,
+                                      this->queueCapacity,
+                                      this->overflowPolicy)));
+    setLanes(lanes);
 }
 
 void ParallelEventReceivingStrategy::removeHandler(rsb::HandlerPtr handler,
-        const bool& /*wait*/) {
-    // wait can be ignored because the pool always ensures this
-    pool.unregisterReceiver(handler);
+        const bool& wait) {
+    LanePtr removed;
+    {
+        boost::mutex::scoped_lock lock(this->lanesModificationMutex);
+
+        boost::shared_ptr<LaneList> lanes(new LaneList());
+        LaneListPtr current = getLanes();
+        for (LaneList::const_iterator it = current->begin(); it != current->end(); ++it) {
+            if ((*it)->handler == handler) {
+                removed = *it;
+            } else {
+                lanes->push_back(*it);
+            }
+        }
+        setLanes(lanes);
+    }
+
+    if (removed) {
+        retire(removed, wait);
+    }
 }
 
 void ParallelEventReceivingStrategy::addFilter(filter::FilterPtr filter) {
-    boost::unique_lock<boost::shared_mutex> lock(filtersMutex);
-    filters.insert(filter);
+    boost::mutex::scoped_lock lock(this->filtersModificationMutex);
+
+    boost::shared_ptr<FilterList> filters(new FilterList(*getFilters()));
+    if (find(filters->begin(), filters->end(), filter) == filters->end()) {
+        filters->push_back(filter);
+    }
+
+    boost::mutex::scoped_lock filtersLock(this->filtersMutex);
+    this->filters = filters;
 }
 
 void ParallelEventReceivingStrategy::removeFilter(filter::FilterPtr filter) {
-    boost::unique_lock<boost::shared_mutex> lock(filtersMutex);
-    filters.erase(filter);
+    boost::mutex::scoped_lock lock(this->filtersModificationMutex);
+
+    boost::shared_ptr<FilterList> filters(new FilterList(*getFilters()));
+    filters->erase(remove(filters->begin(), filters->end(), filter),
+                   filters->end());
+
+    boost::mutex::scoped_lock filtersLock(this->filtersMutex);
+    this->filters = filters;
 }
 
 
@@ -26,19 +26,21 @@
 
 #pragma once
 
-#include <set>
+#include <vector>
 #include <utility>
 
 #include <boost/shared_ptr.hpp>
-#include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/recursive_mutex.hpp>
 
 #include <rsc/runtime/Properties.h>
 #include <rsc/logging/Logger.h>
-#include <rsc/threading/OrderedQueueDispatcherPool.h>
 
 #include "../Event.h"
 #include "../ParticipantConfig.h"
+#include "../transport/AsioServiceContext.h"
 #include "EventReceivingStrategy.h"
+#include "EventQueue.h"
 
 #include "rsb/rsbexports.h"
 
@@ -58,6 +60,51 @@ namespace eventprocessing {
  * to filter @ref rsb::Event s and dispatch matching events to @ref
  * rsb::Handler s.
  *
+ * Filters are applied once per event in the thread calling @ref
+ * handle, so events which are rejected by filters are not queued for
+ * handlers. Filters are stored in an immutable snapshot which is
+ * replaced when filters are added or removed.
+ *
+ * Handlers are not called by threads owned by the strategy. Instead,
+ * instances submit to a named executor which is shared within the
+ * process by all instances using the same name ("shared" by
+ * default). The number of threads of such an executor is the value
+ * set via @ref setExecutorThreads (the process-wide option
+ * eventprocessing.executor.threads) or, if that is not set, the
+ * maximum of the thread counts requested by its instances. The name
+ * "private" requests an executor which is used by this instance
+ * only. Each handler is served by a serial lane which preserves the
+ * order of events per handler unless parallel handler calls are
+ * requested.
+ *
+ * @note Handlers which block until another event has been delivered
+ *       (for example by waiting for a reply or for space in a
+ *       bounded queue) occupy a thread of the executor while
+ *       blocking. If all threads of an executor are blocked this
+ *       way, events which would unblock them cannot be delivered if
+ *       they are dispatched by the same executor. Such handlers have
+ *       to use a different or a "private" executor.
+ *
+ * If a partition key is configured, events are hashed by that key
+ * into a number of partitions per handler. Each partition is served
+ * by a separate serial lane. Events with different keys can thus be
+ * processed concurrently by the same handler while events with equal
+ * keys are delivered in order. Valid keys are "sender" (the id of
+ * the sending participant), "scope" and "user-info:NAME" (the value
+ * of the user-info item NAME).
+ *
+ * Handlers implementing @ref rsb::BatchHandler receive the queued
+ * events of a lane in batches.
+ *
+ * Events are queued per lane. These queues are unbounded by
+ * default. If a capacity is configured, the @ref
+ * EventQueue::OverflowPolicy decides how a full queue of a slow
+ * handler is treated. Queues are filled by the thread calling @ref
+ * handle, usually a thread of the transport. The default policy
+ * therefore discards the oldest event instead of blocking that
+ * thread; @ref EventQueue::OVERFLOW_BLOCK has to be requested
+ * explicitly.
+ *
  * @author swrede
  */
 class RSB_EXPORT ParallelEventReceivingStrategy: public EventReceivingStrategy {
@@ -65,9 +112,25 @@ public:
     static EventReceivingStrategy* create(const rsc::runtime::Properties& props);
 
     ParallelEventReceivingStrategy(unsigned int numThreads   = 5,
-                                   bool parallelHandlerCalls = false);
+                                   bool parallelHandlerCalls = false,
+                                   unsigned int queueCapacity = 0,
+                                   EventQueue::OverflowPolicy overflowPolicy
+                                   = EventQueue::OVERFLOW_DROP_OLDEST,
+                                   const std::string& partitionKey = "",
+                                   unsigned int partitions = 0,
+                                   const std::string& executor = "shared");
     virtual ~ParallelEventReceivingStrategy();
 
+    /**
+     * Sets the number of threads of executors which are shared
+     * between instances. Executors which already exist are grown if
+     * necessary. A value of 0 restores the default behavior of using
+     * the maximum of the thread counts requested by the instances.
+     *
+     * @param threads The number of threads per shared executor.
+     */
+    static void setExecutorThreads(unsigned int threads);
+
     std::string getClassName() const;
     void printContents(std::ostream& stream) const;
 
@@ -84,19 +147,104 @@ public:
 
     void handle(EventPtr e);
 
+    /**
+     * Returns the number of events which have been discarded by the
+     * queues of the current handlers due to the overflow policy.
+     */
+    boost::uint64_t getDroppedEvents() const;
+
 private:
+    enum PartitionKey {
+        PARTITION_KEY_NONE,
+        PARTITION_KEY_SENDER,
+        PARTITION_KEY_SCOPE,
+        PARTITION_KEY_USER_INFO
+    };
+
+    class Lane;
+    typedef boost::shared_ptr<Lane>           LanePtr;
+    typedef std::vector<LanePtr>              LaneList;
+    typedef boost::shared_ptr<const LaneList> LaneListPtr;
+
+    /**
+     * Returns the index of the partition to which @a event belongs.
+     */
+    std::size_t partitionOf(EventPtr event) const;
+
+    /**
+     * Delivers queued events of @a partition of @a lane. Runs in the
+     * executor and therefore only refers to the strategy through @a
+     * lane.
+     */
+    static void process(LanePtr lane, std::size_t partition);
+
+    /**
+     * Submits processing of queued events of @a partition of @a lane
+     * to the executor as far as permitted by the ordering
+     * requirements.
+     */
+    void schedule(LanePtr lane, std::size_t partition);
+
+    /**
+     * Like @ref schedule but requires the mutex of @a lane to be
+     * held by the caller.
+     */
+    void scheduleLocked(LanePtr lane, std::size_t partition);
+
+    /**
+     * Called when an incomplete batch of @a partition of @a lane has
+     * waited long enough.
+     */
+    static void flush(LanePtr                          lane,
+                      std::size_t                      partition,
+                      const boost::system::error_code& error);
+
+    LaneListPtr getLanes() const;
+    void setLanes(LaneListPtr lanes);
+
+    /**
+     * Marks @a lane as removed such that queued events are discarded
+     * and optionally waits for calls of the handler which are in
+     * progress.
+     */
+    void retire(LanePtr lane, bool wait);
+
     // Qualification of HandlerPtr is required since there is another
     // HandlerPtr type in eventprocessing.
     bool filter(rsb::HandlerPtr handler, EventPtr event);
     void deliver(rsb::HandlerPtr handler, EventPtr event);
+    void deliverBatch(BatchHandlerPtr handler,
+                      const BatchHandler::EventBatch& events);
 
     void handleDispatchError(const std::string& message);
 
-    rsc::logging::LoggerPtr logger;
-    rsc::threading::OrderedQueueDispatcherPool<EventPtr, rsb::Handler> pool;
+    typedef std::vector<filter::FilterPtr>      FilterList;
+    typedef boost::shared_ptr<const FilterList> FilterListPtr;
 
-    mutable boost::shared_mutex filtersMutex;
-    std::set<filter::FilterPtr> filters;
+    bool matches(const FilterList& filters, EventPtr event);
+
+    FilterListPtr getFilters() const;
+
+    rsc::logging::LoggerPtr logger;
+    transport::AsioServiceContextPtr executor;
+    bool parallelHandlerCalls;
+    unsigned int queueCapacity;
+    EventQueue::OverflowPolicy overflowPolicy;
+    PartitionKey partitionKey;
+    std::string partitionUserInfoKey;
+    unsigned int partitions;
+
+    LaneListPtr lanes;
+    // Protects the lanes pointer.
+    mutable boost::mutex lanesMutex;
+    // Serializes modifications of the lanes.
+    boost::mutex lanesModificationMutex;
+
+    FilterListPtr filters;
+    // Protects the filters pointer.
+    mutable boost::mutex filtersMutex;
+    // Serializes modifications of the filters.
+    boost::mutex filtersModificationMutex;
 
     mutable boost::recursive_mutex errorStrategyMutex;
     ParticipantConfig::ErrorStrategy errorStrategy;
@@ -29,6 +29,7 @@
 #include <vector>
 #include <list>
 #include <map>
+#include <set>
 #include <stdexcept>
 
 #include <boost/shared_ptr.hpp>
@@ -45,11 +46,37 @@ namespace eventprocessing {
  * Sinks are usually objects to which events are dispatched based on
  * their scopes.
  *
+ * Scopes are stored in a trie with one level per scope
+ * component. Determining the sinks for a scope therefore only
+ * requires a single walk along the components of that scope, which
+ * does not allocate memory.
+ *
+ * Copies are independent of the original, which allows using
+ * instances as immutable snapshots that are modified by copying.
+ *
  * @author jmoringe
  */
 template <typename T>
 class ScopeDispatcher {
 public:
+    ScopeDispatcher() :
+        scopeCount(0) {
+    }
+
+    ScopeDispatcher(const ScopeDispatcher& other) :
+        root(other.root), scopeCount(other.scopeCount) {
+        copyChildren(this->root);
+    }
+
+    ScopeDispatcher& operator=(const ScopeDispatcher& other) {
+        if (this != &other) {
+            this->root       = other.root;
+            this->scopeCount = other.scopeCount;
+            copyChildren(this->root);
+        }
+        return *this;
+    }
+
     /**
      * Indicates whether there are scopes with associated sinks.
      *
@@ -57,7 +84,7 @@ public:
      *         @false otherwise
      */
     bool empty() const {
-        return this->sinks.empty();
+        return this->scopeCount == 0;
     }
 
     /**
@@ -66,7 +93,18 @@ public:
      * @return The number of scopes with associated sinks.
      */
     size_t size() const {
-        return this->sinks.size();
+        return this->scopeCount;
+    }
+
+    /**
+     * Returns the scopes with associated sinks.
+     *
+     * @return A set containing all scopes with associated sinks.
+     */
+    std::set<Scope> getScopes() const {
+        std::set<Scope> result;
+        collectScopes(this->root, result);
+        return result;
     }
 
     /**
@@ -77,7 +115,21 @@ public:
      *             associated to @a scope.
      */
     void addSink(const Scope& scope, const T& sink) {
-        this->sinks[scope].push_back(sink);
+        Node* node = &this->root;
+        const std::vector<std::string>& components = scope.getComponents();
+        for (std::vector<std::string>::const_iterator it = components.begin();
+             it != components.end(); ++it) {
+            NodePtr& child = node->children[*it];
+            if (!child) {
+                child.reset(new Node());
+            }
+            node = child.get();
+        }
+        if (node->sinks.empty()) {
+            node->scope.reset(new Scope(scope));
+            ++this->scopeCount;
+        }
+        node->sinks.push_back(sink);
     }
 
     /**
@@ -88,15 +140,9 @@ public:
      *             associated to @a scope.
      */
     void removeSink(const Scope& scope, const T& sink) {
-        typename SinkMap::iterator it = this->sinks.find(scope);
-        if (it == this->sinks.end()) {
-            throw std::logic_error("Should not happen");
-        }
-        SinkList& sinks = it->second;
+        SinkList& sinks = findSinks(scope);
         sinks.remove(sink);
-        if (sinks.empty()) {
-            this->sinks.erase(it);
-        }
+        pruneScope(scope);
     }
 
     /**
@@ -111,18 +157,8 @@ public:
      */
     void mapSinks(const Scope&                     scope,
                   boost::function<void (const T&)> function) const {
-        std::vector<Scope> scopes = scope.superScopes(true);
-        for (std::vector<Scope>::const_iterator it = scopes.begin(); it != scopes.end(); ++it) {
-            typename SinkMap::const_iterator it_ = this->sinks.find(*it);
-            if (it_ != this->sinks.end()) {
-                const SinkList& sinks = it_->second;
-
-                for (typename SinkList::const_iterator it__ = sinks.begin();
-                     it__ != sinks.end(); ++it__) {
-                    function(*it__);
-                }
-            }
-        }
+        CallForEach call(function);
+        mapSinkLists(scope, call);
     }
 
     /**
@@ -132,20 +168,155 @@ public:
      *                 sink.
      */
     void mapAllSinks(boost::function<void (const T&)> function) const {
-        for (typename SinkMap::const_iterator it = this->sinks.begin();
-             it != this->sinks.end(); ++it) {
-            const SinkList& sinks = it->second;
-            for (typename SinkList::const_iterator it_ = sinks.begin();
-                 it_ != sinks.end(); ++it_) {
+        std::vector<const SinkList*> lists;
+        collectSinkLists(this->root, lists);
+        for (typename std::vector<const SinkList*>::const_iterator it = lists.begin();
+             it != lists.end(); ++it) {
+            for (typename SinkList::const_iterator it_ = (*it)->begin();
+                 it_ != (*it)->end(); ++it_) {
                 function(*it_);
             }
         }
     }
 protected:
-    typedef std::list<T>              SinkList;
-    typedef std::map<Scope, SinkList> SinkMap;
+    typedef std::list<T> SinkList;
+
+    struct Node;
+    typedef boost::shared_ptr<Node>           NodePtr;
+    typedef std::map<std::string, NodePtr>    Children;
 
-    SinkMap sinks;
+    struct Node {
+        boost::shared_ptr<Scope> scope;
+        SinkList                 sinks;
+        Children                 children;
+    };
+
+    /**
+     * Returns the list of sinks associated to @a scope.
+     *
+     * @throw std::logic_error If there are no sinks associated to @a
+     *                         scope.
+     */
+    SinkList& findSinks(const Scope& scope) {
+        Node* node = &this->root;
+        const std::vector<std::string>& components = scope.getComponents();
+        for (std::vector<std::string>::const_iterator it = components.begin();
+             it != components.end(); ++it) {
+            typename Children::iterator child = node->children.find(*it);
+            if (child == node->children.end()) {
+                throw std::logic_error("Should not happen");
+            }
+            node = child->second.get();
+        }
+        if (node->sinks.empty()) {
+            throw std::logic_error("Should not happen");
+        }
+        return node->sinks;
+    }
+
+    /**
+     * Updates the bookkeeping for @a scope after sinks have been
+     * removed from it and removes nodes of the trie which neither
+     * have sinks nor children.
+     */
+    void pruneScope(const Scope& scope) {
+        const std::vector<std::string>& components = scope.getComponents();
+        std::vector<Node*> path;
+        path.reserve(components.size() + 1);
+        path.push_back(&this->root);
+        for (std::vector<std::string>::const_iterator it = components.begin();
+             it != components.end(); ++it) {
+            path.push_back(path.back()->children.find(*it)->second.get());
+        }
+
+        Node* node = path.back();
+        if (!node->sinks.empty() || !node->scope) {
+            return;
+        }
+        node->scope.reset();
+        --this->scopeCount;
+
+        for (size_t i = components.size(); i > 0; --i) {
+            Node* child = path[i];
+            if (!child->sinks.empty() || !child->children.empty()) {
+                break;
+            }
+            path[i - 1]->children.erase(components[i - 1]);
+        }
+    }
+
+    /**
+     * Calls @a function for the list of sinks of each super-scope of
+     * @a scope, starting with the root scope.
+     */
+    template <typename Function>
+    void mapSinkLists(const Scope& scope, Function& function) const {
+        const Node* node = &this->root;
+        const std::vector<std::string>& components = scope.getComponents();
+        std::vector<std::string>::const_iterator it = components.begin();
+        while (true) {
+            function(node->sinks);
+
+            if (it == components.end()) {
+                break;
+            }
+            typename Children::const_iterator child = node->children.find(*it++);
+            if (child == node->children.end()) {
+                break;
+            }
+            node = child->second.get();
+        }
+    }
+
+    struct CallForEach {
+        boost::function<void (const T&)>& function;
+
+        CallForEach(boost::function<void (const T&)>& function) :
+            function(function) {
+        }
+
+        void operator()(const SinkList& sinks) {
+            for (typename SinkList::const_iterator it = sinks.begin();
+                 it != sinks.end(); ++it) {
+                this->function(*it);
+            }
+        }
+    };
+
+    /**
+     * Replaces the children of @a node, which are shared with another
+     * trie after copying @a node, with copies.
+     */
+    static void copyChildren(Node& node) {
+        for (typename Children::iterator it = node.children.begin();
+             it != node.children.end(); ++it) {
+            it->second.reset(new Node(*it->second));
+            copyChildren(*it->second);
+        }
+    }
+
+    static void collectScopes(const Node& node, std::set<Scope>& result) {
+        if (!node.sinks.empty()) {
+            result.insert(*node.scope);
+        }
+        for (typename Children::const_iterator it = node.children.begin();
+             it != node.children.end(); ++it) {
+            collectScopes(*it->second, result);
+        }
+    }
+
+    static void collectSinkLists(const Node& node, std::vector<const SinkList*>& result) {
+        if (!node.sinks.empty()) {
+            result.push_back(&node.sinks);
+        }
+        for (typename Children::const_iterator it = node.children.begin();
+             it != node.children.end(); ++it) {
+            collectSinkLists(*it->second, result);
+        }
+    }
+
+    Node   root;
+    size_t scopeCount;
 };
 
 /**
@@ -157,11 +328,7 @@ template <typename T>
 class WeakScopeDispatcher : public ScopeDispatcher< boost::weak_ptr<T> > {
 public:
     void removeSink(const Scope& scope, const T* sink) {
-        typename WeakScopeDispatcher::SinkMap::iterator it = this->sinks.find(scope);
-        if (it == this->sinks.end()) {
-            throw std::logic_error("Should not happen");
-        }
-        typename WeakScopeDispatcher::SinkList& sinks = it->second;
+        typename WeakScopeDispatcher::SinkList& sinks = this->findSinks(scope);
         for (typename WeakScopeDispatcher::SinkList::iterator it
                  = sinks.begin(); it != sinks.end();) {
             boost::shared_ptr<T> pointer = it->lock();
@@ -174,43 +341,42 @@ public:
                 ++it;
             }
         }
-        if (sinks.empty()) {
-            this->sinks.erase(it);
-        }
+        this->pruneScope(scope);
     }
 
     void mapSinks(const Scope&               scope,
                   boost::function<void (T&)> function) const {
-        std::vector<Scope> scopes = scope.superScopes(true);
-        for (std::vector<Scope>::const_iterator it = scopes.begin(); it != scopes.end(); ++it) {
-            typename WeakScopeDispatcher::SinkMap::const_iterator it_ = this->sinks.find(*it);
-            if (it_ != this->sinks.end()) {
-                const typename WeakScopeDispatcher::SinkList& sinks = it_->second;
-
-                for (typename WeakScopeDispatcher::SinkList::const_iterator it__
-                         = sinks.begin(); it__ != sinks.end(); ++it__) {
-                    boost::shared_ptr<T> pointer = it__->lock();
-                    if (pointer) {
-                        function(*pointer);
-                    }
-                }
-            }
-        }
+        LockAndCall call(function);
+        this->mapSinkLists(scope, call);
     }
 
     void mapAllSinks(boost::function<void (T&)> function) const {
-        for (typename WeakScopeDispatcher::SinkMap::const_iterator it
-                 = this->sinks.begin(); it != this->sinks.end(); ++it) {
-            const typename WeakScopeDispatcher::SinkList& sinks = it->second;
-            for (typename WeakScopeDispatcher::SinkList::const_iterator it_
-                     = sinks.begin(); it_ != sinks.end(); ++it_) {
-                boost::shared_ptr<T> pointer = it_->lock();
+        std::vector<const typename WeakScopeDispatcher::SinkList*> lists;
+        this->collectSinkLists(this->root, lists);
+        LockAndCall call(function);
+        for (typename std::vector<const typename WeakScopeDispatcher::SinkList*>::const_iterator it
+                 = lists.begin(); it != lists.end(); ++it) {
+            call(**it);
+        }
+    }
+private:
+    struct LockAndCall {
+        boost::function<void (T&)>& function;
+
+        LockAndCall(boost::function<void (T&)>& function) :
+            function(function) {
+        }
+
+        void operator()(const typename WeakScopeDispatcher::SinkList& sinks) {
+            for (typename WeakScopeDispatcher::SinkList::const_iterator it
+                     = sinks.begin(); it != sinks.end(); ++it) {
+                boost::shared_ptr<T> pointer = it->lock();
                 if (pointer) {
-                    function(*pointer);
+                    this->function(*pointer);
                 }
             }
         }
-    }
+    };
 };
 
 }
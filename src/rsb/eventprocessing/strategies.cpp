@@ -34,6 +34,7 @@
 
 #include "EventSendingStrategyFactory.h"
 #include "DirectEventSendingStrategy.h"
+#include "AsyncEventSendingStrategy.h"
 
 namespace rsb {
 namespace eventprocessing {
@@ -63,6 +64,7 @@ void registerDefaultEventProcessingStrategies() {
             = getEventSendingStrategyFactory();
 
         factory.impls().register_("direct", &DirectEventSendingStrategy::create);
+        factory.impls().register_("async", &AsyncEventSendingStrategy::create);
     }
 }
 
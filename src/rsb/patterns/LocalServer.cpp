@@ -87,7 +87,15 @@ std::string LocalServer::LocalMethod::getKind() const {
 }
 
 ListenerPtr LocalServer::LocalMethod::makeListener() {
-    ListenerPtr listener = Method::makeListener();
+    // Method callbacks may block, for example by calling other
+    // methods. Run them on an executor which is not shared with
+    // ordinary listeners.
+    ParticipantConfig config = getListenerConfig();
+    Properties& options = config.mutableEventReceivingStrategy().mutableOptions();
+    if (!options.has("executor")) {
+        options["executor"] = string("patterns");
+    }
+    ListenerPtr listener = getFactory().createListener(*getScope(), config, this);
     listener->addFilter(filter::FilterPtr(new filter::MethodFilter("REQUEST")));
     listener->addHandler(HandlerPtr(shared_from_this()));
     return listener;
@@ -28,18 +28,45 @@
 
 #include <boost/bind.hpp>
 
-#include <rsc/threading/SynchronizedQueue.h>
-
 #include "../Factory.h"
 #include "../Handler.h"
 
 namespace rsb {
 namespace patterns {
 
+namespace {
+
+/**
+ * Returns @a config, modified to use a private executor if the
+ * handler of the reader can block on a full queue. Otherwise, a
+ * reader which is not read from could occupy all threads of a shared
+ * executor.
+ */
+ParticipantConfig listenerConfig(const ParticipantConfig& config) {
+    ParticipantConfig result = config;
+    rsc::runtime::Properties& options
+        = result.mutableEventReceivingStrategy().mutableOptions();
+    if ((options.getAs<unsigned int>("queuecapacity", 0) != 0)
+        && (eventprocessing::EventQueue::parseOverflowPolicy(
+                options.getAs<std::string>("overflowpolicy", "drop-oldest"))
+            == eventprocessing::EventQueue::OVERFLOW_BLOCK)
+        && !options.has("executor")) {
+        options["executor"] = std::string("private");
+    }
+    return result;
+}
+
+}
+
 Reader::Reader(const Scope&             scope,
                const ParticipantConfig& config) :
     Participant(scope, config),
-    listener(getFactory().createListener(scope, config, this)) {
+    queue(config.getEventReceivingStrategy().getOptions()
+          .getAs<unsigned int>("queuecapacity", 0),
+          eventprocessing::EventQueue::parseOverflowPolicy(
+              config.getEventReceivingStrategy().getOptions()
+              .getAs<std::string>("overflowpolicy", "drop-oldest"))),
+    listener(getFactory().createListener(scope, listenerConfig(config), this)) {
 
     this->listener->addHandler(
             HandlerPtr(new EventFunctionHandler(boost::bind(&Reader::handle,
@@ -48,6 +75,8 @@ Reader::Reader(const Scope&             scope,
 }
 
 Reader::~Reader() {
+    // Wakes up handler calls blocked on a full queue.
+    this->queue.close();
     this->listener.reset();
 }
 
@@ -63,11 +92,7 @@ EventPtr Reader::read(bool block) {
     if (block) {
         return this->queue.pop();
     } else {
-        try {
-            return this->queue.tryPop();
-        } catch (const rsc::threading::QueueEmptyException&) {
-            return EventPtr();
-        }
+        return this->queue.tryPop();
     }
 }
 
@@ -33,13 +33,13 @@
 #include <boost/enable_shared_from_this.hpp>
 
 #include <rsc/logging/Logger.h>
-#include <rsc/threading/SynchronizedQueue.h>
 
 #include "../Scope.h"
 #include "../ParticipantConfig.h"
 #include "../Event.h"
 #include "../Participant.h"
 #include "../Listener.h"
+#include "../eventprocessing/EventQueue.h"
 
 #include "rsb/rsbexports.h"
 
@@ -62,6 +62,12 @@ namespace patterns {
  * reader->read();
  * @endcode
  *
+ * Received events are queued until they are read. The capacity and
+ * overflow policy of this queue are configured by the
+ * "queuecapacity" and "overflowpolicy" options of the event
+ * receiving strategy. Like the strategy, a bounded queue discards
+ * the oldest event by default.
+ *
  * @author jmoringe
  */
 class RSB_EXPORT Reader: public Participant,
@@ -104,9 +110,9 @@ public:
 private:
     rsc::logging::LoggerPtr logger;
 
-    ListenerPtr listener;
+    eventprocessing::EventQueue queue;
 
-    rsc::threading::SynchronizedQueue<EventPtr> queue;
+    ListenerPtr listener;
 
     void handle(EventPtr event);
 };
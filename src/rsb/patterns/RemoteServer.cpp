@@ -67,7 +67,13 @@ std::string RemoteServer::RemoteMethod::getKind() const {
 }
 
 ListenerPtr RemoteServer::RemoteMethod::makeListener() {
-    ListenerPtr listener = Method::makeListener();
+    // Replies are dispatched in the receiving thread. Handling them
+    // only completes futures and must not depend on an executor
+    // thread since callers may be blocked waiting for replies in
+    // handlers running on any executor.
+    ParticipantConfig config = getListenerConfig();
+    config.mutableEventReceivingStrategy().setName("direct");
+    ListenerPtr listener = getFactory().createListener(*getScope(), config, this);
     listener->addFilter(filter::FilterPtr(new filter::MethodFilter("REPLY")));
     listener->addHandler(shared_from_this());
     return listener;
@@ -33,25 +33,45 @@ using namespace rsc::logging;
 namespace rsb {
 namespace transport {
 
-AsioServiceContext::AsioServiceContext() :
+AsioServiceContext::AsioServiceContext(unsigned int threads) :
         logger(Logger::getLogger("rsb.transport.socket.AsioServiceContext")), service(
-                new io_service), keepAlive(new io_service::work(*service)), thread(
-                boost::bind(&boost::asio::io_service::run, service)) {
-    RSCINFO(logger, "Started service thread");
+                new io_service), keepAlive(new io_service::work(*service)) {
+    ensureThreads(threads);
 }
 
 AsioServiceContext::~AsioServiceContext() {
-    RSCINFO(logger, "Stopping service thread");
+    RSCINFO(logger, "Stopping service threads");
     this->keepAlive.reset();
-    if (boost::this_thread::get_id() != this->thread.get_id()) {
-        this->thread.join();
+    for (vector<boost::shared_ptr<boost::thread> >::iterator it
+             = this->threads.begin(); it != this->threads.end(); ++it) {
+        if (boost::this_thread::get_id() != (*it)->get_id()) {
+            (*it)->join();
+        } else {
+            (*it)->detach();
+        }
     }
-    RSCINFO(logger, "Stopped service thread");
+    RSCINFO(logger, "Stopped service threads");
 }
 
 AsioServiceContext::ServicePtr AsioServiceContext::getService() {
     return service;
 }
 
+unsigned int AsioServiceContext::getThreads() {
+    boost::mutex::scoped_lock lock(this->threadsMutex);
+    return this->threads.size();
+}
+
+void AsioServiceContext::ensureThreads(unsigned int threads) {
+    boost::mutex::scoped_lock lock(this->threadsMutex);
+    while (this->threads.size() < threads) {
+        this->threads.push_back(boost::shared_ptr<boost::thread>(
+            new boost::thread(boost::bind(&boost::asio::io_service::run,
+                                          this->service))));
+        RSCINFO(logger, "Started service thread " << this->threads.size()
+                << " of " << threads);
+    }
+}
+
 }
 }
@@ -26,6 +26,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include <boost/asio.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/thread.hpp>
@@ -42,24 +44,51 @@ namespace transport {
  * So it is best maintained in shared_ptr instances
  * (@ref AsioServiceContextPtr).
  *
+ * The service is run by a pool of threads. Clients which dispatch
+ * handlers of related asynchronous operations to the service have to
+ * use strands if these handlers must not run concurrently.
+ *
  * @author jwienke
  */
 class RSB_EXPORT AsioServiceContext {
 public:
-    AsioServiceContext();
+    /**
+     * Creates a service which is run by @a threads threads.
+     *
+     * @param threads Number of threads running the service. Has to be
+     *                at least 1.
+     */
+    AsioServiceContext(unsigned int threads = 1);
     virtual ~AsioServiceContext();
 
     typedef boost::shared_ptr<boost::asio::io_service> ServicePtr;
 
     ServicePtr getService();
 
+    /**
+     * Returns the number of threads running the service.
+     *
+     * @return The number of threads.
+     */
+    unsigned int getThreads();
+
+    /**
+     * Starts additional threads such that at least @a threads threads
+     * run the service. Never stops threads.
+     *
+     * @param threads The minimum number of threads which should run
+     *                the service.
+     */
+    void ensureThreads(unsigned int threads);
+
 private:
     typedef boost::shared_ptr<boost::asio::io_service::work> WorkPtr;
 
     rsc::logging::LoggerPtr logger;
     ServicePtr service;
     WorkPtr keepAlive;
-    boost::thread thread;
+    boost::mutex threadsMutex;
+    std::vector<boost::shared_ptr<boost::thread> > threads;
 };
 
 typedef boost::shared_ptr<AsioServiceContext> AsioServiceContextPtr;
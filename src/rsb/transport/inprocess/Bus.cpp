@@ -26,8 +26,6 @@
 
 #include "Bus.h"
 
-#include <rsc/runtime/ContainerIO.h>
-
 #include "InConnector.h"
 
 using namespace std;
@@ -41,169 +39,60 @@ namespace transport{
 namespace inprocess {
 
 Bus::Bus() :
-    logger(Logger::getLogger("rsb.transport.inprocess.Bus")), singleThreaded(false) {
+    logger(Logger::getLogger("rsb.transport.inprocess.Bus")) {
 }
 
 Bus::~Bus() {
     RSCDEBUG(logger, "Starting destruction");
-    for (SinkMap::iterator sinkIt = this->sinks.begin();
-            sinkIt != this->sinks.end(); ++sinkIt) {
-        if (!sinkIt->second.empty()) {
-            RSCWARN(logger,
-                    "non-empty scope " << sinkIt->first << " when destructing: " << sinkIt->second);
-        }
+    if (!this->sinks.get()->empty()) {
+        RSCWARN(logger, "" << this->sinks.get()->size() << " non-empty scopes when destructing");
     }
 }
 
-/*void Bus::printContents(ostream& stream) const {
-    stream << "sinks = " << this->sinks;
-    }*/
-
 void Bus::addSink(InConnectorPtr sink) {
-    boost::recursive_mutex::scoped_lock lock(this->mutex);
+    boost::mutex::scoped_lock lock(this->modificationMutex);
 
     RSCDEBUG(logger, "Adding sink " << sink);
 
-    SinkMap::iterator it = this->sinks.find(sink->getScope());
-    if (it == this->sinks.end()) {
-        RSCDEBUG(logger,
-                "No entry in sink map for event scope " << sink->getScope());
-
-        set<boost::weak_ptr<InConnector> > connectors;
-        for (SinkMap::iterator it_ = this->sinks.begin(); it_
-                != this->sinks.end(); ++it_) {
-            RSCDEBUG(
-                    logger,
-                    "Adding " << it_->second.size() << " connectors from "
-                            << it_->first);
-
-            if (it_->first == sink->getScope() || it_->first.isSuperScopeOf(
-                    sink->getScope())) {
-                copy(it_->second.begin(), it_->second.end(),
-                        inserter(connectors, connectors.begin()));
-            }
-        }
-        copy(connectors.begin(), connectors.end(),
-                back_inserter(this->sinks[sink->getScope()]));
-
-        RSCDEBUG(
-                logger,
-                "Created entry in sink map for scope " << sink->getScope()
-                        << " with " << connectors.size() << " connectors");
-
-        it = this->sinks.find(sink->getScope());
-    }
-    it->second.push_back(sink);
-
-    for (SinkMap::iterator it = this->sinks.begin(); it != this->sinks.end(); ++it) {
-        if (it->first.isSubScopeOf(sink->getScope())) {
-            SinkList& connectors = it->second;
-            connectors.push_back(sink);
-        }
-    }
+    boost::shared_ptr<SinkDispatcher> sinks(new SinkDispatcher(*this->sinks.get()));
+    sinks->addSink(sink->getScope(), sink);
+    this->sinks.set(sinks);
 }
 
 void Bus::removeSink(InConnector* sink) {
-    boost::recursive_mutex::scoped_lock lock(this->mutex);
-
-    vector<Scope> scopes = sink->getScope().superScopes(true);
-    RSCDEBUG(logger, "Removing sink " << sink);
-
-    set<Scope> emptyScopes;
-    for (SinkMap::iterator it = this->sinks.begin(); it != this->sinks.end(); ++it) {
-        SinkList& connectors = it->second;
-        RSCDEBUG(
-                logger,
-                "Scope " << it->first << " has " << connectors.size()
-                        << " connectors");
-
-        for (SinkList::iterator it_ = connectors.begin(); it_
-                != connectors.end(); ++it_) {
-            // If the weak pointer is dangling, we found our
-            // sink. Otherwise, we can just check the pointer.
-            InConnectorPtr ptr = it_->lock();
-            if (!ptr || (ptr.get() == sink)) {
-                RSCDEBUG(logger,
-                        "Found connector " << sink << " in scope " << it->first);
-                it_ = connectors.erase(it_);
-                break;
-            }
-        }
-
-        RSCDEBUG(
-                logger,
-                "Scope " << it->first << " has " << connectors.size()
-                        << " connectors");
-        if (connectors.empty()) {
-            RSCDEBUG(logger, "Marking empty scope " << it->first
-                             << " for removal");
-            emptyScopes.insert(it->first);
-        }
-    }
-    // delete scopes that became empty
-    for (set<Scope>::iterator scopeIt = emptyScopes.begin();
-            scopeIt != emptyScopes.end(); ++scopeIt) {
-        this->sinks.erase(*scopeIt);
-    }
-}
+    boost::uint64_t generation;
+    {
+        boost::mutex::scoped_lock lock(this->modificationMutex);
 
-void Bus::handle(EventPtr event) {
-    //    RSCDEBUG(logger, "Delivering event " << event);
+        RSCDEBUG(logger, "Removing sink " << sink);
 
-    if (singleThreaded) {
-        this->handleNoLock(event);
-    } else {
-        boost::recursive_mutex::scoped_lock lock(this->mutex);
-        this->handleNoLock(event);
+        boost::shared_ptr<SinkDispatcher> sinks(new SinkDispatcher(*this->sinks.get()));
+        sinks->removeSink(sink->getScope(), sink);
+        generation = this->sinks.set(sinks);
     }
 
+    // Deliveries which still use a snapshot containing sink may call
+    // it until they finish.
+    this->sinks.waitForDispatches(generation);
 }
 
-void Bus::handleNoLock(EventPtr event) {
-
-    SinkMap::const_iterator it = this->sinks.find(*event->getScopePtr());
-    if (it == this->sinks.end()) {
-        RSCDEBUG(logger,
-                "No entry in sink map for event scope " << *event->getScopePtr());
-
-        // we have not received an event on this scope before. Therefore the
-        // internal map of sinks needs to be populated from all existing sinks
-        // that will receive events from this scope
-
-        set<boost::weak_ptr<InConnector> > connectors;
-        for (SinkMap::iterator it_ = this->sinks.begin(); it_
-                != this->sinks.end(); ++it_) {
-            RSCDEBUG(
-                    logger,
-                    "Adding " << it_->second.size() << " connectors from "
-                            << it_->first);
-
-            if (it_->first == *event->getScopePtr() || it_->first.isSuperScopeOf(
-                    *event->getScopePtr())) {
-                copy(it_->second.begin(), it_->second.end(),
-                        inserter(connectors, connectors.begin()));
-            }
-        }
-        copy(connectors.begin(), connectors.end(),
-                back_inserter(this->sinks[*event->getScopePtr()]));
-
-        RSCDEBUG(
-                logger,
-                "Created entry in sink map for scope " << *event->getScopePtr()
-                        << " with " << connectors.size() << " connectors");
-
-        it = this->sinks.find(*event->getScopePtr());
-    }
+// Cannot be a local struct in the handle() method since some
+// compilers (or standard versions?) don't support that.
+namespace {
 
-    const SinkList& connectors = it->second;
-    for (SinkList::const_iterator it__ = connectors.begin(); it__
-            != connectors.end(); ++it__) {
-        InConnectorPtr connector = it__->lock();
-        if (connector) {
-            // RSCDEBUG(logger, "Delivering to " << connector << " in " << *it);
-            connector->handle(event);
-        }
+struct PoorPersonsLambda {
+    EventPtr event;
+    PoorPersonsLambda(EventPtr event) : event(event) {}
+    void operator()(InConnector& sink) {
+        sink.handle(this->event);
     }
+};
+
+}
+
+void Bus::handle(EventPtr event) {
+    SinkSnapshots::Dispatch sinks(this->sinks);
+    sinks->mapSinks(*event->getScopePtr(), PoorPersonsLambda(event));
 }
 
 BusPtr getDefaultBus() {
@@ -26,11 +26,8 @@
 
 #pragma once
 
-#include <map>
-#include <list>
-
 #include <boost/shared_ptr.hpp>
-#include <boost/thread/recursive_mutex.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include <rsc/logging/Logger.h>
 #include <rsc/patterns/Singleton.h>
@@ -38,7 +35,9 @@
 #include "../../Event.h"
 #include "../../Scope.h"
 
+#include "../../eventprocessing/DispatcherSnapshots.h"
 #include "../../eventprocessing/Handler.h"
+#include "../../eventprocessing/ScopeDispatcher.h"
 
 #include "rsb/rsbexports.h"
 
@@ -50,6 +49,15 @@ class InConnector;
 typedef boost::shared_ptr<InConnector> InConnectorPtr;
 
 /**
+ * Delivers events to in-process connectors with matching scopes.
+ *
+ * Sinks are stored in immutable snapshots. Adding or removing sinks
+ * replaces the current snapshot while delivering an event only
+ * copies the pointer to the current snapshot. Thus, events on
+ * different threads are delivered concurrently and handlers are not
+ * called while holding a lock. A sink may still receive events which
+ * are being delivered while it is removed, but @ref removeSink only
+ * returns after these deliveries have finished.
  *
  * @author jmoringe
  */
@@ -58,24 +66,19 @@ public:
     Bus();
     virtual ~Bus();
 
-    //void printContents(std::ostream& stream) const;
-
     void addSink(InConnectorPtr sink);
     void removeSink(InConnector* sink);
 
     void handle(EventPtr event);
 private:
-    void handleNoLock(EventPtr event);
-
-    typedef std::list< boost::weak_ptr<InConnector> > SinkList;
-    typedef std::map<Scope, SinkList> SinkMap;
+    typedef eventprocessing::WeakScopeDispatcher<InConnector>    SinkDispatcher;
+    typedef eventprocessing::DispatcherSnapshots<SinkDispatcher> SinkSnapshots;
 
     rsc::logging::LoggerPtr logger;
 
-    SinkMap sinks;
-    boost::recursive_mutex mutex;
-
-    bool singleThreaded;
+    SinkSnapshots           sinks;
+    // Serializes modifications of the sinks.
+    boost::mutex            modificationMutex;
 };
 
 typedef boost::shared_ptr<Bus> BusPtr;
@@ -90,17 +90,19 @@ const std::string InConnector::getTransportURL() const {
 void InConnector::activate() {
     RSCDEBUG(logger, "Activating");
 
-    bus->addSink(boost::dynamic_pointer_cast<InConnector>(shared_from_this()));
-
     this->active = true;
+
+    bus->addSink(boost::dynamic_pointer_cast<InConnector>(shared_from_this()));
 }
 
 void InConnector::deactivate() {
     RSCDEBUG(logger, "Deactivating");
 
-    this->active = false;
-
+    // Returns only after all deliveries to this connector have
+    // finished.
     bus->removeSink(this);
+
+    this->active = false;
 }
 
 void InConnector::setQualityOfServiceSpecs(const QualityOfServiceSpec& /*specs*/) {
@@ -0,0 +1,157 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#include "Bus.h"
+
+#include <map>
+
+#include <boost/bind.hpp>
+#include <boost/weak_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "../../MetaData.h"
+
+#include "../../protocol/Notification.h"
+
+#include "InConnector.h"
+
+using namespace std;
+
+using namespace rsc::logging;
+
+namespace rsb {
+namespace transport {
+namespace shm {
+
+// Maximum time the receiver thread blocks before checking whether
+// the bus is being destroyed.
+static const unsigned int RECEIVE_TIMEOUT_MILLIS = 100;
+
+static bool parseNotification(protocol::Notification* notification,
+                              LoggerPtr               logger,
+                              const char*             frame,
+                              size_t                  size) {
+    if (!notification->ParseFromArray(frame, size)) {
+        RSCWARN(logger, "Could not parse notification of " << size
+                << " bytes; ignoring it");
+        return false;
+    }
+    return true;
+}
+
+Bus::Bus(const string& name, size_t capacity) :
+    logger(Logger::getLogger("rsb.transport.shm.Bus")),
+    ring(name, capacity), running(true) {
+    // Only receive frames which are written after the bus has been
+    // created.
+    this->receiver = boost::thread(boost::bind(&Bus::receive, this,
+                                               this->ring.getWritePosition()));
+}
+
+Bus::~Bus() {
+    RSCDEBUG(logger, "Destructing");
+
+    this->running = false;
+    this->ring.interrupt();
+    if (this->receiver.get_id() != boost::this_thread::get_id()) {
+        this->receiver.join();
+    } else {
+        this->receiver.detach();
+    }
+}
+
+void Bus::addSink(InConnectorPtr sink) {
+    boost::recursive_mutex::scoped_lock lock(this->sinkMutex);
+
+    RSCDEBUG(logger, "Adding sink " << sink);
+
+    this->sinkDispatcher.addSink(sink->getScope(), sink);
+}
+
+void Bus::removeSink(InConnector* sink) {
+    boost::recursive_mutex::scoped_lock lock(this->sinkMutex);
+
+    RSCDEBUG(logger, "Removing sink " << sink);
+
+    this->sinkDispatcher.removeSink(sink->getScope(), sink);
+}
+
+void Bus::send(socket::FramePtr frame) {
+    // The ring stores the length of each frame itself, so the length
+    // header of the socket transport is not written.
+    this->ring.write(frame->data() + 4, frame->size() - 4);
+}
+
+const string Bus::getTransportURL() const {
+    return "shm:" + this->ring.getName();
+}
+
+void Bus::receive(boost::uint64_t position) {
+    RSCDEBUG(logger, "Receiver thread starting at position " << position);
+
+    protocol::Notification notification;
+    Ring::FrameHandler parse
+        = boost::bind(&parseNotification, &notification, this->logger, _1, _2);
+    while (this->running) {
+        // The notification is parsed directly from the ring.
+        if (!this->ring.read(position, parse, RECEIVE_TIMEOUT_MILLIS)) {
+            continue;
+        }
+
+        boost::shared_ptr<string> data(new string());
+        data->swap(*notification.mutable_data());
+        EventPtr event
+            = socket::notificationToEvent(notification, true, ScopePtr(), data);
+
+        boost::recursive_mutex::scoped_lock lock(this->sinkMutex);
+        try {
+            this->sinkDispatcher.mapSinks(*event->getScopePtr(),
+                                          boost::bind(&InConnector::handle, _1, event));
+        } catch (const std::exception& e) {
+            RSCERROR(logger, "Exception while dispatching event "
+                     << event << ": " << e.what());
+        }
+    }
+
+    RSCDEBUG(logger, "Receiver thread stopping");
+}
+
+BusPtr getBus(const string& name, size_t capacity) {
+    static boost::mutex mutex;
+    static map<string, boost::weak_ptr<Bus> > buses;
+    boost::mutex::scoped_lock lock(mutex);
+
+    BusPtr bus = buses[name].lock();
+    if (!bus) {
+        bus.reset(new Bus(name, capacity));
+        buses[name] = bus;
+    }
+    return bus;
+}
+
+}
+}
+}
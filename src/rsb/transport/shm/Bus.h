@@ -0,0 +1,122 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#pragma once
+
+#include <string>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+
+#include <rsc/logging/Logger.h>
+
+#include "../../Event.h"
+
+#include "../../eventprocessing/ScopeDispatcher.h"
+
+#include "../socket/Serialization.h"
+
+#include "Ring.h"
+
+#include "rsb/rsbexports.h"
+
+namespace rsb {
+namespace transport {
+namespace shm {
+
+class InConnector;
+typedef boost::shared_ptr<InConnector> InConnectorPtr;
+
+/**
+ * Instances of this class connect the connectors of one process to a
+ * @ref Ring shared with other processes on the same host.
+ *
+ * Outgoing events are encoded into frames and written into the
+ * ring. A receiver thread reads all frames from the ring, including
+ * the ones written by this process, decodes them in place and
+ * dispatches them to local connectors with matching scopes. Since events from local
+ * connectors are delivered via the ring as well, each event is
+ * delivered exactly once to each matching connector.
+ *
+ * @author jmoringe
+ */
+class RSB_EXPORT Bus {
+public:
+    /**
+     * Creates a bus which operates on the ring named @a name.
+     *
+     * @param name Name of the shared memory segment of the ring.
+     * @param capacity Capacity of the ring in bytes, if it has to be
+     *                 created.
+     */
+    Bus(const std::string& name, std::size_t capacity);
+    virtual ~Bus();
+
+    void addSink(InConnectorPtr sink);
+    void removeSink(InConnector* sink);
+
+    /**
+     * Writes @a frame, which has been produced by @ref
+     * socket::eventToFrame, into the ring.
+     *
+     * @param frame The frame that should be written.
+     */
+    void send(socket::FramePtr frame);
+
+    const std::string getTransportURL() const;
+private:
+    typedef eventprocessing::WeakScopeDispatcher<InConnector> SinkDispatcher;
+
+    rsc::logging::LoggerPtr logger;
+
+    Ring                    ring;
+
+    SinkDispatcher          sinkDispatcher;
+    boost::recursive_mutex  sinkMutex;
+
+    volatile bool           running;
+    boost::thread           receiver;
+
+    void receive(boost::uint64_t position);
+};
+
+typedef boost::shared_ptr<Bus> BusPtr;
+
+/**
+ * Returns the bus of this process for the ring named @a name,
+ * creating it if necessary.
+ *
+ * @param name Name of the shared memory segment of the ring.
+ * @param capacity Capacity of the ring in bytes, if it has to be
+ *                 created.
+ * @return A shared pointer to the bus.
+ */
+RSB_EXPORT BusPtr getBus(const std::string& name, std::size_t capacity);
+
+}
+}
+}
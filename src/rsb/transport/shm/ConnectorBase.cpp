@@ -0,0 +1,88 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#include "ConnectorBase.h"
+
+using namespace std;
+
+using namespace rsc::logging;
+
+namespace rsb {
+namespace transport {
+namespace shm {
+
+ConnectorBase::ConnectorBase(ConverterSelectionStrategyPtr converters,
+                             const string&                 name,
+                             size_t                        capacity) :
+    ConverterSelectingConnector<string>(converters),
+    active(false), logger(Logger::getLogger("rsb.transport.shm.ConnectorBase")),
+    name(name), capacity(capacity) {
+}
+
+ConnectorBase::~ConnectorBase() {
+    if (this->active) {
+        deactivate();
+    }
+}
+
+Scope ConnectorBase::getScope() const {
+    return this->scope;
+}
+
+void ConnectorBase::setScope(const Scope& scope) {
+    if (this->active)
+        throw std::runtime_error("Cannot set scope while active");
+
+    this->scope = scope;
+}
+
+const std::string ConnectorBase::getTransportURL() const {
+    return "shm:" + this->name;
+}
+
+void ConnectorBase::activate() {
+    RSCDEBUG(logger, "Activating");
+
+    this->bus = shm::getBus(this->name, this->capacity);
+
+    this->active = true;
+}
+
+void ConnectorBase::deactivate() {
+    RSCDEBUG(logger, "Deactivating");
+
+    this->active = false;
+
+    this->bus.reset();
+}
+
+BusPtr ConnectorBase::getBus() {
+    return this->bus;
+}
+
+}
+}
+}
@@ -0,0 +1,108 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#pragma once
+
+#include <string>
+
+#include <boost/shared_ptr.hpp>
+
+#include <rsc/logging/Logger.h>
+
+#include "../../Scope.h"
+
+#include "../ConverterSelectingConnector.h"
+
+#include "Bus.h"
+
+#include "rsb/rsbexports.h"
+
+namespace rsb {
+namespace transport {
+namespace shm {
+
+/**
+ * Default name of the shared memory segment used by the shm
+ * transport.
+ */
+const std::string DEFAULT_NAME = "rsb";
+
+/**
+ * Default capacity of newly created rings in bytes.
+ */
+const std::size_t DEFAULT_CAPACITY = 16 * 1024 * 1024;
+
+/**
+ * This class is intended to be used as a base class for connector
+ * classes of the shared memory transport.
+ *
+ * @author jmoringe
+ */
+class RSB_EXPORT ConnectorBase: public ConverterSelectingConnector<std::string> {
+public:
+    /**
+     * Creates a connector for the ring named @a name.
+     *
+     * @param converters A strategy for converter selection within the
+     *                   newly created connector.
+     * @param name Name of the shared memory segment of the ring.
+     * @param capacity Capacity of the ring in bytes if it has to be
+     *                 created. Has no effect if the ring already
+     *                 exists.
+     */
+    ConnectorBase(ConverterSelectionStrategyPtr converters,
+                  const std::string&            name,
+                  std::size_t                   capacity);
+
+    virtual ~ConnectorBase();
+
+    virtual Scope getScope() const;
+    virtual void setScope(const Scope& scope);
+
+    // Overwrites method in rsb::transport::Connector.
+    virtual const std::string getTransportURL() const;
+protected:
+    virtual void activate();
+
+    virtual void deactivate();
+
+    volatile bool active;
+
+    BusPtr getBus();
+private:
+    rsc::logging::LoggerPtr logger;
+
+    Scope                   scope;
+
+    BusPtr                  bus;
+
+    std::string             name;
+    std::size_t             capacity;
+};
+
+}
+}
+}
@@ -0,0 +1,95 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#include "OutConnector.h"
+
+#include "../../MetaData.h"
+
+#include "../socket/Serialization.h"
+
+using namespace std;
+
+using namespace boost;
+
+using namespace rsc::logging;
+using namespace rsc::runtime;
+
+namespace rsb {
+namespace transport {
+namespace shm {
+
+transport::OutConnector* OutConnector::create(const Properties& args) {
+    LoggerPtr logger = Logger::getLogger("rsb.transport.shm.OutConnector");
+    RSCDEBUG(logger, "Creating OutConnector with properties " << args);
+
+    return new OutConnector(args.get<ConverterSelectionStrategyPtr>("converters"),
+                            args.get<string>                       ("name",     DEFAULT_NAME),
+                            args.getAs<size_t>                     ("capacity", DEFAULT_CAPACITY));
+}
+
+OutConnector::OutConnector(ConverterSelectionStrategyPtr converters,
+                           const string&                 name,
+                           size_t                        capacity) :
+    ConnectorBase(converters, name, capacity),
+    logger(Logger::getLogger("rsb.transport.shm.OutConnector")) {
+}
+
+OutConnector::~OutConnector() {
+}
+
+void OutConnector::setScope(const Scope& scope) {
+    ConnectorBase::setScope(scope);
+}
+
+void OutConnector::activate() {
+    ConnectorBase::activate();
+}
+
+void OutConnector::deactivate() {
+    ConnectorBase::deactivate();
+}
+
+void OutConnector::setQualityOfServiceSpecs(const QualityOfServiceSpec& /*specs*/) {
+    RSCDEBUG(logger, "Quality of service not implemented");
+}
+
+void OutConnector::handle(EventPtr event) {
+    event->mutableMetaData().setSendTime();
+
+    string wireData;
+    AnnotatedData d(event->getType(), event->getData());
+    string wireSchema = getConverter(event->getType())->serialize(d, wireData);
+
+    getBus()->send(socket::eventToFrame(event, wireSchema, wireData));
+}
+
+const std::string OutConnector::getTransportURL() const {
+    return ConnectorBase::getTransportURL();
+}
+
+}
+}
+}
@@ -0,0 +1,82 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#pragma once
+
+#include <string>
+
+#include <rsc/runtime/Properties.h>
+
+#include <rsc/logging/Logger.h>
+
+#include "../OutConnector.h"
+
+#include "ConnectorBase.h"
+
+#include "rsb/rsbexports.h"
+
+namespace rsb {
+namespace transport {
+namespace shm {
+
+/**
+ * Instances of this connector class serialize events and write them
+ * into a shared memory ring via a @ref Bus.
+ *
+ * @author jmoringe
+ */
+class RSB_EXPORT OutConnector: public ConnectorBase,
+                               public rsb::transport::OutConnector {
+public:
+    /**
+     * @copydoc ConnectorBase::ConnectorBase()
+     */
+    OutConnector(ConverterSelectionStrategyPtr converters,
+                 const std::string&            name,
+                 std::size_t                   capacity);
+
+    virtual ~OutConnector();
+
+    virtual void setScope(const Scope& scope);
+
+    virtual void activate();
+    virtual void deactivate();
+
+    void setQualityOfServiceSpecs(const QualityOfServiceSpec& specs);
+
+    void handle(EventPtr e);
+
+    // Overwrites method in ConnectorBase.
+    virtual const std::string getTransportURL() const;
+
+    static transport::OutConnector* create(const rsc::runtime::Properties& args);
+private:
+    rsc::logging::LoggerPtr logger;
+};
+
+}
+}
+}
@@ -0,0 +1,407 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#include "Ring.h"
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <linux/futex.h>
+
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#include <boost/format.hpp>
+
+#include "../../CommException.h"
+
+using namespace std;
+
+using namespace rsc::logging;
+
+namespace rsb {
+namespace transport {
+namespace shm {
+
+// Identifies completely initialized segments with the layout
+// described by Ring::Header.
+static const boost::uint32_t MAGIC   = 0x52534252;
+static const boost::uint32_t VERSION = 1;
+
+// The data area starts at this offset in the segment.
+static const size_t DATA_OFFSET = 256;
+
+// Each record in the data area is preceded by a 4-byte header in
+// host byte order. For frames, the header contains the length of the
+// frame. If SKIP_FLAG is set, the remaining bits contain the size of
+// the record including the header and the record does not contain a
+// frame. Records never wrap around the end of the data area. Instead,
+// the remainder of the data area is filled with a skip record.
+static const size_t          RECORD_HEADER_SIZE = 4;
+static const boost::uint32_t SKIP_FLAG          = 0x80000000ul;
+
+// Records start at multiples of RECORD_ALIGNMENT so that there is
+// always room for a record header before the end of the data area.
+static const size_t RECORD_ALIGNMENT = 8;
+
+static const size_t MAX_CAPACITY = SKIP_FLAG - RECORD_ALIGNMENT;
+
+// Number of attempts to replace a stale segment.
+static const unsigned int OPEN_ATTEMPTS = 10;
+
+struct Ring::Header {
+    boost::uint32_t magic;
+    boost::uint32_t version;
+    boost::uint64_t capacity;
+
+    // Serializes writers. The mutex is robust so that a writer which
+    // dies while holding it does not block the ring.
+    pthread_mutex_t writeMutex;
+
+    // End of the area which writers may currently modify. Readers
+    // check this position to detect frames which have been
+    // overwritten while they were processing them.
+    boost::uint64_t reservePosition;
+    // End of the last completely written record.
+    boost::uint64_t writePosition;
+
+    // Futex word on which readers wait. Incremented after each
+    // written frame.
+    boost::uint32_t sequence;
+    // Number of readers waiting on sequence.
+    boost::uint32_t waiters;
+};
+
+static boost::uint64_t alignRecord(boost::uint64_t value) {
+    return (value + RECORD_ALIGNMENT - 1) & ~boost::uint64_t(RECORD_ALIGNMENT - 1);
+}
+
+static string errorMessage(const string& what, const string& name, int error) {
+    return boost::str(boost::format("Could not %1% shared memory segment %2%: %3%")
+                      % what % name % strerror(error));
+}
+
+Ring::WriteLock::WriteLock(Ring& ring) :
+    ring(ring) {
+    this->ring.lock();
+}
+
+Ring::WriteLock::~WriteLock() {
+    this->ring.unlock();
+}
+
+Ring::Ring(const string& name, size_t capacity) :
+    logger(Logger::getLogger("rsb.transport.shm.Ring")), name(name),
+    size(0), header(0), data(0) {
+    if (capacity > MAX_CAPACITY) {
+        throw std::invalid_argument(boost::str(boost::format("Ring capacity %1% exceeds maximum capacity %2%")
+                                               % capacity % MAX_CAPACITY));
+    }
+
+    for (unsigned int i = 0; !open(alignRecord(capacity)); ++i) {
+        if (i == OPEN_ATTEMPTS) {
+            throw CommException(boost::str(boost::format("Could not open shared memory segment %1%: segment is replaced concurrently")
+                                           % name));
+        }
+    }
+
+    RSCDEBUG(logger, "Opened ring " << name << " with capacity "
+             << this->header->capacity);
+}
+
+Ring::~Ring() {
+    munmap(this->header, this->size);
+}
+
+bool Ring::open(size_t capacity) {
+    const string path = "/" + this->name;
+
+    int fd = shm_open(path.c_str(), O_RDWR | O_CREAT, 0666);
+    if (fd == -1) {
+        throw CommException(errorMessage("open", this->name, errno));
+    }
+
+    // The lock on the segment serializes its initialization. Unlike
+    // a mutex in the segment, it is released if its holder dies.
+    int result;
+    while (((result = flock(fd, LOCK_EX)) == -1) && (errno == EINTR)) {
+    }
+    struct stat status;
+    if ((result == -1) || (fstat(fd, &status) == -1)) {
+        int error = errno;
+        close(fd);
+        throw CommException(errorMessage("lock", this->name, error));
+    }
+
+    // An empty segment has just been created, either by us or by a
+    // process which died before initializing it.
+    const bool create = (status.st_size == 0);
+    size_t size = create ? DATA_OFFSET + capacity : status.st_size;
+    if (create && (ftruncate(fd, size) == -1)) {
+        int error = errno;
+        close(fd);
+        throw CommException(errorMessage("resize", this->name, error));
+    }
+    void* address = MAP_FAILED;
+    if (size > DATA_OFFSET) {
+        address = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (address == MAP_FAILED) {
+        int error = errno;
+        close(fd);
+        throw CommException(errorMessage("map", this->name, error));
+    }
+    Header* header = static_cast<Header*>(address);
+
+    if (create) {
+        memset(header, 0, DATA_OFFSET);
+        header->capacity = capacity;
+
+        pthread_mutexattr_t attributes;
+        pthread_mutexattr_init(&attributes);
+        pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+        pthread_mutex_init(&header->writeMutex, &attributes);
+        pthread_mutexattr_destroy(&attributes);
+
+        header->version = VERSION;
+        __atomic_store_n(&header->magic, MAGIC, __ATOMIC_RELEASE);
+    } else if ((header->magic != MAGIC) || (header->version != VERSION)
+               || (DATA_OFFSET + header->capacity != size)) {
+        RSCWARN(logger, "Replacing stale or incompatible shared memory segment "
+                << this->name);
+
+        // Only remove the segment if the name still refers to it and
+        // not to a replacement created by another process.
+        int current = shm_open(path.c_str(), O_RDWR, 0);
+        struct stat currentStatus;
+        if ((current != -1) && (fstat(current, &currentStatus) == 0)
+            && (currentStatus.st_dev == status.st_dev)
+            && (currentStatus.st_ino == status.st_ino)) {
+            shm_unlink(path.c_str());
+        }
+        if (current != -1) {
+            close(current);
+        }
+
+        munmap(address, size);
+        close(fd);
+        return false;
+    }
+
+    // The mapping keeps the open file description and thus the lock
+    // alive, so the lock has to be released explicitly.
+    flock(fd, LOCK_UN);
+    close(fd);
+
+    this->size   = size;
+    this->header = header;
+    this->data   = static_cast<char*>(address) + DATA_OFFSET;
+    return true;
+}
+
+bool Ring::remove(const string& name) {
+    return shm_unlink(("/" + name).c_str()) == 0;
+}
+
+const string& Ring::getName() const {
+    return this->name;
+}
+
+boost::uint64_t Ring::getWritePosition() const {
+    return __atomic_load_n(&this->header->writePosition, __ATOMIC_ACQUIRE);
+}
+
+void Ring::write(const char* frame, size_t size) {
+    const boost::uint64_t capacity = this->header->capacity;
+    const boost::uint64_t recordSize = alignRecord(RECORD_HEADER_SIZE + size);
+    if ((size >= SKIP_FLAG) || (recordSize > capacity)) {
+        throw std::invalid_argument(boost::str(boost::format("Frame of size %1% does not fit into ring of capacity %2%")
+                                               % size % capacity));
+    }
+
+    WriteLock lock(*this);
+
+    // Skip the remainder of the data area if the record does not fit
+    // in front of its end.
+    const boost::uint64_t position = this->header->writePosition;
+    boost::uint64_t start = position;
+    if ((position % capacity) + recordSize > capacity) {
+        start += capacity - (position % capacity);
+    }
+    const boost::uint64_t end = start + recordSize;
+
+    // Announce the overwritten area before modifying it. Pairs with
+    // the acquire fence in isIntact.
+    __atomic_store_n(&this->header->reservePosition, end, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    writeSkip(position, start);
+    boost::uint32_t length = size;
+    char* record = this->data + (start % capacity);
+    memcpy(record, &length, RECORD_HEADER_SIZE);
+    memcpy(record + RECORD_HEADER_SIZE, frame, size);
+
+    publish(end);
+}
+
+bool Ring::read(boost::uint64_t&    position,
+                const FrameHandler& handler,
+                unsigned int        timeoutMillis) {
+    const boost::uint64_t capacity = this->header->capacity;
+
+    if ((getWritePosition() == position) && !wait(position, timeoutMillis)) {
+        return false;
+    }
+
+    while (getWritePosition() != position) {
+        const char* record = this->data + (position % capacity);
+        boost::uint32_t header;
+        memcpy(&header, record, RECORD_HEADER_SIZE);
+        if (!isIntact(position)) {
+            break;
+        }
+
+        const bool skip = header & SKIP_FLAG;
+        const boost::uint64_t recordSize
+            = skip ? (header & ~SKIP_FLAG) : alignRecord(RECORD_HEADER_SIZE + header);
+        if ((recordSize == 0) || ((position % capacity) + recordSize > capacity)) {
+            RSCWARN(logger, "Invalid record header " << header << " in ring "
+                    << this->name << "; skipping to write position");
+            position = getWritePosition();
+            return false;
+        }
+        if (skip) {
+            position += recordSize;
+            continue;
+        }
+
+        // The handler processes the frame in place. Afterwards, we
+        // check whether writers have started overwriting it in the
+        // meantime.
+        const bool handled = handler(record + RECORD_HEADER_SIZE, header);
+        if (!isIntact(position)) {
+            break;
+        }
+        position += recordSize;
+        return handled;
+    }
+
+    if (getWritePosition() != position) {
+        const boost::uint64_t writePosition = getWritePosition();
+        RSCWARN(logger, "Reader fell behind in ring " << this->name << "; skipping "
+                << (writePosition - position) << " bytes");
+        position = writePosition;
+    }
+    return false;
+}
+
+void Ring::interrupt() {
+    __atomic_fetch_add(&this->header->sequence, 1, __ATOMIC_SEQ_CST);
+    syscall(SYS_futex, &this->header->sequence, FUTEX_WAKE, INT_MAX, 0, 0, 0);
+}
+
+void Ring::lock() {
+    int result = pthread_mutex_lock(&this->header->writeMutex);
+    if (result == EOWNERDEAD) {
+        RSCWARN(logger, "A writer died while writing to ring " << this->name
+                << "; discarding its frame");
+
+        const boost::uint64_t position = this->header->writePosition;
+        const boost::uint64_t end      = this->header->reservePosition;
+        if (end != position) {
+            writeSkip(position, end);
+            publish(end);
+        }
+        pthread_mutex_consistent(&this->header->writeMutex);
+    } else if (result != 0) {
+        throw CommException(errorMessage("lock", this->name, result));
+    }
+}
+
+void Ring::unlock() {
+    pthread_mutex_unlock(&this->header->writeMutex);
+}
+
+bool Ring::isIntact(boost::uint64_t position) const {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&this->header->reservePosition, __ATOMIC_RELAXED)
+        <= position + this->header->capacity;
+}
+
+bool Ring::wait(boost::uint64_t position, unsigned int timeoutMillis) {
+    // Writers increment the sequence after publishing a frame and
+    // only wake readers if there are waiters. Sequentially consistent
+    // operations on both words ensure that either the writer sees our
+    // registration or the futex sees the incremented sequence.
+    const boost::uint32_t sequence
+        = __atomic_load_n(&this->header->sequence, __ATOMIC_SEQ_CST);
+    if (getWritePosition() != position) {
+        return true;
+    }
+
+    struct timespec timeout;
+    timeout.tv_sec  = timeoutMillis / 1000;
+    timeout.tv_nsec = (timeoutMillis % 1000) * 1000000;
+
+    __atomic_fetch_add(&this->header->waiters, 1, __ATOMIC_SEQ_CST);
+    syscall(SYS_futex, &this->header->sequence, FUTEX_WAIT, sequence, &timeout, 0, 0);
+    __atomic_fetch_sub(&this->header->waiters, 1, __ATOMIC_SEQ_CST);
+
+    return getWritePosition() != position;
+}
+
+void Ring::writeSkip(boost::uint64_t start, boost::uint64_t end) {
+    const boost::uint64_t capacity = this->header->capacity;
+    while (start != end) {
+        const boost::uint64_t next
+            = min(end, start + (capacity - (start % capacity)));
+        boost::uint32_t header = SKIP_FLAG | boost::uint32_t(next - start);
+        memcpy(this->data + (start % capacity), &header, RECORD_HEADER_SIZE);
+        start = next;
+    }
+}
+
+void Ring::publish(boost::uint64_t position) {
+    __atomic_store_n(&this->header->writePosition, position, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&this->header->sequence, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&this->header->waiters, __ATOMIC_SEQ_CST) > 0) {
+        syscall(SYS_futex, &this->header->sequence, FUTEX_WAKE, INT_MAX, 0, 0, 0);
+    }
+}
+
+}
+}
+}
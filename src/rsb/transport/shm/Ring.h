@@ -0,0 +1,187 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#pragma once
+
+#include <string>
+
+#include <boost/cstdint.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <rsc/logging/Logger.h>
+
+#include "rsb/rsbexports.h"
+
+namespace rsb {
+namespace transport {
+namespace shm {
+
+/**
+ * Instances of this class provide access to a multi-producer,
+ * multi-consumer broadcast ring of frames in a named shared memory
+ * segment.
+ *
+ * Any number of processes can open the same ring by name. Writers
+ * append frames under a robust inter-process mutex: if a writer dies
+ * while holding it, the next writer discards the partially written
+ * frame and continues. Readers do not take any locks. Each reader
+ * maintains its own read position, processes frames in place and
+ * afterwards checks that the frame has not been overwritten in the
+ * meantime. Readers waiting for frames are woken up via a futex in
+ * the shared memory segment. Writers never wait for readers: a reader
+ * which falls behind by more than the capacity of the ring loses the
+ * overwritten frames.
+ *
+ * When opening a ring, a segment which has not been initialized
+ * completely, for example because its creator died, or which has an
+ * incompatible layout is replaced by a new segment. The shared memory
+ * segment is not removed when the last process closes the ring,
+ * since there is no reliable way to detect this (see @ref remove).
+ *
+ * @author jmoringe
+ */
+class RSB_EXPORT Ring {
+public:
+    /**
+     * Called with a pointer to a frame in the shared memory segment
+     * and the size of the frame. Has to return @c true if the frame
+     * has been processed successfully. The frame may be overwritten
+     * by writers while it is processed, in which case the result of
+     * the processing is discarded (see @ref read).
+     */
+    typedef boost::function<bool (const char* frame, std::size_t size)> FrameHandler;
+
+    /**
+     * Opens the ring named @a name or creates it with a data area of
+     * @a capacity bytes. When opening an existing ring, @a capacity is
+     * ignored.
+     *
+     * @param name Name of the shared memory segment.
+     * @param capacity Size of the data area of the ring in bytes.
+     * @throw std::invalid_argument If @a capacity is too large.
+     * @throw CommException If the segment cannot be opened or
+     *                      created.
+     */
+    Ring(const std::string& name, std::size_t capacity);
+    ~Ring();
+
+    /**
+     * Returns the name of the shared memory segment.
+     *
+     * @return The name.
+     */
+    const std::string& getName() const;
+
+    /**
+     * Returns the position at which the next frame will be
+     * written. Readers start reading at this position to only receive
+     * subsequently written frames.
+     *
+     * @return The current write position.
+     */
+    boost::uint64_t getWritePosition() const;
+
+    /**
+     * Appends the @a size bytes at @a frame to the ring and wakes up
+     * waiting readers.
+     *
+     * @param frame The frame that should be written.
+     * @param size The size of the frame in bytes.
+     * @throw std::invalid_argument If @a frame does not fit into the
+     *                              ring.
+     */
+    void write(const char* frame, std::size_t size);
+
+    /**
+     * Processes the frame at @a position using @a handler, waiting up
+     * to @a timeoutMillis milliseconds for a frame to be written.
+     *
+     * @param position The read position of the calling reader. Is
+     *                 advanced past the frame that has been read or,
+     *                 if frames have been overwritten before they
+     *                 could be read, to the current write position.
+     * @param handler Called with the frame in the shared memory
+     *                segment.
+     * @param timeoutMillis Maximum time to wait for a frame.
+     * @return @c true if @a handler processed a frame which has not
+     *         been overwritten during the processing, @c false
+     *         otherwise, for example because of a timeout.
+     */
+    bool read(boost::uint64_t&    position,
+              const FrameHandler& handler,
+              unsigned int        timeoutMillis);
+
+    /**
+     * Wakes up all readers blocked in @ref read.
+     */
+    void interrupt();
+
+    /**
+     * Removes the shared memory segment of the ring named @a
+     * name. Processes which have the ring open can continue to use it
+     * but are disconnected from processes which open the ring
+     * afterwards.
+     *
+     * @param name Name of the shared memory segment.
+     * @return @c true if the segment existed and has been removed.
+     */
+    static bool remove(const std::string& name);
+private:
+    struct Header;
+
+    class WriteLock {
+    public:
+        WriteLock(Ring& ring);
+        ~WriteLock();
+    private:
+        Ring& ring;
+    };
+
+    rsc::logging::LoggerPtr logger;
+
+    std::string             name;
+    std::size_t             size;
+    Header*                 header;
+    char*                   data;
+
+    bool open(std::size_t capacity);
+
+    void lock();
+    void unlock();
+
+    bool isIntact(boost::uint64_t position) const;
+    bool wait(boost::uint64_t position, unsigned int timeoutMillis);
+
+    void writeSkip(boost::uint64_t start, boost::uint64_t end);
+    void publish(boost::uint64_t position);
+};
+
+typedef boost::shared_ptr<Ring> RingPtr;
+
+}
+}
+}
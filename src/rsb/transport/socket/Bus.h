@@ -34,6 +34,8 @@
 
 #include "../../eventprocessing/Handler.h"
 
+#include "BusOptions.h"
+
 #include "rsb/rsbexports.h"
 
 namespace rsb {
@@ -46,6 +48,9 @@ typedef boost::shared_ptr<InConnector> InConnectorPtr;
 class BusConnection;
 typedef boost::shared_ptr<BusConnection> BusConnectionPtr;
 
+class ReceivedFrame;
+class OutgoingEvent;
+
 /**
  * Instances of this class provide access to a socket-based bus.
  *
@@ -86,11 +91,42 @@ public:
      */
     virtual void removeConnection(BusConnectionPtr connection) = 0;
 
-    virtual bool isTcpnodelay() const = 0;
+    /**
+     * Returns the options with which this bus has been created. The
+     * connection-related options apply to all connections of the
+     * bus.
+     */
+    virtual const BusOptions& getOptions() const = 0;
 
+    /**
+     * Dispatches @a event, the payload of which has to be serialized
+     * already, to local sinks and connections.
+     *
+     * @param event The event that should be dispatched.
+     */
     virtual void handle(EventPtr event) = 0;
 
-    virtual void handleIncoming(EventPtr         event,
+    /**
+     * Dispatches @a event, which has been submitted by a local
+     * connector, to interested local sinks and connections. Local
+     * sinks receive the original payload of @a event if it has not
+     * been serialized. Serialization is only performed if @a event
+     * has to be sent via at least one connection.
+     *
+     * @param event The event that should be dispatched.
+     */
+    virtual void handleOutgoing(OutgoingEvent& event) = 0;
+
+    /**
+     * Dispatches @a frame, which has been received via @a
+     * connection, to interested local sinks and, if applicable, to
+     * other connections.
+     *
+     * @param frame The received frame.
+     * @param connection The connection via which @a frame has been
+     *                   received.
+     */
+    virtual void handleIncoming(ReceivedFrame&   frame,
                                 BusConnectionPtr connection) = 0;
 
     virtual const std::string getTransportURL() const = 0;
@@ -30,16 +30,19 @@
 #include <boost/format.hpp>
 
 #include <rsc/misc/langutils.h>
+#include <rsc/runtime/ContainerIO.h>
+
+#include "../../protocol/ProtocolException.h"
 
 #include "Bus.h"
-#include "Serialization.h"
+#include "ReceivedFrame.h"
+#include "WireFormat.h"
 
 using namespace std;
 
 using namespace boost;
 
 using namespace boost::asio;
-//using tcp = boost::asio::ip::tcp;
 
 using namespace rsc::logging;
 
@@ -47,6 +50,8 @@ namespace rsb {
 namespace transport {
 namespace socket {
 
+const size_t BusConnection::RECEIVE_BUFFER_SIZE = 64 * 1024;
+
 // Return the exception's what() string falling back to a replacement
 // string in case what() throws an exception.
 std::string safeSocketExceptionString(const std::exception& exception) {
@@ -57,30 +62,46 @@ std::string safeSocketExceptionString(const std::exception& exception) {
     }
 }
 
-BusConnection::BusConnection(BusPtr    bus,
-                             SocketPtr socket,
-                             bool      client,
-                             bool      tcpNoDelay) :
+BusConnection::BusConnection(BusPtr            bus,
+                             SocketPtr         socket,
+                             io_service&       service,
+                             bool              client,
+                             const BusOptions& options) :
     logger(Logger::getLogger("rsb.transport.socket.BusConnection")),
-    socket(socket), bus(bus), disconnecting(false), activeShutdown(false) {
+    socket(socket), strand(service), bus(bus), client(client),
+    peerNegotiation(false),
+    disconnecting(false), activeShutdown(false),
+    receiveStart(0), receiveEnd(0),
+    sending(false), queuedBytes(0), maxQueuedBytes(options.maxQueuedBytes),
+    flushDelay(options.flushDelay), flushTimer(service),
+    headerDictionary(options.headerDictionary), peerHeaderDictionary(false),
+    compression(options.compression),
+    compressionThreshold(options.compressionThreshold), peerCompression(false),
+    peerSubscriptions(false), subscriptionsKnown(false) {
 
     // Enable TCPNODELAY socket option to trade decreased throughput
-    // for reduced latency.
-    if (tcpNoDelay){
+    // for reduced latency. The option does not apply to local
+    // sockets.
+    if (options.tcpnodelay && !isLocalEndpoint(socket->local_endpoint())) {
         RSCINFO(logger, "Setting TCP_NODELAY option");
         boost::asio::ip::tcp::no_delay option(true);
         socket->set_option(option);
     }
 
     // Allocate static buffers.
-    this->lengthReceiveBuffer.resize(4);
-    this->lengthSendBuffer.resize(4);
+    this->receiveBuffer.resize(RECEIVE_BUFFER_SIZE);
 
-    // Perform request role of the handshake.
+    // Perform request role of the handshake. Bus servers advertise
+    // support for negotiation notifications in the handshake.
     if (client) {
-        read(*this->socket, buffer(&this->lengthReceiveBuffer[0], 4));
+        read(*this->socket, buffer(&this->receiveBuffer[0], 4));
+        const uint32_t handshake = readLengthHeader(
+            string(&this->receiveBuffer[0], 4));
+        this->peerNegotiation = (handshake & HANDSHAKE_NEGOTIATION_FLAG) != 0;
     } else {
-        write(*this->socket, buffer(this->lengthSendBuffer));
+        string handshake;
+        appendLengthHeader(handshake, HANDSHAKE_NEGOTIATION_FLAG);
+        write(*this->socket, buffer(handshake));
     }
 }
 
@@ -96,8 +117,10 @@ void BusConnection::shutdown() {
     boost::recursive_mutex::scoped_lock lock(this->mutex);
     this->activeShutdown = true;
 
-    if (this->socket && this->socket->is_open()) {
-        this->socket->shutdown(ip::tcp::socket::shutdown_send);
+    // If frames are still queued, the sending direction is shut down
+    // once the queue has been drained (see handleWrite()).
+    if (!this->sending && this->socket && this->socket->is_open()) {
+        this->socket->shutdown(socket_base::shutdown_send);
     }
 
 }
@@ -108,6 +131,8 @@ void BusConnection::disconnect() {
     boost::recursive_mutex::scoped_lock lock(this->mutex);
     this->disconnecting = true;
 
+    cancelFlushTimer();
+
     if (this->socket && this->socket->is_open()) {
         this->socket->close();
     }
@@ -115,45 +140,345 @@ void BusConnection::disconnect() {
 }
 
 void BusConnection::startReceiving() {
+    // Clients propose subscription announcements, the use of a
+    // header dictionary and compression if the bus server advertised
+    // that it understands the proposals. Otherwise, the bus server
+    // would relay them to its other clients. The bus server confirms
+    // the proposals if it supports them.
+    const bool propose = this->client && this->peerNegotiation;
+    if (propose) {
+        sendFrame(subscriptionNegotiationToFrame(false));
+    }
+    if (propose && this->headerDictionary) {
+        sendFrame(headerDictionaryToFrame(false));
+    }
+    if (propose && (this->compression != CODEC_NONE)) {
+        sendFrame(compressionToFrame(false, codecNames(availableCodecs())));
+    }
+
     receiveEvent();
 }
 
 void BusConnection::sendEvent(EventPtr      event,
                               const string& wireSchema) {
-
-
     // Convert the event into a notification object and serialize the
     // notification object.
     // The payload already is a byte-array, since it has been
     // serialized by the connector which submitted the event.
-    protocol::Notification notification;
-    eventToNotification(notification, event, wireSchema,
-                        *static_pointer_cast<string>(event->getData()));
-    notification.SerializeToString(&this->messageSendBuffer);
-
-    // Encode the size of the serialized notification object.
-    uint32_t length = this->messageSendBuffer.size();
-    this->lengthSendBuffer[0] = (length & 0x000000fful) >> 0;
-    this->lengthSendBuffer[1] = (length & 0x0000ff00ul) >> 8;
-    this->lengthSendBuffer[2] = (length & 0x00ff0000ul) >> 16;
-    this->lengthSendBuffer[3] = (length & 0xff000000ul) >> 24;
+    sendFrame(eventToFrame(event, wireSchema,
+                           *static_pointer_cast<string>(event->getData())));
+}
 
+void BusConnection::sendFrame(FramePtr frame) {
     {
         boost::recursive_mutex::scoped_lock lock(this->mutex);
-        if (this->activeShutdown) {
+        if (this->activeShutdown || this->disconnecting) {
             RSCDEBUG(this->logger, "Ignoring to send a notification "
                                    "because we are shutting down.");
             return;
         }
 
-        // Send the size header, followed by the actual notification data.
-        write(*this->socket, buffer(this->lengthSendBuffer));
-        write(*this->socket, buffer(this->messageSendBuffer));
+        // Close the connection instead of queuing frames without
+        // bound for a peer which does not read. Dropping frames is
+        // not an option since the peer could not decode subsequent
+        // frames which refer to header dictionary entries defined
+        // by a dropped frame. The queued frames are released and
+        // the connection is removed from the bus by the completion
+        // handlers of the aborted operations.
+        if ((this->maxQueuedBytes != 0) && (this->queuedBytes != 0)
+            && (this->queuedBytes + frame->size() > this->maxQueuedBytes)) {
+            RSCWARN(this->logger, "Peer does not read fast enough ("
+                    << this->queuedBytes << " bytes queued, limit "
+                    << this->maxQueuedBytes << " bytes); closing connection");
+            disconnect();
+            return;
+        }
+
+        if (this->peerHeaderDictionary) {
+            frame = this->headerEncoder.encode(frame);
+        }
+        this->sendQueue.push_back(frame);
+        this->queuedBytes += frame->size();
+
+        // If a write operation is in progress, the frame will be
+        // picked up when it completes.
+        if (this->sending) {
+            return;
+        }
+        this->sending = true;
+    }
+
+    // Write operations are only initiated from the strand of this
+    // connection so that they cannot interfere with the receive
+    // operations on the same socket.
+    if (this->flushDelay == 0) {
+        this->strand.post(boost::bind(&BusConnection::startSending, shared_from_this()));
+    } else {
+        // Frames queued until the timer expires are written together
+        // with this one.
+        boost::recursive_mutex::scoped_lock lock(this->mutex);
+        this->flushTimer.expires_from_now(
+            boost::posix_time::microseconds(this->flushDelay));
+        this->flushTimer.async_wait(
+            this->strand.wrap(
+                boost::bind(&BusConnection::handleFlushTimer, shared_from_this(),
+                            boost::asio::placeholders::error)));
+    }
+}
+
+void BusConnection::handleFlushTimer(const boost::system::error_code& error) {
+    // The timer is cancelled when the connection is closed. Queued
+    // frames cannot be written anymore in that case.
+    if (error || this->disconnecting) {
+        RSCDEBUG(logger, "Discarding queued frames since flush timer "
+                 << "was cancelled or failed (error " << error << ")");
+        {
+            boost::recursive_mutex::scoped_lock lock(this->mutex);
+            this->sendQueue.clear();
+            this->queuedBytes = 0;
+            this->sending = false;
+        }
+        if (error != boost::asio::error::operation_aborted) {
+            performSafeCleanup("handleFlushTimer");
+        }
+        return;
+    }
+
+    startSending();
+}
+
+void BusConnection::cancelFlushTimer() {
+    boost::recursive_mutex::scoped_lock lock(this->mutex);
+
+    boost::system::error_code ignored;
+    this->flushTimer.cancel(ignored);
+}
+
+void BusConnection::sendFrame(FrameVariants& frames) {
+    CodecSet peerCodecs;
+    {
+        boost::recursive_mutex::scoped_lock lock(this->mutex);
+        peerCodecs = this->peerCodecs;
+    }
+    FramePtr frame = frames.getFrame(this->compression,
+                                     this->compressionThreshold, peerCodecs);
+    if (!frame) {
+        RSCWARN(this->logger, "Not sending malformed compressed frame to peer"
+                              " which cannot decompress it");
+        return;
+    }
+    sendFrame(frame);
+}
+
+void BusConnection::sendSubscriptions(FramePtr frame) {
+    boost::recursive_mutex::scoped_lock lock(this->mutex);
+
+    if (this->peerSubscriptions) {
+        sendFrame(frame);
+    } else {
+        this->subscriptionsFrame = frame;
+    }
+}
+
+bool BusConnection::isInterestedIn(const Scope& scope) {
+    boost::recursive_mutex::scoped_lock lock(this->mutex);
+
+    // Peers which did not announce their subscriptions, for example
+    // clients using older versions or other implementations of the
+    // protocol, receive all events.
+    if (!this->subscriptionsKnown) {
+        return true;
+    }
+
+    for (set<Scope>::const_iterator it = this->subscriptions.begin();
+         it != this->subscriptions.end(); ++it) {
+        if ((scope == *it) || scope.isSubScopeOf(*it)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void BusConnection::handleSubscriptionNegotiation(bool acknowledgement) {
+    // See handleHeaderDictionary.
+    if (acknowledgement != this->client) {
+        return;
+    }
+
+    boost::recursive_mutex::scoped_lock lock(this->mutex);
+    if (this->peerSubscriptions) {
+        return;
+    }
+    this->peerSubscriptions = true;
+
+    // The bus server acknowledges the proposal of the client. The
+    // client sends its most recent announcement, if any. Later
+    // announcements are sent immediately.
+    if (!this->client) {
+        sendFrame(subscriptionNegotiationToFrame(true));
+    } else if (this->subscriptionsFrame) {
+        sendFrame(this->subscriptionsFrame);
+        this->subscriptionsFrame.reset();
+    }
+    RSCDEBUG(logger, "Using subscription announcements");
+}
+
+void BusConnection::handleSubscriptions(const protocol::Notification& notification) {
+    // Subscription announcements are only meaningful for the bus
+    // server and only accepted after the client proposed them.
+    if (this->client) {
+        return;
+    }
+    {
+        boost::recursive_mutex::scoped_lock lock(this->mutex);
+        if (!this->peerSubscriptions) {
+            RSCDEBUG(logger, "Ignoring subscription announcement which has not been negotiated");
+            return;
+        }
+    }
+
+    try {
+        set<Scope> subscriptions = notificationToSubscriptions(notification);
+        RSCDEBUG(logger, "Received subscriptions " << subscriptions);
+
+        boost::recursive_mutex::scoped_lock lock(this->mutex);
+        this->subscriptions.swap(subscriptions);
+        this->subscriptionsKnown = true;
+    } catch (const std::exception& e) {
+        RSCWARN(logger, "Ignoring malformed subscription announcement: "
+                << e.what());
+    }
+}
+
+void BusConnection::handleHeaderDictionary(bool acknowledgement) {
+    if (!this->headerDictionary) {
+        RSCDEBUG(logger, "Ignoring header dictionary negotiation since header dictionaries are disabled");
+        return;
+    }
+
+    // Clients only accept acknowledgements, bus servers only
+    // proposals. Clients thus ignore proposals which a bus server
+    // relays from other clients despite advertising support for
+    // negotiations in its handshake.
+    if (acknowledgement != this->client) {
+        return;
+    }
+
+    boost::recursive_mutex::scoped_lock lock(this->mutex);
+    if (this->peerHeaderDictionary) {
+        return;
+    }
+
+    // The bus server acknowledges the proposal of the client. The
+    // acknowledgement is queued before any encoded frame.
+    if (!this->client) {
+        sendFrame(headerDictionaryToFrame(true));
+    }
+    RSCDEBUG(logger, "Using header dictionary");
+    this->peerHeaderDictionary = true;
+}
+
+void BusConnection::handleCompression(bool acknowledgement, const CodecSet& codecs) {
+    if (this->compression == CODEC_NONE) {
+        RSCDEBUG(logger, "Ignoring compression negotiation since compression is disabled");
+        return;
+    }
+
+    // See handleHeaderDictionary.
+    if (acknowledgement != this->client) {
+        return;
+    }
+
+    boost::recursive_mutex::scoped_lock lock(this->mutex);
+    // Unlike the header dictionary, the codecs of the peer can change
+    // by a new proposal. Repeated proposals of the codecs which are
+    // already in effect are not acknowledged again.
+    if (this->peerCompression && (codecs == this->peerCodecs)) {
+        RSCDEBUG(logger, "Ignoring compression negotiation for codecs in effect");
+        return;
+    }
+
+    if (!this->client) {
+        sendFrame(compressionToFrame(true, codecNames(availableCodecs())));
+    }
+    RSCDEBUG(logger, "Peer can decompress " << codecNames(codecs));
+    this->peerCompression = true;
+    this->peerCodecs = codecs;
+}
+
+void BusConnection::startSending() {
+    // Take all queued frames and write them with a single gathering
+    // write operation. Frames contain their length header, so no
+    // further buffers are needed.
+    vector<const_buffer> buffers;
+    {
+        boost::recursive_mutex::scoped_lock lock(this->mutex);
+        this->writeQueue.swap(this->sendQueue);
+        buffers.reserve(this->writeQueue.size());
+        for (FrameQueue::const_iterator it = this->writeQueue.begin();
+             it != this->writeQueue.end(); ++it) {
+            buffers.push_back(buffer(**it));
+        }
+    }
+
+    RSCTRACE(logger, "Writing " << buffers.size() << " frame(s)");
+
+    // The frames are owned by the write queue until the write
+    // operation completes.
+    async_write(*this->socket,
+                buffers,
+                this->strand.wrap(
+                    boost::bind(&BusConnection::handleWrite, shared_from_this(),
+                                boost::asio::placeholders::error,
+                                boost::asio::placeholders::bytes_transferred)));
+}
+
+void BusConnection::handleWrite(const boost::system::error_code& error,
+                                size_t                           /*bytesTransferred*/) {
+    if (error) {
+        if (!this->disconnecting) {
+            RSCWARN(logger, "Send failure (error " << error << ")"
+                    << "; closing connection");
+        }
+        {
+            boost::recursive_mutex::scoped_lock lock(this->mutex);
+            this->sendQueue.clear();
+            this->writeQueue.clear();
+            this->queuedBytes = 0;
+            this->sending = false;
+        }
+        performSafeCleanup("handleWrite");
+        return;
     }
 
+    {
+        boost::recursive_mutex::scoped_lock lock(this->mutex);
+        for (FrameQueue::const_iterator it = this->writeQueue.begin();
+             it != this->writeQueue.end(); ++it) {
+            this->queuedBytes -= (*it)->size();
+        }
+        this->writeQueue.clear();
+        if (this->sendQueue.empty()) {
+            this->sending = false;
+
+            // Complete a shutdown that has been deferred until all
+            // queued frames were written.
+            if (this->activeShutdown && this->socket->is_open()) {
+                boost::system::error_code ignored;
+                this->socket->shutdown(socket_base::shutdown_send, ignored);
+            }
+            return;
+        }
+    }
+
+    startSending();
 }
 
 void BusConnection::performSafeCleanup(const string& context) {
+    // A pending flush timer keeps the connection alive until it
+    // expires.
+    cancelFlushTimer();
+
     // Remove ourselves from the bus to which we are connected.
     BusPtr bus = this->bus.lock();
     if (bus) {
@@ -178,20 +503,36 @@ void BusConnection::performSafeCleanup(const string& context) {
 }
 
 void BusConnection::receiveEvent() {
-    async_read(*this->socket,
-               buffer(&this->lengthReceiveBuffer[0], 4),
-               boost::bind(&BusConnection::handleReadLength, shared_from_this(),
-                           boost::asio::placeholders::error,
-                           boost::asio::placeholders::bytes_transferred));
+    // Move the start of a partially received frame to the beginning
+    // of the buffer to make room for its remaining bytes.
+    if (this->receiveStart != 0) {
+        std::copy(this->receiveBuffer.begin() + this->receiveStart,
+                  this->receiveBuffer.begin() + this->receiveEnd,
+                  this->receiveBuffer.begin());
+        this->receiveEnd -= this->receiveStart;
+        this->receiveStart = 0;
+    }
+
+    this->socket->async_read_some(
+        buffer(&this->receiveBuffer[this->receiveEnd],
+               this->receiveBuffer.size() - this->receiveEnd),
+        this->strand.wrap(
+            boost::bind(&BusConnection::handleRead, shared_from_this(),
+                        boost::asio::placeholders::error,
+                        boost::asio::placeholders::bytes_transferred)));
 }
 
-void BusConnection::handleReadLength(const boost::system::error_code& error,
-                                     size_t                    bytesTransferred) {
+void BusConnection::handleRead(const boost::system::error_code& error,
+                               size_t                    bytesTransferred) {
 
     {
         boost::recursive_mutex::scoped_lock lock(this->mutex);
         if (error == boost::asio::error::eof) {
             RSCDEBUG(logger, "Received eof");
+            if (this->receiveEnd != this->receiveStart) {
+                RSCDEBUG(logger, "Discarding incomplete frame ("
+                         << (this->receiveEnd - this->receiveStart) << " bytes)");
+            }
             if (!this->activeShutdown) {
                 try {
                     shutdown();
@@ -203,37 +544,82 @@ void BusConnection::handleReadLength(const boost::system::error_code& error,
                             << safeSocketExceptionString(e));
                 }
             }
-            performSafeCleanup("handleReadLength[eof]");
+            performSafeCleanup("handleRead[eof]");
             return;
         }
     }
 
-    if (error || (bytesTransferred != 4)) {
+    if (error) {
         if (!disconnecting) {
             RSCDEBUG(logger, "Receive failure (error " << error << ")"
-                     << " or incomplete message header (received " << bytesTransferred << " bytes)"
                      << "; closing connection");
         }
-        performSafeCleanup("handleReadLength[unknown error]");
+        performSafeCleanup("handleRead[unknown error]");
         return;
     }
 
-    uint32_t size
-        = (((uint32_t) *reinterpret_cast<unsigned char*>(&this->lengthReceiveBuffer[0])) << 0)
-        | (((uint32_t) *reinterpret_cast<unsigned char*>(&this->lengthReceiveBuffer[1])) << 8)
-        | (((uint32_t) *reinterpret_cast<unsigned char*>(&this->lengthReceiveBuffer[2])) << 16)
-        | (((uint32_t) *reinterpret_cast<unsigned char*>(&this->lengthReceiveBuffer[3])) << 24);
+    this->receiveEnd += bytesTransferred;
+
+    // Process all complete frames contained in the buffer.
+    while (this->receiveEnd - this->receiveStart >= 4) {
+        const unsigned char* header = reinterpret_cast<const unsigned char*>(
+            &this->receiveBuffer[this->receiveStart]);
+        uint32_t size
+            = (((uint32_t) header[0]) << 0)
+            | (((uint32_t) header[1]) << 8)
+            | (((uint32_t) header[2]) << 16)
+            | (((uint32_t) header[3]) << 24);
+        // The upper bits of the header are flags, which limits frames
+        // to 1 GiB (see FRAME_LENGTH_MASK).
+        size &= FRAME_LENGTH_MASK;
+        const size_t available = this->receiveEnd - this->receiveStart;
+
+        RSCTRACE(logger, "Received message header with size " << size);
+
+        // The frame is complete: copy it including its length header
+        // into a separate buffer which allows relaying the complete
+        // frame verbatim.
+        if (available >= 4 + size) {
+            FramePtr frame(new string(&this->receiveBuffer[this->receiveStart],
+                                      4 + size));
+            this->receiveStart += 4 + size;
+            if (!handleFrame(frame)) {
+                return;
+            }
+            continue;
+        }
 
-    RSCDEBUG(logger, "Received message header with size " << size);
+        // The frame does not fit into the buffer: receive the
+        // remaining bytes directly into a buffer for the frame.
+        if (4 + size > this->receiveBuffer.size()) {
+            // Allocate the final size upfront so that large frames
+            // are not copied when the buffer grows.
+            this->frameReceiveBuffer.reset(new string(4 + size, '\0'));
+            std::copy(this->receiveBuffer.begin() + this->receiveStart,
+                      this->receiveBuffer.begin() + this->receiveEnd,
+                      this->frameReceiveBuffer->begin());
+            this->receiveStart = this->receiveEnd = 0;
+
+            async_read(*this->socket,
+                       buffer(&(*this->frameReceiveBuffer)[available],
+                              4 + size - available),
+                       this->strand.wrap(
+                           boost::bind(&BusConnection::handleReadBody, shared_from_this(),
+                                       boost::asio::placeholders::error,
+                                       boost::asio::placeholders::bytes_transferred,
+                                       4 + size - available)));
+            return;
+        }
 
-    this->messageReceiveBuffer.resize(size);
+        break;
+    }
 
-    async_read(*this->socket,
-               buffer(&this->messageReceiveBuffer[0], size),
-               boost::bind(&BusConnection::handleReadBody, shared_from_this(),
-                           boost::asio::placeholders::error,
-                           boost::asio::placeholders::bytes_transferred,
-                           size));
+    // The buffer is empty or contains an incomplete frame which fits
+    // into the buffer.
+    if (this->receiveStart == this->receiveEnd) {
+        this->receiveStart = this->receiveEnd = 0;
+    }
+    receiveEvent();
 }
 
 void BusConnection::handleReadBody(const boost::system::error_code& error,
@@ -249,45 +635,97 @@ void BusConnection::handleReadBody(const boost::system::error_code& error,
         return;
     }
 
-    // Deserialize the notification.
-    if (!this->notification.ParseFromString(this->messageReceiveBuffer)) {
-        RSCWARN(logger, "Received unparseable protobuf message, closing connection");
-        performSafeCleanup("handleReadBody[parsing]");
+    FramePtr frame = this->frameReceiveBuffer;
+    this->frameReceiveBuffer.reset();
+    if (!handleFrame(frame)) {
         return;
     }
 
-    // Construct an Event instance *without* deserializing the
-    // payload. This has to be done in connectors since different
-    // converters can be used.
-    EventPtr event = notificationToEvent(this->notification, true);
+    // Submit task to start receiving the next event.
+    receiveEvent();
+}
 
-    // Dispatch the received event to connectors.
-    BusPtr bus = this->bus.lock();
-    if (bus) {
-        bus->handleIncoming(event, shared_from_this());
-    } else {
-        RSCWARN(logger, "Dangling bus pointer when trying to dispatch incoming event; closing connection");
-        performSafeCleanup("handleReadBody");
-        return;
+bool BusConnection::handleFrame(FramePtr frame) {
+    // Reconstruct frames encoded using the header dictionary.
+    if (isHeaderDictionaryFrame(*frame)) {
+        if (!this->headerDictionary) {
+            RSCWARN(logger, "Received frame using a header dictionary which has not been negotiated, closing connection");
+            performSafeCleanup("handleFrame[header dictionary]");
+            return false;
+        }
+        try {
+            frame = this->headerDecoder.decode(frame);
+        } catch (const std::exception& e) {
+            RSCWARN(logger, "Received malformed header dictionary frame: "
+                    << e.what() << "; closing connection");
+            performSafeCleanup("handleFrame[header dictionary]");
+            return false;
+        }
     }
 
-    // Submit task to start receiving the next event.
-    receiveEvent();
+    // Only the scope is read from the frame here. The notification
+    // is parsed, and its payload decompressed, for control messages
+    // of the transport and when a local sink is interested in the
+    // frame. Other frames are relayed as they are.
+    try {
+        ReceivedFrame receivedFrame(frame, this->notification);
+
+        // Subscription announcements and negotiations are handled by
+        // the connection itself.
+        const Scope& scope = receivedFrame.getScope();
+        if ((scope == subscriptionScope())
+            || (scope == headerDictionaryScope())
+            || (scope == compressionScope())) {
+            const protocol::Notification& notification
+                = receivedFrame.getNotification();
+            if (isSubscriptionNegotiationNotification(notification)) {
+                handleSubscriptionNegotiation(isNegotiationAcknowledgement(notification));
+                return true;
+            }
+            if (isSubscriptionNotification(notification)) {
+                handleSubscriptions(notification);
+                return true;
+            }
+            if (isHeaderDictionaryNotification(notification)) {
+                handleHeaderDictionary(isNegotiationAcknowledgement(notification));
+                return true;
+            }
+            if (isCompressionNotification(notification)) {
+                handleCompression(isNegotiationAcknowledgement(notification),
+                                  parseCodecs(notificationToCodecs(notification)));
+                return true;
+            }
+        }
+
+        // Dispatch the received frame to connectors and other
+        // connections.
+        BusPtr bus = this->bus.lock();
+        if (!bus) {
+            RSCWARN(logger, "Dangling bus pointer when trying to dispatch incoming event; closing connection");
+            performSafeCleanup("handleFrame");
+            return false;
+        }
+        bus->handleIncoming(receivedFrame, shared_from_this());
+    } catch (const protocol::ProtocolException& e) {
+        RSCWARN(logger, "Received malformed frame: " << e.what()
+                << "; closing connection");
+        performSafeCleanup("handleFrame[parsing]");
+        return false;
+    }
+    return true;
 }
 
 void BusConnection::printContents(ostream& stream) const {
     try {
-        stream << "local = " << this->socket->local_endpoint()
-               << ", remote = " << this->socket->remote_endpoint();
+        stream << "local = " << endpointToURL(this->socket->local_endpoint())
+               << ", remote = " << endpointToURL(this->socket->remote_endpoint());
     } catch (...) {
         stream << "<error printing socket info>";
     }
 }
 
 const std::string BusConnection::getTransportURL() const {
-    return boost::str(boost::format("socket://%1%:%2%")
-                      % this->socket->remote_endpoint().address().to_string()
-                      % this->socket->remote_endpoint().port());
+    return endpointToURL(this->socket->remote_endpoint());
 }
 
 }
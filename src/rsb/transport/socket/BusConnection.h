@@ -27,6 +27,9 @@
 #pragma once
 
 #include <string>
+#include <deque>
+#include <set>
+#include <vector>
 
 #include <boost/enable_shared_from_this.hpp>
 
@@ -38,9 +41,16 @@
 #include <rsc/runtime/Printable.h>
 
 #include "../../Event.h"
+#include "../../Scope.h"
 
 #include "../../protocol/Notification.h"
 
+#include "Serialization.h"
+#include "HeaderDictionary.h"
+#include "BusOptions.h"
+#include "Compression.h"
+#include "Types.h"
+
 #include "rsb/rsbexports.h"
 
 namespace rsb {
@@ -59,6 +69,10 @@ typedef boost::shared_ptr<Bus> BusPtr;
  * by calling @ref receiveEvent and submitting an event to the bus by
  * calling @ref sendEvent.
  *
+ * Incoming data is read in large chunks from which all complete
+ * frames are extracted, so bursts of small notifications require
+ * only few read operations.
+ *
  * In a process which acts as a client for a particular bus, a single
  * instance of this class is connected to the remote bus server and
  * provides access to the bus for all participants in the process.
@@ -67,19 +81,45 @@ typedef boost::shared_ptr<Bus> BusPtr;
  * (via the @ref BusServer class) one @ref BusConnection object for
  * each client (remote process) connected to the bus.
  *
- * This class is not thread-safe.
+ * Outgoing notifications are queued and written asynchronously by
+ * the thread(s) running the io_service of the socket. Therefore, @ref
+ * sendEvent can be called from arbitrary threads and does not block
+ * on slow or stalled remote peers. Connections to peers which let
+ * the queue grow beyond a configurable size are closed. All queued
+ * notifications are written by a single gathering write
+ * operation. Optionally, writes are delayed by a configurable time
+ * to let more notifications accumulate.
+ *
+ * Bus clients negotiate with the bus server whether to announce the
+ * scopes of their local sinks (see @ref subscriptionScope). All
+ * negotiations are only started if the bus server advertised
+ * support for them in its handshake (see @ref
+ * HANDSHAKE_NEGOTIATION_FLAG). The bus
+ * server then only sends events on these scopes to the client.
+ *
+ * If enabled, a connection negotiates the use of a header dictionary
+ * with its peer (see @ref headerDictionaryScope). Frames are then
+ * encoded and decoded by the connection when they are written and
+ * read respectively, so that the rest of the transport only deals
+ * with unencoded frames. Similarly, connections negotiate which
+ * payload compression codecs their peers can decompress (see @ref
+ * compressionScope). All completion handlers of a
+ * connection are executed by a strand so that notifications are
+ * received and sent in order even if the io_service is run by
+ * multiple threads. Apart from that, this class is not thread-safe.
  *
  * @author jmoringe
  */
 class RSB_EXPORT BusConnection : public boost::enable_shared_from_this<BusConnection>,
                                  public rsc::runtime::Printable {
 public:
-    typedef boost::shared_ptr<boost::asio::ip::tcp::socket> SocketPtr;
+    typedef boost::shared_ptr<boost::asio::generic::stream_protocol::socket> SocketPtr;
 
-    BusConnection(BusPtr    bus,
-                  SocketPtr socket,
-                  bool      client,
-                  bool      tcpNoDelay = false);
+    BusConnection(BusPtr                   bus,
+                  SocketPtr                socket,
+                  boost::asio::io_service& service,
+                  bool                     client,
+                  const BusOptions&        options = BusOptions());
 
     ~BusConnection();
 
@@ -87,44 +127,186 @@ public:
 
     void startReceiving();
 
+    /**
+     * Serializes @a event and enqueues the result for transmission
+     * to the remote peer.
+     *
+     * The actual write operation happens asynchronously. Write errors
+     * cause the connection to be closed and removed from its bus.
+     *
+     * @param event The event that should be sent. Its payload has to
+     *              be already serialized into a std::string.
+     * @param wireSchema The wire-schema of the serialized payload.
+     */
     void sendEvent(EventPtr           event,
                    const std::string& wireSchema);
 
+    /**
+     * Enqueues the already serialized @a frame for transmission to
+     * the remote peer.
+     *
+     * Since frames are immutable, the same frame can be sent via
+     * multiple connections without serializing the underlying event
+     * more than once.
+     *
+     * @param frame A frame produced by @ref eventToFrame.
+     */
+    void sendFrame(FramePtr frame);
+
+    /**
+     * Enqueues the variant of @a frames which is appropriate for the
+     * compression codecs negotiated with the remote peer. Malformed
+     * compressed frames are dropped if the peer cannot decompress
+     * them.
+     *
+     * @param frames The variants of a frame produced by @ref
+     *               eventToFrame.
+     */
+    void sendFrame(FrameVariants& frames);
+
+    /**
+     * Announces the subscriptions contained in @a frame to the bus
+     * server. The frame is sent once the bus server acknowledged
+     * subscription announcements (see @ref subscriptionScope). Until
+     * then, only the most recent announcement is kept.
+     *
+     * @param frame A frame produced by @ref subscriptionsToFrame.
+     */
+    void sendSubscriptions(FramePtr frame);
+
+    /**
+     * Indicates whether the remote peer is interested in events on
+     * @a scope.
+     *
+     * Bus clients can announce the scopes of their local sinks to
+     * the bus server. For server-side connections of such clients,
+     * this method returns @c true only if @a scope is one of the
+     * announced scopes or a sub-scope of one. For all other
+     * connections, this method returns @c true.
+     *
+     * @param scope The scope of the event that should be sent.
+     * @return @c true if events on @a scope should be sent via this
+     *         connection, @c false otherwise.
+     */
+    bool isInterestedIn(const Scope& scope);
+
     virtual const std::string getTransportURL() const;
 private:
     typedef boost::weak_ptr<Bus> WeakBusPtr;
 
+    typedef std::deque<FramePtr> FrameQueue;
+
     rsc::logging::LoggerPtr logger;
 
     SocketPtr               socket;
+    boost::asio::io_service::strand strand;
 
     WeakBusPtr              bus;
 
+    bool                    client;
+
+    // Indicates whether the bus server advertised support for the
+    // negotiation notifications in its handshake. Only meaningful for
+    // client-side connections.
+    bool                    peerNegotiation;
+
     volatile bool           disconnecting;
     volatile bool           activeShutdown;
 
     boost::recursive_mutex  mutex;
 
-    // Receive buffers
-    protocol::Notification  notification;
-    std::string             lengthReceiveBuffer;
-    std::string             messageReceiveBuffer;
-
-    // Send buffers
-    std::string             lengthSendBuffer;
-    std::string             messageSendBuffer;
+    // Receive buffers. Data is read in chunks of up to
+    // RECEIVE_BUFFER_SIZE bytes into receiveBuffer. The bytes in
+    // [receiveStart, receiveEnd) have been received but not yet
+    // processed. Frames larger than receiveBuffer are completed in
+    // frameReceiveBuffer.
+    static const size_t            RECEIVE_BUFFER_SIZE;
+
+    protocol::Notification         notification;
+    std::vector<char>              receiveBuffer;
+    size_t                         receiveStart;
+    size_t                         receiveEnd;
+    boost::shared_ptr<std::string> frameReceiveBuffer;
+
+    // Send queue. Frames are moved to writeQueue when a write
+    // operation starts and released when it completes.
+    FrameQueue              sendQueue;
+    FrameQueue              writeQueue;
+    bool                    sending;
+
+    // Number of bytes in sendQueue and writeQueue. The connection is
+    // closed if queuing a frame would exceed maxQueuedBytes.
+    std::size_t             queuedBytes;
+    std::size_t             maxQueuedBytes;
+
+    // Delay in microseconds between queuing a frame into an empty
+    // queue and starting to write.
+    unsigned int                flushDelay;
+    boost::asio::deadline_timer flushTimer;
+
+    // Header dictionary state. Outgoing frames are only encoded after
+    // the peer agreed to use a header dictionary. The encoder is
+    // protected by mutex, the decoder is only used by the strand.
+    bool                    headerDictionary;
+    bool                    peerHeaderDictionary;
+    HeaderDictionaryEncoder headerEncoder;
+    HeaderDictionaryDecoder headerDecoder;
+
+    // Compression state. peerCodecs contains the codecs the peer can
+    // decompress, peerCompression indicates that they have been
+    // negotiated. Both are protected by mutex.
+    Codec                   compression;
+    unsigned int            compressionThreshold;
+    bool                    peerCompression;
+    CodecSet                peerCodecs;
+
+    // Subscription state. peerSubscriptions indicates that the
+    // announcements have been negotiated. subscriptionsFrame is the
+    // announcement a client sends once the bus server acknowledged.
+    // subscriptionsKnown and subscriptions hold the scopes announced
+    // by the client of a server-side connection. All are protected by
+    // mutex.
+    bool                    peerSubscriptions;
+    FramePtr                subscriptionsFrame;
+    bool                    subscriptionsKnown;
+    std::set<Scope>         subscriptions;
+
+    void handleSubscriptionNegotiation(bool acknowledgement);
+
+    void handleSubscriptions(const protocol::Notification& notification);
+
+    void handleHeaderDictionary(bool acknowledgement);
+
+    void handleCompression(bool acknowledgement, const CodecSet& codecs);
 
     void performSafeCleanup(const std::string& context);
 
     void receiveEvent();
 
-    void handleReadLength(const boost::system::error_code& error,
-                          size_t                           bytesTransferred);
+    void handleRead(const boost::system::error_code& error,
+                    size_t                           bytesTransferred);
 
     void handleReadBody(const boost::system::error_code& error,
                         size_t                           bytesTransferred,
                         size_t                           expected);
 
+    /**
+     * Parses and dispatches the complete @a frame.
+     *
+     * @return @c false if the connection has been closed due to an
+     *         error, @c true otherwise.
+     */
+    bool handleFrame(FramePtr frame);
+
+    void startSending();
+
+    void handleFlushTimer(const boost::system::error_code& error);
+
+    void cancelFlushTimer();
+
+    void handleWrite(const boost::system::error_code& error,
+                     size_t                           bytesTransferred);
+
     void printContents(std::ostream& stream) const;
 
     void disconnect();
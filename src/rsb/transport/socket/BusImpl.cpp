@@ -33,6 +33,9 @@
 #include "../../MetaData.h"
 
 #include "InConnector.h"
+#include "OutgoingEvent.h"
+#include "ReceivedFrame.h"
+#include "Serialization.h"
 
 using namespace std;
 
@@ -45,17 +48,19 @@ namespace rsb {
 namespace transport {
 namespace socket {
 
-BusImpl::BusImpl(AsioServiceContextPtr asioService, bool tcpnodelay) :
+BusImpl::BusImpl(AsioServiceContextPtr asioService,
+                 const BusOptions&     options) :
     logger(Logger::getLogger("rsb.transport.socket.BusImpl")),
-    asioService(asioService), tcpnodelay(tcpnodelay) {
+    asioService(asioService), options(options),
+    announcementSequenceNumber(0) {
 }
 
 BusImpl::~BusImpl() {
     RSCDEBUG(logger, "Destructing bus instance");
 
     // Sinks should be empty.
-    if (!this->sinkDispatcher.empty()) {
-        RSCWARN(logger, "" << this->sinkDispatcher.size() << " non-empty scopes when destructing");
+    if (!this->sinks.get()->empty()) {
+        RSCWARN(logger, "" << this->sinks.get()->size() << " non-empty scopes when destructing");
     }
 
     // Active connections hold a shared_ptr to themselves and would
@@ -77,8 +82,8 @@ AsioServiceContextPtr BusImpl::getService() const {
     return this->asioService;
 }
 
-bool BusImpl::isTcpnodelay() const {
-    return this->tcpnodelay;
+const BusOptions& BusImpl::getOptions() const {
+    return this->options;
 }
 
 BusImpl::ConnectionList BusImpl::getConnections() const {
@@ -94,23 +99,46 @@ void BusImpl::addSink(InConnectorPtr sink) {
 
     Scope scope = sink->getScope();
     RSCDEBUG(logger, "Adding sink " << sink << " to scope " << scope);
-    this->sinkDispatcher.addSink(scope, sink);
+    boost::shared_ptr<SinkDispatcher> sinks(new SinkDispatcher(*this->sinks.get()));
+    sinks->addSink(scope, sink);
+    this->sinks.set(sinks);
+
+    announceSubscriptions();
 }
 
 void BusImpl::removeSink(const InConnector* sink) {
-    boost::recursive_mutex::scoped_lock lock(this->connectorLock);
+    boost::uint64_t generation;
+    {
+        boost::recursive_mutex::scoped_lock lock(this->connectorLock);
 
-    Scope scope = sink->getScope();
-    RSCDEBUG(logger, "Removing sink " << sink << " from scope " << scope);
-    this->sinkDispatcher.removeSink(scope, sink);
+        Scope scope = sink->getScope();
+        RSCDEBUG(logger, "Removing sink " << sink << " from scope " << scope);
+        boost::shared_ptr<SinkDispatcher> sinks(new SinkDispatcher(*this->sinks.get()));
+        sinks->removeSink(scope, sink);
+        generation = this->sinks.set(sinks);
+
+        announceSubscriptions();
+    }
+
+    // Dispatches which still use a snapshot containing sink may call
+    // it until they finish.
+    this->sinks.waitForDispatches(generation);
 }
 
 void BusImpl::addConnection(BusConnectionPtr connection) {
     RSCDEBUG(logger, "Adding connection " << connection);
 
-    boost::recursive_mutex::scoped_lock lock(this->connectionLock);
+    {
+        boost::recursive_mutex::scoped_lock lock(this->connectionLock);
+
+        this->connections.push_back(connection);
+    }
+
+    {
+        boost::recursive_mutex::scoped_lock lock(this->connectorLock);
 
-    this->connections.push_back(connection);
+        announceSubscriptions();
+    }
 }
 
 void BusImpl::removeConnection(BusConnectionPtr connection) {
@@ -121,32 +149,57 @@ void BusImpl::removeConnection(BusConnectionPtr connection) {
     this->connections.remove(connection);
 }
 
+void BusImpl::announceSubscriptions() {
+    // The connector lock is held by the caller. Locks are always
+    // acquired in the order connector lock, connection lock.
+    boost::recursive_mutex::scoped_lock lock(this->connectionLock);
+
+    if (this->connections.empty()) {
+        return;
+    }
+
+    set<Scope> scopes = this->sinks.get()->getScopes();
+    RSCDEBUG(logger, "Announcing subscriptions " << scopes);
+
+    FramePtr frame = subscriptionsToFrame(this->id,
+                                          this->announcementSequenceNumber++,
+                                          scopes);
+    for (ConnectionList::iterator it = this->connections.begin();
+         it != this->connections.end(); ++it) {
+        (*it)->sendSubscriptions(frame);
+    }
+}
+
 // Cannot be a local struct in the handle() method since some
 // compilers (or standard versions?) don't support that.
 namespace {
 
 struct PoorPersonsLambda1 {
-    EventPtr event;
-    PoorPersonsLambda1(EventPtr event) : event(event) {}
+    OutgoingEvent* event;
+    PoorPersonsLambda1(OutgoingEvent& event) : event(&event) {}
     void operator()(InConnector& sink) {
-        sink.handle(this->event);
+        sink.handleLocal(*this->event);
     }
 };
 
 }
 
 void BusImpl::handle(EventPtr event) {
+    OutgoingEvent outgoing(event);
+    handleOutgoing(outgoing);
+}
+
+void BusImpl::handleOutgoing(OutgoingEvent& outgoing) {
+    EventPtr event = outgoing.getEvent();
+
     // Dispatch to our own connectors.
     RSCDEBUG(logger, "Delivering outgoing event to connectors " << event);
 
-    vector<Scope> scopes = event->getScopePtr()->superScopes(true);
-    RSCDEBUG(logger, "Relevant scopes " << scopes);
-
+    // The snapshot of sinks is used without holding a lock, allowing
+    // concurrent dispatching and modification of the sinks.
     {
-        boost::recursive_mutex::scoped_lock lock(this->connectorLock);
-
-        this->sinkDispatcher.mapSinks(event->getScope(),
-                                      PoorPersonsLambda1(event));
+        SinkSnapshots::Dispatch sinks(this->sinks);
+        sinks->mapSinks(*event->getScopePtr(), PoorPersonsLambda1(outgoing));
     }
 
     // Dispatch to outgoing connections.
@@ -155,13 +208,22 @@ void BusImpl::handle(EventPtr event) {
 
         RSCDEBUG(logger, "Dispatching outgoing event " << event << " to connections");
 
-        string wireSchema = event->getMetaData().getUserInfo("rsb.wire-schema");
+        // The event is serialized at most once, when the first
+        // connection requires it. The resulting frame and its
+        // compressed variant are shared by all connections.
+        // Serialization errors are reported to the caller instead of
+        // being treated as send failures.
+
         list<BusConnectionPtr> failing;
         for (list<BusConnectionPtr>::iterator it = this->connections.begin();
              it != this->connections.end(); ++it) {
+            if (!(*it)->isInterestedIn(event->getScope())) {
+                continue;
+            }
             RSCDEBUG(logger, "Dispatching to connection " << *it);
+            FrameVariants& frames = outgoing.getFrames();
             try {
-                (*it)->sendEvent(event, wireSchema);
+                (*it)->sendFrame(frames);
             } catch (const std::exception& e) {
                 RSCWARN(logger, "Send failure (" << e.what() << "); will close connection later");
                 // We record failing connections instead of closing them
@@ -183,33 +245,30 @@ void BusImpl::handle(EventPtr event) {
 namespace {
 
 struct PoorPersonsLambda2 {
-    EventPtr event;
-    PoorPersonsLambda2(EventPtr event) : event(event) {};
+    ReceivedFrame* frame;
+    PoorPersonsLambda2(ReceivedFrame& frame) : frame(&frame) {};
     void operator()(InConnector& sink) {
-        sink.handle(this->event);
+        // The event is only constructed and the payload only
+        // deserialized if there is at least one interested
+        // sink. Sinks with identical converters share the
+        // deserialized payload.
+        sink.handleReceived(*this->frame);
     }
 };
 
 }
 
-void BusImpl::handleIncoming(EventPtr         event,
+void BusImpl::handleIncoming(ReceivedFrame&   frame,
                              BusConnectionPtr /*connection*/) {
-    RSCDEBUG(logger, "Delivering received event to connectors " << event);
+    RSCDEBUG(logger, "Delivering received frame to connectors");
 
-    vector<Scope> scopes = event->getScopePtr()->superScopes(true);
-    RSCDEBUG(logger, "Relevant scopes " << scopes);
-
-    {
-        boost::recursive_mutex::scoped_lock lock(this->connectorLock);
-
-        this->sinkDispatcher.mapSinks(event->getScope(),
-                                      PoorPersonsLambda2(event));
-    }
+    SinkSnapshots::Dispatch sinks(this->sinks);
+    sinks->mapSinks(frame.getScope(), PoorPersonsLambda2(frame));
 }
 
 void BusImpl::printContents(ostream& stream) const {
     stream << "connections = " << this->connections
-           << ", sinks = " << this->sinkDispatcher.size();
+           << ", sinks = " << this->sinks.get()->size();
 }
 
 const std::string BusImpl::getTransportURL() const {
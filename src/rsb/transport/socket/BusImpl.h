@@ -30,14 +30,18 @@
 #include <list>
 
 #include <boost/shared_ptr.hpp>
+#include <boost/cstdint.hpp>
 
+#include <boost/thread/mutex.hpp>
 #include <boost/thread/recursive_mutex.hpp>
 
 #include <rsc/logging/Logger.h>
+#include <rsc/misc/UUID.h>
 
 #include "../../Event.h"
 #include "../../Scope.h"
 
+#include "../../eventprocessing/DispatcherSnapshots.h"
 #include "../../eventprocessing/Handler.h"
 #include "../../eventprocessing/ScopeDispatcher.h"
 
@@ -64,7 +68,7 @@ class RSB_EXPORT BusImpl: public virtual Bus {
 friend class BusConnection;
 public:
     BusImpl(AsioServiceContextPtr asioService,
-            bool                  tcpnodelay = false);
+            const BusOptions&     options = BusOptions());
     virtual ~BusImpl();
 
     virtual void addSink(InConnectorPtr sink);
@@ -87,11 +91,13 @@ public:
      */
     virtual void removeConnection(BusConnectionPtr connection);
 
-    virtual bool isTcpnodelay() const;
+    virtual const BusOptions& getOptions() const;
 
     virtual void handle(EventPtr event);
 
-    virtual void handleIncoming(EventPtr         event,
+    virtual void handleOutgoing(OutgoingEvent& event);
+
+    virtual void handleIncoming(ReceivedFrame&   frame,
                                 BusConnectionPtr connection);
 
     virtual void printContents(std::ostream& stream) const;
@@ -105,8 +111,18 @@ protected:
     boost::recursive_mutex& getConnectionLock();
 
     virtual AsioServiceContextPtr getService() const;
+
+    /**
+     * Announces the scopes of all local sinks to the remote peers of
+     * this bus, allowing the bus server to only send events on
+     * relevant scopes.
+     *
+     * Must be called while holding the connector lock.
+     */
+    virtual void announceSubscriptions();
 private:
-    typedef eventprocessing::WeakScopeDispatcher<InConnector> SinkDispatcher;
+    typedef eventprocessing::WeakScopeDispatcher<InConnector>    SinkDispatcher;
+    typedef eventprocessing::DispatcherSnapshots<SinkDispatcher> SinkSnapshots;
 
     rsc::logging::LoggerPtr  logger;
 
@@ -117,11 +133,16 @@ private:
     ConnectionList           connections;
     boost::recursive_mutex   connectionLock;
 
-    SinkDispatcher           sinkDispatcher;
+    // Immutable snapshots of the registered sinks. Dispatching events
+    // only requires a copy of the current snapshot. Modifications
+    // replace the snapshot while holding connectorLock.
+    SinkSnapshots            sinks;
     boost::recursive_mutex   connectorLock;
 
-    bool                     tcpnodelay;
+    BusOptions               options;
 
+    rsc::misc::UUID          id;
+    boost::uint32_t          announcementSequenceNumber;
 };
 
 }
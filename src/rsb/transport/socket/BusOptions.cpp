@@ -0,0 +1,66 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#include "BusOptions.h"
+
+using namespace std;
+
+using namespace rsc::runtime;
+
+namespace rsb {
+namespace transport {
+namespace socket {
+
+BusOptions::BusOptions() :
+    server(SERVER_AUTO), host(DEFAULT_HOST), port(DEFAULT_PORT), path(""),
+    threads(1), waitForClientDisconnects(true), tcpnodelay(true),
+    flushDelay(0), headerDictionary(false), compression(CODEC_NONE),
+    compressionThreshold(1024), maxQueuedBytes(64 * 1024 * 1024) {
+}
+
+BusOptions busOptionsFromProperties(const Properties& properties) {
+    const BusOptions defaults;
+    BusOptions options;
+    options.server                   = properties.getAs<Server>      ("server",           defaults.server);
+    options.host                     = properties.get<string>        ("host",             defaults.host);
+    options.port                     = properties.getAs<unsigned int>("port",             defaults.port);
+    options.path                     = properties.get<string>        ("path",             defaults.path);
+    options.threads                  = properties.getAs<unsigned int>("threads",          defaults.threads);
+    options.waitForClientDisconnects = properties.getAs<bool>        ("wait",             defaults.waitForClientDisconnects);
+    options.tcpnodelay               = properties.getAs<bool>        ("tcpnodelay",       defaults.tcpnodelay);
+    options.flushDelay               = properties.getAs<unsigned int>("flushdelay",       defaults.flushDelay);
+    options.headerDictionary         = properties.getAs<bool>        ("headerdictionary", defaults.headerDictionary);
+    options.compression              = parseCodec(properties.get<string>("compression",
+                                                                         codecName(defaults.compression)));
+    options.compressionThreshold     = properties.getAs<unsigned int>("compressionthreshold",
+                                                                      defaults.compressionThreshold);
+    options.maxQueuedBytes           = properties.getAs<unsigned int>("maxqueuedbytes",   defaults.maxQueuedBytes);
+    return options;
+}
+
+}
+}
+}
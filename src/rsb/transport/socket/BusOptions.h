@@ -0,0 +1,155 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#pragma once
+
+#include <string>
+
+#include <boost/cstdint.hpp>
+
+#include <rsc/runtime/Properties.h>
+
+#include "Compression.h"
+#include "Types.h"
+
+#include "rsb/rsbexports.h"
+
+namespace rsb {
+namespace transport {
+namespace socket {
+
+/**
+ * Options controlling how socket connectors access a bus and how
+ * connections of newly created buses behave.
+ *
+ * The default values are the defaults of the corresponding connector
+ * properties (see @ref busOptionsFromProperties).
+ *
+ * @author jmoringe
+ */
+struct RSB_EXPORT BusOptions {
+    BusOptions();
+
+    /**
+     * Controls whether a listening socket should be created and
+     * connections waited for (value SERVER_YES), an existing
+     * listening socket should be connected to (value SERVER_NO) or
+     * a listening socket should be created only if there is none
+     * already (value SERVER_AUTO).
+     */
+    Server          server;
+
+    /**
+     * The host of the TCP socket through which the bus is accessed.
+     */
+    std::string     host;
+
+    /**
+     * The port of the TCP socket through which the bus is accessed.
+     */
+    boost::uint16_t port;
+
+    /**
+     * If not empty, the path of a local (AF_UNIX) socket which is
+     * used instead of a TCP socket for @ref host and @ref
+     * port. Paths starting with "@" designate sockets in the
+     * abstract namespace.
+     */
+    std::string     path;
+
+    /**
+     * Minimum number of threads which should process socket
+     * operations and received notifications in this process.
+     */
+    unsigned int    threads;
+
+    /**
+     * If true, delay shutdown of the server socket until all clients
+     * have disconnected.
+     */
+    bool            waitForClientDisconnects;
+
+    /**
+     * Controls whether the TCP_NODELAY socket option is set for TCP
+     * connections. Setting this option trades decreased latency for
+     * decreased throughput.
+     */
+    bool            tcpnodelay;
+
+    /**
+     * Time in microseconds for which outgoing notifications are held
+     * back so that multiple notifications can be written in one
+     * operation. Trades increased latency for increased throughput.
+     */
+    unsigned int    flushDelay;
+
+    /**
+     * Controls whether connections negotiate with their peers to
+     * replace recurring notification headers by small
+     * per-connection ids.
+     */
+    bool            headerDictionary;
+
+    /**
+     * The codec with which payloads are compressed for peers which
+     * can decompress them.
+     */
+    Codec           compression;
+
+    /**
+     * Payloads smaller than this number of bytes are not compressed.
+     */
+    unsigned int    compressionThreshold;
+
+    /**
+     * Maximum number of bytes of outgoing notifications a connection
+     * queues for its peer. A connection whose peer does not read
+     * fast enough to stay below this limit is closed. A single
+     * notification is always queued if the queue is empty. @c 0
+     * means no limit.
+     */
+    unsigned int    maxQueuedBytes;
+};
+
+/**
+ * Builds bus options from the connector properties @a properties.
+ *
+ * Recognized properties are "server", "host", "port", "path",
+ * "threads", "wait", "tcpnodelay", "flushdelay", "headerdictionary",
+ * "compression", "compressionthreshold" and "maxqueuedbytes". Missing properties
+ * default to the values of a default-constructed @ref BusOptions
+ * object.
+ *
+ * @param properties The properties with which a connector is
+ *                   created.
+ * @return The bus options.
+ * @throw std::invalid_argument If a property value is invalid.
+ */
+RSB_EXPORT BusOptions busOptionsFromProperties(const rsc::runtime::Properties& properties);
+
+}
+}
+}
@@ -57,7 +57,7 @@ public:
 
     virtual void deactivate() = 0;
 
-    virtual void handleIncoming(EventPtr         event,
+    virtual void handleIncoming(ReceivedFrame&   frame,
                                 BusConnectionPtr connection) = 0;
 };
 
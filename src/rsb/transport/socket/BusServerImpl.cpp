@@ -28,17 +28,19 @@
 
 #include <list>
 
+#include <cstdio>
+
 #include <boost/bind.hpp>
 
 #include <boost/thread/thread_time.hpp>
 
 #include "../../MetaData.h"
 #include "Factory.h"
+#include "ReceivedFrame.h"
 
 using namespace std;
 
 using namespace boost::asio;
-using boost::asio::ip::tcp;
 
 using namespace rsc::logging;
 
@@ -46,15 +48,51 @@ namespace rsb {
 namespace transport {
 namespace socket {
 
+namespace {
+
+/**
+ * Removes the socket file of the local endpoint @a endpoint if no
+ * server accepts connections on it. Such files remain when a server
+ * process terminates without destroying its @ref BusServerImpl and
+ * would otherwise prevent binding @a endpoint.
+ *
+ * @return @a endpoint.
+ */
+const SocketEndpoint& removeStaleSocketFile(io_service&           service,
+                                            const SocketEndpoint& endpoint,
+                                            LoggerPtr             logger) {
+    if (!isLocalEndpoint(endpoint)) {
+        return endpoint;
+    }
+    string path = localEndpointPath(endpoint);
+    if (path.empty() || (path[0] == '@')) {
+        return endpoint;
+    }
+
+    // A socket file of a running server accepts the connection. In
+    // that case, binding fails as it should.
+    generic::stream_protocol::socket probe(service);
+    boost::system::error_code error;
+    probe.connect(endpoint, error);
+    if (error == boost::asio::error::connection_refused) {
+        RSCINFO(logger, "Removing stale socket file " << path);
+        std::remove(path.c_str());
+    }
+    return endpoint;
+}
+
+}
+
 BusServerImpl::BusServerImpl(AsioServiceContextPtr asioService,
-                             boost::uint16_t       port,
-                             bool                  tcpnodelay,
-                             bool                  waitForClientDisconnects)
-    : BusImpl(asioService, tcpnodelay),
+                             const SocketEndpoint& endpoint,
+                             const BusOptions&     options)
+    : BusImpl(asioService, options),
       logger(Logger::getLogger("rsb.transport.socket.BusServerImpl")),
-      acceptor(*this->getService()->getService(), tcp::endpoint(tcp::v4(), port)),
+      acceptor(*this->getService()->getService(),
+               removeStaleSocketFile(*this->getService()->getService(),
+                                     endpoint, this->logger)),
       active(false), shutdown(false),
-      waitForClientDisconnects(waitForClientDisconnects) {
+      waitForClientDisconnects(options.waitForClientDisconnects) {
 }
 
 
@@ -63,6 +101,21 @@ BusServerImpl::~BusServerImpl() {
     if (this->active) {
         deactivate();
     }
+
+    // Remove the socket file of a local endpoint, if any. Names in the
+    // abstract namespace do not have a file.
+    try {
+        SocketEndpoint endpoint = this->acceptor.local_endpoint();
+        if (isLocalEndpoint(endpoint)) {
+            string path = localEndpointPath(endpoint);
+            if (!path.empty() && (path[0] != '@')) {
+                RSCDEBUG(logger, "Removing socket file " << path);
+                std::remove(path.c_str());
+            }
+        }
+    } catch (const std::exception& e) {
+        RSCDEBUG(logger, "Failed to remove socket file: " << e.what());
+    }
 }
 
 void BusServerImpl::activate() {
@@ -108,9 +161,9 @@ void BusServerImpl::removeConnection(BusConnectionPtr connection) {
 }
 
 void BusServerImpl::acceptOne(boost::shared_ptr<BusServerImpl> ref) {
-    SocketPtr socket(new tcp::socket(*this->getService()->getService()));
+    SocketPtr socket(new generic::stream_protocol::socket(*this->getService()->getService()));
 
-    RSCINFO(logger, "Listening on " << this->acceptor.local_endpoint());
+    RSCINFO(logger, "Listening on " << endpointToURL(this->acceptor.local_endpoint()));
     acceptor.async_accept(*socket,
                           boost::bind(&BusServerImpl::handleAccept, this, ref, socket,
                                       boost::asio::placeholders::error));
@@ -120,9 +173,10 @@ void BusServerImpl::handleAccept(boost::shared_ptr<BusServerImpl> ref,
                                  SocketPtr                        socket,
                                  const boost::system::error_code& error) {
     if (!error) {
-        RSCINFO(logger, "Got connection from " << socket->remote_endpoint());
+        RSCINFO(logger, "Got connection from " << endpointToURL(socket->remote_endpoint()));
 
-        BusConnectionPtr connection(new BusConnection(ref, socket, false, isTcpnodelay()));
+        BusConnectionPtr connection(new BusConnection(ref, socket, *getService()->getService(),
+                                                      false, getOptions()));
         addConnection(connection);
         connection->startReceiving();
     } else if (!this->shutdown){
@@ -141,11 +195,15 @@ void BusServerImpl::handleAccept(boost::shared_ptr<BusServerImpl> ref,
     }
 }
 
-void BusServerImpl::handleIncoming(EventPtr         event,
+void BusServerImpl::handleIncoming(ReceivedFrame&   frame,
                                    BusConnectionPtr connection) {
-    BusImpl::handleIncoming(event, connection);
+    BusImpl::handleIncoming(frame, connection);
 
-    RSCDEBUG(logger, "Delivering received event to connections " << event);
+    // Relay the received frame verbatim. This avoids decoding and
+    // re-encoding the notification for other connections. Only the
+    // payload is compressed or decompressed, at most once, depending
+    // on the codecs supported by the receiving peers.
+    RSCDEBUG(logger, "Relaying received frame to connections");
     {
         boost::recursive_mutex::scoped_lock lock(getConnectionLock());
 
@@ -153,10 +211,10 @@ void BusServerImpl::handleIncoming(EventPtr         event,
         list<BusConnectionPtr> failing;
         for (ConnectionList::iterator it = connections.begin();
              it != connections.end(); ++it) {
-            if (*it != connection) {
+            if ((*it != connection) && (*it)->isInterestedIn(frame.getScope())) {
                 RSCDEBUG(logger, "Delivering to connection " << *it);
                 try {
-                    (*it)->sendEvent(event, event->getMetaData().getUserInfo("rsb.wire-schema"));
+                    (*it)->sendFrame(frame.getFrames());
                 } catch (const std::exception& e) {
                     RSCWARN(logger, "Send failure (" << e.what() << "); will close connection later");
                     // We record failing connections instead of
@@ -176,10 +234,13 @@ void BusServerImpl::handleIncoming(EventPtr         event,
     }
 }
 
+void BusServerImpl::announceSubscriptions() {
+    // The bus server receives all events from its clients and
+    // therefore does not announce the scopes of its local sinks.
+}
+
 const std::string BusServerImpl::getTransportURL() const {
-    return boost::str(boost::format("socket://%1%:%2%")
-                      % this->acceptor.local_endpoint().address().to_string()
-                      % this->acceptor.local_endpoint().port());
+    return endpointToURL(this->acceptor.local_endpoint());
 }
 
 
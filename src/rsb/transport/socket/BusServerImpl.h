@@ -31,13 +31,14 @@
 #include <boost/shared_ptr.hpp>
 
 #include <boost/asio.hpp>
-#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/generic/stream_protocol.hpp>
 #include <boost/thread/condition_variable.hpp>
 
 #include <rsc/logging/Logger.h>
 
 #include "BusImpl.h"
 #include "BusServer.h"
+#include "Types.h"
 
 #include "rsb/rsbexports.h"
 
@@ -62,10 +63,23 @@ class RSB_EXPORT BusServerImpl : public virtual BusImpl,
                                  public virtual BusServer,
                                  public boost::enable_shared_from_this<BusServerImpl> {
 public:
+    /**
+     * Creates a bus server which accepts client connections on @a
+     * endpoint.
+     *
+     * @param asioService The service executing socket operations.
+     * @param endpoint A TCP endpoint or a local endpoint (see @ref
+     *                 localEndpoint). A socket file created for a
+     *                 local endpoint is removed upon destruction. An
+     *                 existing socket file on which no server accepts
+     *                 connections is removed before binding.
+     * @param options Options of client connections. If @c
+     *                waitForClientDisconnects is true, shutdown is
+     *                delayed until all clients have disconnected.
+     */
     BusServerImpl(AsioServiceContextPtr    asioService,
-                  boost::uint16_t          port,
-                  bool                     tcpnodelay,
-                  bool                     waitForClientDisconnects);
+                  const SocketEndpoint&    endpoint,
+                  const BusOptions&        options);
 
     virtual ~BusServerImpl();
 
@@ -81,17 +95,19 @@ public:
 
     virtual void removeConnection(BusConnectionPtr connection);
 
-    void handleIncoming(EventPtr         event,
+    void handleIncoming(ReceivedFrame&   frame,
                         BusConnectionPtr connection);
 
     virtual const std::string getTransportURL() const;
 protected:
-    typedef boost::shared_ptr<boost::asio::ip::tcp::socket> SocketPtr;
+    typedef boost::shared_ptr<boost::asio::generic::stream_protocol::socket> SocketPtr;
+
+    virtual void announceSubscriptions();
 private:
 
     rsc::logging::LoggerPtr         logger;
 
-    boost::asio::ip::tcp::acceptor  acceptor;
+    boost::asio::basic_socket_acceptor<boost::asio::generic::stream_protocol> acceptor;
 
     volatile bool                   active;
     volatile bool                   shutdown;
@@ -0,0 +1,392 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#include "Compression.h"
+
+#include <stdexcept>
+
+#include <boost/format.hpp>
+
+#ifdef RSB_WITH_LZ4
+#include <lz4.h>
+#endif
+#ifdef RSB_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+#include "../../protocol/ProtocolException.h"
+
+#include "WireFormat.h"
+
+using namespace std;
+
+using namespace boost;
+
+namespace rsb {
+namespace transport {
+namespace socket {
+
+namespace {
+
+// Field number of the payload in rsb/protocol/Notification.proto.
+const unsigned int NOTIFICATION_DATA = 9;
+
+// Favor speed over compression ratio.
+const int ZSTD_LEVEL = 1;
+
+/**
+ * Locates the payload field in the body of @a frame. Returns false if
+ * the frame does not contain exactly one payload field.
+ */
+bool findData(const string& frame,
+              const char*&  fieldStart,
+              const char*&  fieldEnd,
+              const char*&  data,
+              size_t&       length) {
+    fieldStart = 0;
+    WireReader reader(frame.data() + 4, frame.data() + frame.size());
+    while (!reader.atEnd()) {
+        const char* start = reader.getPosition();
+        unsigned int number, type;
+        const char* value = 0;
+        boost::uint64_t valueLength = 0;
+        if (!reader.field(number, type, value, valueLength)) {
+            return false;
+        }
+        if ((number == NOTIFICATION_DATA)
+            && (type == WIRETYPE_LENGTH_DELIMITED)) {
+            if (fieldStart) {
+                return false;
+            }
+            fieldStart = start;
+            fieldEnd   = reader.getPosition();
+            data       = value;
+            length     = valueLength;
+        }
+    }
+    return fieldStart != 0;
+}
+
+/**
+ * Returns a copy of @a frame in which the payload field between @a
+ * fieldStart and @a fieldEnd is replaced by @a data and the flag bits
+ * of the length header are replaced by @a flags.
+ *
+ * @throw std::invalid_argument If the resulting frame would exceed
+ *                              the maximum frame size.
+ */
+FramePtr replaceData(const string&   frame,
+                     const char*     fieldStart,
+                     const char*     fieldEnd,
+                     const string&   data,
+                     boost::uint32_t flags) {
+    const size_t prefix = fieldStart - (frame.data() + 4);
+    const size_t suffix = (frame.data() + frame.size()) - fieldEnd;
+    const size_t size
+        = (prefix
+           + varintSize((NOTIFICATION_DATA << 3) | WIRETYPE_LENGTH_DELIMITED)
+           + varintSize(data.size()) + data.size()
+           + suffix);
+    checkFrameSize(size);
+
+    boost::shared_ptr<string> result(new string());
+    result->reserve(4 + size);
+    appendLengthHeader(*result, size | flags);
+    result->append(frame.data() + 4, prefix);
+    appendBytesField(*result, NOTIFICATION_DATA, data.data(), data.size());
+    result->append(fieldEnd, suffix);
+    return result;
+}
+
+/**
+ * Compresses @a length bytes at @a data into @a result, prefixed
+ * with the codec and the uncompressed size.
+ */
+void compressPayload(Codec       codec,
+                     const char* data,
+                     size_t      length,
+                     string&     result) {
+    result.clear();
+    result.push_back(static_cast<char>(codec));
+    appendVarint(result, length);
+    const size_t offset = result.size();
+
+    switch (codec) {
+#ifdef RSB_WITH_LZ4
+    case CODEC_LZ4: {
+        result.resize(offset + LZ4_compressBound(length));
+        const int compressed
+            = LZ4_compress_default(data, &result[offset], length,
+                                   result.size() - offset);
+        if (compressed <= 0) {
+            throw runtime_error("LZ4 compression failed");
+        }
+        result.resize(offset + compressed);
+        break;
+    }
+#endif
+#ifdef RSB_WITH_ZSTD
+    case CODEC_ZSTD: {
+        result.resize(offset + ZSTD_compressBound(length));
+        const size_t compressed
+            = ZSTD_compress(&result[offset], result.size() - offset,
+                            data, length, ZSTD_LEVEL);
+        if (ZSTD_isError(compressed)) {
+            throw runtime_error(str(format("zstd compression failed: %1%")
+                                    % ZSTD_getErrorName(compressed)));
+        }
+        result.resize(offset + compressed);
+        break;
+    }
+#endif
+    default:
+        throw invalid_argument(str(format("Codec %1% is not available")
+                                   % codec));
+    }
+}
+
+}
+
+Codec parseCodec(const string& name) {
+    Codec codec;
+    if (name == "none") {
+        return CODEC_NONE;
+    } else if (name == "lz4") {
+        codec = CODEC_LZ4;
+    } else if (name == "zstd") {
+        codec = CODEC_ZSTD;
+    } else {
+        throw invalid_argument(str(format("Invalid compression codec name \"%1%\";"
+                                          " valid names are \"none\", \"lz4\" and \"zstd\"")
+                                   % name));
+    }
+    if (!availableCodecs().count(codec)) {
+        throw invalid_argument(str(format("Compression codec \"%1%\" is not"
+                                          " available in this build")
+                                   % name));
+    }
+    return codec;
+}
+
+string codecName(Codec codec) {
+    switch (codec) {
+    case CODEC_NONE:
+        return "none";
+    case CODEC_LZ4:
+        return "lz4";
+    case CODEC_ZSTD:
+        return "zstd";
+    default:
+        throw invalid_argument(str(format("Invalid codec %1%") % codec));
+    }
+}
+
+CodecSet availableCodecs() {
+    CodecSet result;
+#ifdef RSB_WITH_LZ4
+    result.insert(CODEC_LZ4);
+#endif
+#ifdef RSB_WITH_ZSTD
+    result.insert(CODEC_ZSTD);
+#endif
+    return result;
+}
+
+set<string> codecNames(const CodecSet& codecs) {
+    set<string> result;
+    for (CodecSet::const_iterator it = codecs.begin(); it != codecs.end(); ++it) {
+        result.insert(codecName(*it));
+    }
+    return result;
+}
+
+CodecSet parseCodecs(const set<string>& names) {
+    const CodecSet available = availableCodecs();
+    CodecSet result;
+    for (set<string>::const_iterator it = names.begin(); it != names.end(); ++it) {
+        for (CodecSet::const_iterator codec = available.begin();
+             codec != available.end(); ++codec) {
+            if (*it == codecName(*codec)) {
+                result.insert(*codec);
+            }
+        }
+    }
+    return result;
+}
+
+bool isCompressedFrame(const string& frame) {
+    return (frame.size() >= 4)
+        && (readLengthHeader(frame) & COMPRESSION_FLAG);
+}
+
+Codec frameCodec(const string& frame) {
+    if (!isCompressedFrame(frame)) {
+        return CODEC_NONE;
+    }
+    const char* fieldStart;
+    const char* fieldEnd;
+    const char* data;
+    size_t length;
+    if (!findData(frame, fieldStart, fieldEnd, data, length) || (length == 0)) {
+        throw protocol::ProtocolException("Compressed frame without payload");
+    }
+    return static_cast<Codec>(static_cast<unsigned char>(data[0]));
+}
+
+FramePtr compressFrame(FramePtr frame, Codec codec, size_t threshold) {
+    if ((codec == CODEC_NONE) || isCompressedFrame(*frame)) {
+        return frame;
+    }
+
+    const char* fieldStart;
+    const char* fieldEnd;
+    const char* data;
+    size_t length;
+    if (!findData(*frame, fieldStart, fieldEnd, data, length)
+        || (length < threshold)) {
+        return frame;
+    }
+
+    string compressed;
+    compressPayload(codec, data, length, compressed);
+    if (compressed.size() >= length) {
+        return frame;
+    }
+
+    const boost::uint32_t flags = readLengthHeader(*frame) & ~FRAME_LENGTH_MASK;
+    return replaceData(*frame, fieldStart, fieldEnd, compressed,
+                       flags | COMPRESSION_FLAG);
+}
+
+FramePtr decompressFrame(FramePtr frame) {
+    if (!isCompressedFrame(*frame)) {
+        return frame;
+    }
+
+    const char* fieldStart;
+    const char* fieldEnd;
+    const char* data;
+    size_t length;
+    if (!findData(*frame, fieldStart, fieldEnd, data, length)) {
+        throw protocol::ProtocolException("Compressed frame without payload");
+    }
+
+    string decompressed;
+    decompressPayload(data, length, decompressed);
+
+    const boost::uint32_t flags
+        = readLengthHeader(*frame) & ~FRAME_LENGTH_MASK & ~COMPRESSION_FLAG;
+    return replaceData(*frame, fieldStart, fieldEnd, decompressed, flags);
+}
+
+void decompressPayload(const char* data, size_t length, string& result) {
+    WireReader reader(data, data + length);
+    const char* codecByte;
+    boost::uint64_t size;
+    if (!reader.bytes(1, codecByte) || !reader.varint(size)
+        || (size > FRAME_LENGTH_MASK)) {
+        throw protocol::ProtocolException("Malformed compressed payload");
+    }
+    const Codec codec = static_cast<Codec>(static_cast<unsigned char>(*codecByte));
+    const char* compressed = reader.getPosition();
+    const size_t compressedLength = data + length - compressed;
+
+    result.resize(size);
+    switch (codec) {
+#ifdef RSB_WITH_LZ4
+    case CODEC_LZ4:
+        if (LZ4_decompress_safe(compressed, size ? &result[0] : 0,
+                                compressedLength, size) != (int) size) {
+            throw protocol::ProtocolException("Malformed LZ4 payload");
+        }
+        break;
+#endif
+#ifdef RSB_WITH_ZSTD
+    case CODEC_ZSTD:
+        if (ZSTD_decompress(size ? &result[0] : 0, size,
+                            compressed, compressedLength) != size) {
+            throw protocol::ProtocolException("Malformed zstd payload");
+        }
+        break;
+#endif
+    default:
+        throw protocol::ProtocolException(str(format("Unsupported compression codec %1%")
+                                              % codec));
+    }
+}
+
+FrameVariants::FrameVariants(FramePtr frame) :
+    frame(frame), isCompressed(isCompressedFrame(*frame)), codec(CODEC_NONE),
+    decompressionFailed(false) {
+    // Malformed compressed frames, for example received from a
+    // faulty peer, are only relayed to peers which can decompress
+    // them since they cannot be decompressed for other peers.
+    try {
+        this->codec = socket::frameCodec(*frame);
+    } catch (const protocol::ProtocolException&) {
+        this->decompressionFailed = true;
+    }
+}
+
+FramePtr FrameVariants::getFrame(Codec           codec,
+                                 size_t          threshold,
+                                 const CodecSet& peerCodecs) {
+    // Compress uncompressed frames if the peer can decompress them.
+    if (!this->isCompressed) {
+        if ((codec == CODEC_NONE) || !peerCodecs.count(codec)) {
+            return this->frame;
+        }
+        if (!this->compressed) {
+            // Compression is optional. If the codec fails, the frame
+            // is sent uncompressed instead of failing the send
+            // operation, which would close the connection.
+            try {
+                this->compressed = compressFrame(this->frame, codec, threshold);
+            } catch (const std::exception&) {
+                this->compressed = this->frame;
+            }
+        }
+        return this->compressed;
+    }
+
+    // Decompress compressed frames if the peer cannot decompress
+    // them.
+    if ((this->codec != CODEC_NONE) && peerCodecs.count(this->codec)) {
+        return this->frame;
+    }
+    if (!this->decompressed && !this->decompressionFailed) {
+        try {
+            this->decompressed = decompressFrame(this->frame);
+        } catch (const std::exception&) {
+            this->decompressionFailed = true;
+        }
+    }
+    return this->decompressed;
+}
+
+}
+}
+}
@@ -0,0 +1,190 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#pragma once
+
+#include <string>
+#include <set>
+
+#include <boost/cstdint.hpp>
+
+#include "Serialization.h"
+
+#include "rsb/rsbexports.h"
+
+namespace rsb {
+namespace transport {
+namespace socket {
+
+/**
+ * Bit of the length header of a frame which indicates that the
+ * payload of the notification in the frame is compressed.
+ *
+ * The data field of such a notification contains a byte identifying
+ * the @ref Codec, the uncompressed size of the payload as a varint
+ * and the compressed payload.
+ */
+const boost::uint32_t COMPRESSION_FLAG = 0x40000000ul;
+
+/**
+ * Compression algorithms for payloads. Availability of the
+ * algorithms depends on the libraries present at build time (see
+ * @ref availableCodecs).
+ */
+enum Codec {
+    CODEC_NONE = 0,
+    CODEC_LZ4  = 1,
+    CODEC_ZSTD = 2
+};
+
+typedef std::set<Codec> CodecSet;
+
+/**
+ * Parses the codec name @a name.
+ *
+ * @param name One of "none", "lz4" and "zstd".
+ * @return The corresponding codec.
+ * @throw std::invalid_argument If @a name does not designate a codec
+ *                              or the codec is not available.
+ */
+RSB_EXPORT Codec parseCodec(const std::string& name);
+
+/**
+ * Returns the name of @a codec as accepted by @ref parseCodec.
+ */
+RSB_EXPORT std::string codecName(Codec codec);
+
+/**
+ * Returns the codecs, except @ref CODEC_NONE, which are available
+ * in this build.
+ */
+RSB_EXPORT CodecSet availableCodecs();
+
+/**
+ * Returns the names of the codecs in @a codecs.
+ */
+RSB_EXPORT std::set<std::string> codecNames(const CodecSet& codecs);
+
+/**
+ * Returns the available codecs among @a names. Other names are
+ * ignored.
+ */
+RSB_EXPORT CodecSet parseCodecs(const std::set<std::string>& names);
+
+/**
+ * Indicates whether the payload in @a frame is compressed.
+ */
+RSB_EXPORT bool isCompressedFrame(const std::string& frame);
+
+/**
+ * Returns the codec used for the payload in @a frame or @ref
+ * CODEC_NONE if the payload is not compressed.
+ *
+ * @throw protocol::ProtocolException If @a frame is malformed.
+ */
+RSB_EXPORT Codec frameCodec(const std::string& frame);
+
+/**
+ * Returns a frame which contains the notification of @a frame with
+ * the payload compressed using @a codec.
+ *
+ * @param frame An uncompressed frame.
+ * @param codec The codec that should be used.
+ * @param threshold Payloads smaller than this number of bytes are
+ *                  not compressed.
+ * @return The compressed frame or @a frame itself if the payload is
+ *         below @a threshold or does not become smaller.
+ */
+RSB_EXPORT FramePtr compressFrame(FramePtr    frame,
+                                  Codec       codec,
+                                  std::size_t threshold);
+
+/**
+ * Returns a frame which contains the notification of @a frame with
+ * the payload decompressed.
+ *
+ * @param frame A frame, which does not have to be compressed.
+ * @return The uncompressed frame or @a frame itself if it is not
+ *         compressed.
+ * @throw protocol::ProtocolException If @a frame is malformed.
+ */
+RSB_EXPORT FramePtr decompressFrame(FramePtr frame);
+
+/**
+ * Decompresses the payload of @a length bytes at @a data taken from a
+ * compressed frame into @a result.
+ *
+ * @throw protocol::ProtocolException If the payload is malformed or
+ *                                    uses an unavailable codec.
+ */
+RSB_EXPORT void decompressPayload(const char*  data,
+                                  std::size_t  length,
+                                  std::string& result);
+
+/**
+ * Instances of this class produce the variants of a frame required
+ * by the connections of a bus: the frame as it is, the frame with
+ * compressed payload and the frame with decompressed payload. Each
+ * variant is produced at most once and shared between all
+ * connections.
+ *
+ * Instances are not thread-safe.
+ *
+ * @author jmoringe
+ */
+class RSB_EXPORT FrameVariants {
+public:
+    explicit FrameVariants(FramePtr frame);
+
+    /**
+     * Returns the variant of the frame which should be sent to a
+     * peer.
+     *
+     * @param codec The codec which should be used for compressing
+     *              uncompressed frames.
+     * @param threshold Payloads smaller than this are not compressed.
+     * @param peerCodecs The codecs the peer can decompress.
+     * @return The selected variant. If compressing the frame fails,
+     *         the uncompressed frame is returned. If the frame is
+     *         compressed, the peer cannot decompress it and it cannot
+     *         be decompressed because it is malformed, an empty
+     *         pointer is returned.
+     */
+    FramePtr getFrame(Codec           codec,
+                      std::size_t     threshold,
+                      const CodecSet& peerCodecs);
+private:
+    FramePtr frame;
+    bool     isCompressed;
+    Codec    codec;
+    FramePtr compressed;
+    FramePtr decompressed;
+    bool     decompressionFailed;
+};
+
+}
+}
+}
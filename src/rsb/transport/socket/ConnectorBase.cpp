@@ -43,15 +43,10 @@ namespace socket {
 
 ConnectorBase::ConnectorBase(FactoryPtr                    factory,
                              ConverterSelectionStrategyPtr converters,
-                             const string&                 host,
-                             unsigned int                  port,
-                             Server                        server,
-                             bool                          tcpnodelay,
-                             bool                          waitForClientDisconnects) :
+                             const BusOptions&             options) :
     ConverterSelectingConnector<string>(converters),
     active(false), logger(Logger::getLogger("rsb.transport.socket.ConnectorBase")),
-    factory(factory), host(host), port(port), server(server),
-    tcpnodelay(tcpnodelay), waitForClientDisconnects(waitForClientDisconnects) {
+    factory(factory), options(options) {
 }
 
 ConnectorBase::~ConnectorBase() {
@@ -82,9 +77,8 @@ void ConnectorBase::activate() {
 
     // This connector is added to the connector list of the bus returned by
     // getBus
-    RSCINFO(logger, "Server mode: " << this->server);
-    this->bus = this->factory->getBus(this->server, this->host, this->port,
-            this->tcpnodelay, this->waitForClientDisconnects);
+    RSCINFO(logger, "Server mode: " << this->options.server);
+    this->bus = this->factory->getBus(this->options);
 
     this->active = true;
 
@@ -34,7 +34,7 @@
 
 #include "../ConverterSelectingConnector.h"
 
-#include "Types.h"
+#include "BusOptions.h"
 #include "Factory.h"
 
 #include "rsb/rsbexports.h"
@@ -59,38 +59,19 @@ typedef boost::shared_ptr<Bus> BusPtr;
 class RSB_EXPORT ConnectorBase: public ConverterSelectingConnector<std::string> {
 public:
     /**
-     * Creates a connector for the given combination of @a host, @a
-     * port and @a server.
+     * Creates a connector which accesses the bus described by @a
+     * options.
      *
+     * @param factory The factory which provides the bus.
      * @param converters A strategy for converter selection within the
      *                   newly created connector.
-     * @param host The host of the socket through which the newly
-     *             created connector will operate.
-     * @param port The port of the socket through which the newly
-     *             created connector will operate.
-     * @param server Controls whether the newly created connector
-     *               should create a listening socket and wait for
-     *               connections (value SERVER_YES), connect to an
-     *               existing listen socket (value SERVER_NO) or try
-     *               to automatically determine whether there already
-     *               is a listening socket and create one only if
-     *               necessary (value SERVER_AUTO).
-     * @param tcpnodelay Controls whether the TCP_NODELAY socket
-     *                   option should be set for the socket
-     *                   implementing the communication of the newly
-     *                   created connector. Setting this option trades
-     *                   decreased latency for decreased throughput.
-     * @param waitForClientDisconnects If true, delay shutdown of the server
-     *                                 socket until all clients have
-     *                                 disconnected.
+     * @param options Controls how the bus is accessed (host, port,
+     *                path and server mode) and, if the bus has to be
+     *                created, how its connections behave.
      */
     ConnectorBase(FactoryPtr                    factory,
                   ConverterSelectionStrategyPtr converters,
-                  const std::string&            host,
-                  unsigned int                  port,
-                  Server                        server,
-                  bool                          tcpnodelay,
-                  bool                          waitForClientDisconnects=true);
+                  const BusOptions&             options);
 
     virtual ~ConnectorBase();
 
@@ -122,11 +103,7 @@ private:
 
     FactoryPtr              factory;
 
-    std::string             host;
-    unsigned int            port;
-    Server                  server;
-    bool                    tcpnodelay;
-    bool                    waitForClientDisconnects;
+    BusOptions              options;
 };
 
 typedef boost::shared_ptr<ConnectorBase> ConnectorBasePtr;
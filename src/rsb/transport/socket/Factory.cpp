@@ -65,12 +65,13 @@ Factory::~Factory() {
 
 template<class BusType>
 boost::shared_ptr<BusType> Factory::searchInMap(const Endpoint& endpoint,
-        bool tcpnodelay, map<Endpoint, boost::weak_ptr<BusType> >& map) {
+        const BusOptions& options,
+        map<Endpoint, boost::weak_ptr<BusType> >& map) {
     typename std::map<Endpoint, boost::weak_ptr<BusType> >::const_iterator it;
     if ((it = map.find(endpoint)) != map.end()) {
         boost::shared_ptr<BusType> result = it->second.lock();
         if (result) {
-            checkOptions(result, tcpnodelay);
+            checkOptions(result, options);
             RSCDEBUG(logger,
                     "Found existing bus " << result
                             << " without resolving");
@@ -82,17 +83,20 @@ boost::shared_ptr<BusType> Factory::searchInMap(const Endpoint& endpoint,
     return boost::shared_ptr<BusType>();
 }
 
-BusPtr Factory::getBusClientFor(const string&  host,
-                                uint16_t       port,
-                                bool           tcpnodelay) {
-    RSCDEBUG(logger, "Was asked for a bus client for " << host << ":" << port);
+BusPtr Factory::getBusClientFor(const BusOptions& options) {
+    const string&  host = options.host;
+    const uint16_t port = options.port;
+    const string&  path = options.path;
+
+    RSCDEBUG(logger, "Was asked for a bus client for " << host << ":" << port
+             << (path.empty() ? "" : " via local socket " + path));
 
     // Try to find an entry for the exact specified endpoint. If this
     // yields a hit, there is no need to resolve the specified name.
-    Endpoint endpoint(host, port);
+    Endpoint endpoint = makeEndpoint(host, port, path);
 
     {
-        BusPtr result = searchInMap(endpoint, tcpnodelay, busClients);
+        BusPtr result = searchInMap(endpoint, options, busClients);
         if (result) {
             return result;
         }
@@ -100,56 +104,69 @@ BusPtr Factory::getBusClientFor(const string&  host,
         RSCDEBUG(logger, "Did not find bus client without resolving");
     }
 
-    // We did not find an entry for the exact specified entry. We try
-    // to resolve it to a working endpoint and use that one in the
-    // lookup.
-    // TODO(jmoringe): avoid this useless socket connection just for
-    // the lookup
-    RSCDEBUG(logger, "Resolving endpoint")
-    tcp::resolver resolver(*this->asioService->getService());
-    tcp::resolver::query query(host, lexical_cast<string>(port),
-                               tcp::resolver::query::numeric_service);
-    for (tcp::resolver::iterator endpointIterator = resolver.resolve(query);
-         endpointIterator != tcp::resolver::iterator();
-         ++endpointIterator) {
-        endpoint = Endpoint(endpointIterator->host_name(), port);
-        // When we have a working endpoint, repeat the lookup.
-        BusPtr result = searchInMap(endpoint, tcpnodelay, busClients);
-        if (result) {
-            return result;
-        }
-    }
-
-    // Try to open a socket for the resolved endpoint.
     SocketPtr socket;
-    for (tcp::resolver::iterator endpointIterator = resolver.resolve(query);
-         endpointIterator != tcp::resolver::iterator();
-         ++endpointIterator) {
-        endpoint = Endpoint(endpointIterator->host_name(), port);
-        RSCDEBUG(logger, "Trying endpoint " << endpointIterator->endpoint());
-        socket.reset(new tcp::socket(*this->asioService->getService()));
+    if (!path.empty()) {
+        // Local sockets do not require name resolution.
+        RSCDEBUG(logger, "Connecting to local socket " << path);
+        socket.reset(new generic::stream_protocol::socket(*this->asioService->getService()));
         boost::system::error_code error;
-        socket->connect(endpointIterator->endpoint(), error);
-        if (!error) {
-            RSCDEBUG(logger, "Success");
-            break;
+        socket->connect(localEndpoint(path), error);
+        if (error) {
+            throw runtime_error(str(format("Could not connect to local socket %1%: %2%")
+                                    % path % error.message()));
+        }
+    } else {
+        // We did not find an entry for the exact specified entry. We try
+        // to resolve it to a working endpoint and use that one in the
+        // lookup.
+        // TODO(jmoringe): avoid this useless socket connection just for
+        // the lookup
+        RSCDEBUG(logger, "Resolving endpoint")
+        tcp::resolver resolver(*this->asioService->getService());
+        tcp::resolver::query query(host, lexical_cast<string>(port),
+                                   tcp::resolver::query::numeric_service);
+        for (tcp::resolver::iterator endpointIterator = resolver.resolve(query);
+             endpointIterator != tcp::resolver::iterator();
+             ++endpointIterator) {
+            endpoint = Endpoint(endpointIterator->host_name(), port);
+            // When we have a working endpoint, repeat the lookup.
+            BusPtr result = searchInMap(endpoint, options, busClients);
+            if (result) {
+                return result;
+            }
+        }
+
+        // Try to open a socket for the resolved endpoint.
+        for (tcp::resolver::iterator endpointIterator = resolver.resolve(query);
+             endpointIterator != tcp::resolver::iterator();
+             ++endpointIterator) {
+            endpoint = Endpoint(endpointIterator->host_name(), port);
+            RSCDEBUG(logger, "Trying endpoint " << endpointIterator->endpoint());
+            socket.reset(new generic::stream_protocol::socket(*this->asioService->getService()));
+            boost::system::error_code error;
+            socket->connect(SocketEndpoint(endpointIterator->endpoint()), error);
+            if (!error) {
+                RSCDEBUG(logger, "Success");
+                break;
+            }
+            RSCDEBUG(logger, "Failed: " << error.message());
+            socket.reset();
+        }
+        if (!socket) {
+            throw runtime_error(str(format("Could not connect to any of the endpoints to which %1%:%2% resolved.")
+                                    % host % port));
         }
-        RSCDEBUG(logger, "Failed: " << error.message());
-        socket.reset();
-    }
-    if (!socket) {
-        throw runtime_error(str(format("Could not connect to any of the endpoints to which %1%:%2% resolved.")
-                                % host % port));
     }
 
     // Name resolution did not yield any endpoints, or none of the
     // worked. Create a new bus client.
     RSCDEBUG(logger, "Did not find bus client after resolving; creating a new one");
 
-    BusPtr result(new BusImpl(this->asioService, tcpnodelay));
+    BusPtr result(new BusImpl(this->asioService, options));
     this->busClients[endpoint] = result;
 
-    BusConnectionPtr connection(new BusConnection(result, socket, true, tcpnodelay));
+    BusConnectionPtr connection(new BusConnection(result, socket, *this->asioService->getService(),
+                                                  true, options));
     result->addConnection(connection);
     connection->startReceiving();
 
@@ -158,16 +175,18 @@ BusPtr Factory::getBusClientFor(const string&  host,
     return result;
 }
 
-BusServerPtr Factory::getBusServerFor(const string&  host,
-                                      uint16_t       port,
-                                      bool           tcpnodelay,
-                                      bool           waitForClientDisconnects) {
-    RSCDEBUG(logger, "Was asked for a bus server for " << host << ":" << port);
+BusServerPtr Factory::getBusServerFor(const BusOptions& options) {
+    const string&  host = options.host;
+    const uint16_t port = options.port;
+    const string&  path = options.path;
+
+    RSCDEBUG(logger, "Was asked for a bus server for " << host << ":" << port
+             << (path.empty() ? "" : " via local socket " + path));
 
     // Try to find an existing entry for the specified endpoint.
-    Endpoint endpoint(host, port);
+    Endpoint endpoint = makeEndpoint(host, port, path);
 
-    BusServerPtr result = searchInMap(endpoint, tcpnodelay, busServers);
+    BusServerPtr result = searchInMap(endpoint, options, busServers);
     if (result) {
         return result;
     }
@@ -179,8 +198,11 @@ BusServerPtr Factory::getBusServerFor(const string&  host,
     result = BusServerPtr(
             new LifecycledBusServer(
                     BusServerPtr(
-                            new BusServerImpl(this->asioService, port,
-                                    tcpnodelay, waitForClientDisconnects))));
+                            new BusServerImpl(this->asioService,
+                                    path.empty()
+                                    ? SocketEndpoint(tcp::endpoint(tcp::v4(), port))
+                                    : localEndpoint(path),
+                                    options))));
     result->activate();
     this->busServers[endpoint] = result;
 
@@ -189,28 +211,24 @@ BusServerPtr Factory::getBusServerFor(const string&  host,
     return result;
 }
 
-BusPtr Factory::getBus(const Server&          serverMode,
-                       const std::string&     host,
-                       const boost::uint16_t& port,
-                       bool                   tcpnodelay,
-                       bool                   waitForClientDisconnects) {
+BusPtr Factory::getBus(const BusOptions& options) {
 
     boost::mutex::scoped_lock lock(this->busMutex);
 
-    switch (serverMode) {
+    this->asioService->ensureThreads(options.threads);
+
+    switch (options.server) {
     case SERVER_NO:
-        return getBusClientFor(host, port, tcpnodelay);
+        return getBusClientFor(options);
     case SERVER_YES:
-        return getBusServerFor(host, port, tcpnodelay,
-                               waitForClientDisconnects);
+        return getBusServerFor(options);
     case SERVER_AUTO:
         try {
-            return getBusServerFor(host, port, tcpnodelay,
-                                   waitForClientDisconnects);
+            return getBusServerFor(options);
         } catch (const std::exception& e) {
             RSCINFO(logger,
                     "Could not create server for bus: " << e.what() << "; trying to access bus as client");
-            return getBusClientFor(host, port, tcpnodelay);
+            return getBusClientFor(options);
         }
     default:
         assert(false);
@@ -219,10 +237,49 @@ BusPtr Factory::getBus(const Server&          serverMode,
 
 }
 
-void Factory::checkOptions(BusPtr bus, bool tcpnodelay) {
-    if (bus->isTcpnodelay() != tcpnodelay) {
+Factory::Endpoint Factory::makeEndpoint(const string& host,
+                                        uint16_t      port,
+                                        const string& path) {
+    // Buses using local sockets are identified by their path alone.
+    if (!path.empty()) {
+        return Endpoint(path, 0);
+    }
+    return Endpoint(host, port);
+}
+
+void Factory::checkOptions(BusPtr bus, const BusOptions& options) {
+    const BusOptions& existing = bus->getOptions();
+    if (existing.tcpnodelay != options.tcpnodelay) {
         throw invalid_argument(str(format("Requested tcpnodelay option %1% does not match existing option %2%")
-                                   % tcpnodelay % bus->isTcpnodelay()));
+                                   % options.tcpnodelay % existing.tcpnodelay));
+    }
+    // The flush delay only affects throughput and latency, so a
+    // mismatch is not an error.
+    if (existing.flushDelay != options.flushDelay) {
+        RSCWARN(logger, "Requested flushdelay option " << options.flushDelay
+                << " does not match existing option " << existing.flushDelay
+                << "; using existing option");
+    }
+    // Header dictionaries are negotiated per connection and do not
+    // change the semantics of the bus either.
+    if (existing.headerDictionary != options.headerDictionary) {
+        RSCWARN(logger, "Requested headerdictionary option " << options.headerDictionary
+                << " does not match existing option " << existing.headerDictionary
+                << "; using existing option");
+    }
+    // Compression is negotiated per connection as well.
+    if ((existing.compression != options.compression)
+        || (existing.compressionThreshold != options.compressionThreshold)) {
+        RSCWARN(logger, "Requested compression options " << codecName(options.compression)
+                << ", " << options.compressionThreshold
+                << " do not match existing options " << codecName(existing.compression)
+                << ", " << existing.compressionThreshold
+                << "; using existing options");
+    }
+    if (existing.maxQueuedBytes != options.maxQueuedBytes) {
+        RSCWARN(logger, "Requested maxqueuedbytes option " << options.maxQueuedBytes
+                << " does not match existing option " << existing.maxQueuedBytes
+                << "; using existing option");
     }
 }
 
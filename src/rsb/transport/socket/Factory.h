@@ -33,6 +33,7 @@
 
 #include <boost/asio.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/generic/stream_protocol.hpp>
 
 #include <rsc/logging/Logger.h>
 
@@ -40,6 +41,7 @@
 
 #include "../AsioServiceContext.h"
 #include "Bus.h"
+#include "BusOptions.h"
 #include "BusServer.h"
 #include "Types.h"
 
@@ -65,18 +67,26 @@ public:
     ~Factory();
 
     /**
-     * Returns either a BusClient or Server depending on the chosen
-     * @a serverMode and the existence of a server in the current process.
+     * Returns either a BusClient or Server depending on the server
+     * mode, host, port and path given in @a options and the existence
+     * of a server in the current process.
+     *
+     * The io_service shared by all buses is run by at least @c
+     * options.threads threads after this call.
+     *
+     * If @c options.path is not empty, the bus is accessed via the
+     * local (AF_UNIX) socket @c options.path instead of a TCP
+     * socket. Paths starting with "@" designate sockets in the
+     * abstract namespace.
+     *
+     * Connections of a newly created bus use the connection-related
+     * settings in @a options. Existing buses keep their settings.
      */
-    BusPtr getBus(const Server&          serverMode,
-                  const std::string&     host,
-                  const boost::uint16_t& port,
-                  bool                   tcpnodelay,
-                  bool                   waitForClientDisconnects);
+    BusPtr getBus(const BusOptions& options);
 
 private:
     typedef std::pair<std::string, boost::uint16_t>	     Endpoint;
-    typedef boost::shared_ptr<boost::asio::ip::tcp::socket>  SocketPtr;
+    typedef boost::shared_ptr<boost::asio::generic::stream_protocol::socket> SocketPtr;
 
     typedef boost::shared_ptr<boost::asio::io_service::work> WorkPtr;
 
@@ -91,16 +101,15 @@ private:
 
     AsioServiceContextPtr   asioService;
 
-    BusPtr getBusClientFor(const std::string& host,
-                           boost::uint16_t    port,
-                           bool               tcpnodelay);
+    BusPtr getBusClientFor(const BusOptions& options);
 
-    BusServerPtr getBusServerFor(const std::string& host,
+    BusServerPtr getBusServerFor(const BusOptions& options);
+
+    static Endpoint makeEndpoint(const std::string& host,
                                  boost::uint16_t    port,
-                                 bool               tcpnodelay,
-                                 bool               waitForClientDisconnects);
+                                 const std::string& path);
 
-    static void checkOptions(BusPtr bus, bool tcpnodelay);
+    void checkOptions(BusPtr bus, const BusOptions& options);
 
     /**
      * Searches inside a given map for an active pointer to a Bus instance
@@ -108,7 +117,7 @@ private:
      */
     template<class BusType>
     boost::shared_ptr<BusType> searchInMap(const Endpoint& endpoint,
-            bool tcpnodelay,
+            const BusOptions& options,
             std::map<Endpoint, boost::weak_ptr<BusType> >& map);
 };
 
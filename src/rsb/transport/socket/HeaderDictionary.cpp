@@ -0,0 +1,283 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#include "HeaderDictionary.h"
+
+#include <cassert>
+
+#include "../../protocol/ProtocolException.h"
+
+#include "WireFormat.h"
+
+using namespace std;
+
+namespace rsb {
+namespace transport {
+namespace socket {
+
+namespace {
+
+// Field numbers of protocol buffer messages which are relevant for
+// the header dictionary. See rsb/protocol/{Notification,EventId}.proto.
+enum {
+    NOTIFICATION_SCOPE       = 6,
+    NOTIFICATION_WIRE_SCHEMA = 7,
+    NOTIFICATION_EVENT_ID    = 108,
+
+    EVENT_ID_SENDER_ID       = 1,
+    EVENT_ID_SEQUENCE_NUMBER = 2
+};
+
+}
+
+bool isHeaderDictionaryFrame(const string& frame) {
+    return (frame.size() >= 4)
+        && (readLengthHeader(frame) & HEADER_DICTIONARY_FLAG);
+}
+
+// An encoded frame consists of the length header with the
+// HEADER_DICTIONARY_FLAG bit set, followed by
+//
+//   varint                 (id << 1) | (1 if the tuple is defined)
+//   [bytes, bytes, bytes]  scope, wire-schema, sender id if defined
+//   varint                 sequence number
+//   ...                    remaining fields of the notification
+//
+// where bytes is a varint length followed by the respective number
+// of bytes.
+
+HeaderDictionaryEncoder::HeaderDictionaryEncoder(size_t maxEntries) :
+    maxEntries(maxEntries) {
+}
+
+FramePtr HeaderDictionaryEncoder::encode(FramePtr frame) {
+    if ((frame->size() < 4) || isHeaderDictionaryFrame(*frame)) {
+        return frame;
+    }
+
+    // Split the notification into scope, wire-schema, event id and
+    // the remaining fields. Notifications with missing, repeated or
+    // unexpected header fields are sent unmodified.
+    const char* scope      = 0;
+    const char* wireSchema = 0;
+    const char* eventId    = 0;
+    boost::uint64_t scopeLength = 0, wireSchemaLength = 0, eventIdLength = 0;
+    string rest;
+
+    WireReader reader(frame->data() + 4, frame->data() + frame->size());
+    while (!reader.atEnd()) {
+        const char* start = reader.getPosition();
+        unsigned int number, type;
+        const char* data = 0;
+        boost::uint64_t length = 0;
+        if (!reader.field(number, type, data, length)) {
+            return frame;
+        }
+        if ((type == WIRETYPE_LENGTH_DELIMITED)
+            && (number == NOTIFICATION_SCOPE)) {
+            if (scope) {
+                return frame;
+            }
+            scope = data;
+            scopeLength = length;
+        } else if ((type == WIRETYPE_LENGTH_DELIMITED)
+                   && (number == NOTIFICATION_WIRE_SCHEMA)) {
+            if (wireSchema) {
+                return frame;
+            }
+            wireSchema = data;
+            wireSchemaLength = length;
+        } else if ((type == WIRETYPE_LENGTH_DELIMITED)
+                   && (number == NOTIFICATION_EVENT_ID)) {
+            if (eventId) {
+                return frame;
+            }
+            eventId = data;
+            eventIdLength = length;
+        } else {
+            rest.append(start, reader.getPosition() - start);
+        }
+    }
+    if (!scope || !wireSchema || !eventId) {
+        return frame;
+    }
+
+    const char* senderId = 0;
+    boost::uint64_t senderIdLength = 0;
+    bool haveSequenceNumber = false;
+    boost::uint64_t sequenceNumber = 0;
+    WireReader idReader(eventId, eventId + eventIdLength);
+    while (!idReader.atEnd()) {
+        unsigned int number, type;
+        const char* data = 0;
+        boost::uint64_t length = 0;
+        if (!idReader.field(number, type, data, length)) {
+            return frame;
+        }
+        if ((type == WIRETYPE_LENGTH_DELIMITED)
+            && (number == EVENT_ID_SENDER_ID) && !senderId) {
+            senderId = data;
+            senderIdLength = length;
+        } else if ((type == WIRETYPE_VARINT)
+                   && (number == EVENT_ID_SEQUENCE_NUMBER)
+                   && !haveSequenceNumber) {
+            haveSequenceNumber = true;
+            sequenceNumber = length;
+        } else {
+            return frame;
+        }
+    }
+    if (!senderId || !haveSequenceNumber) {
+        return frame;
+    }
+
+    // Look up or assign the id of the header tuple.
+    string key;
+    appendBytes(key, scope, scopeLength);
+    appendBytes(key, wireSchema, wireSchemaLength);
+    appendBytes(key, senderId, senderIdLength);
+
+    boost::uint32_t id;
+    bool define = false;
+    EntryMap::const_iterator it = this->entries.find(key);
+    if (it != this->entries.end()) {
+        id = it->second;
+    } else if (this->entries.size() < this->maxEntries) {
+        id = this->entries.size();
+        this->entries.insert(make_pair(key, id));
+        define = true;
+    } else {
+        return frame;
+    }
+
+    const size_t size
+        = (varintSize(((boost::uint64_t) id << 1) | define)
+           + (define ? key.size() : 0)
+           + varintSize(sequenceNumber)
+           + rest.size());
+    // The tags of the replaced fields and the length of the event id
+    // take at least as many bytes as the id of the tuple. Encoded
+    // frames are therefore never larger than the original frame and
+    // cannot exceed the maximum frame size.
+    assert(size <= frame->size() - 4);
+
+    boost::shared_ptr<string> result(new string());
+    result->reserve(4 + size);
+    // Other flags of the frame are retained.
+    const boost::uint32_t flags = readLengthHeader(*frame) & ~FRAME_LENGTH_MASK;
+    appendLengthHeader(*result, size | flags | HEADER_DICTIONARY_FLAG);
+    appendVarint(*result, ((boost::uint64_t) id << 1) | define);
+    if (define) {
+        result->append(key);
+    }
+    appendVarint(*result, sequenceNumber);
+    result->append(rest);
+    return result;
+}
+
+size_t HeaderDictionaryEncoder::size() const {
+    return this->entries.size();
+}
+
+FramePtr HeaderDictionaryDecoder::decode(FramePtr frame) {
+    if (!isHeaderDictionaryFrame(*frame)) {
+        throw protocol::ProtocolException("Frame does not use a header dictionary");
+    }
+
+    WireReader reader(frame->data() + 4, frame->data() + frame->size());
+    boost::uint64_t idAndDefine;
+    if (!reader.varint(idAndDefine)) {
+        throw protocol::ProtocolException("Truncated header dictionary id");
+    }
+    const boost::uint64_t id = idAndDefine >> 1;
+
+    if (idAndDefine & 1) {
+        // Ids are assigned sequentially by the encoder.
+        if (id != this->entries.size()) {
+            throw protocol::ProtocolException("Unexpected header dictionary id in definition");
+        }
+        Entry entry;
+        const char* data;
+        boost::uint64_t length;
+        if (!(reader.varint(length) && reader.bytes(length, data))) {
+            throw protocol::ProtocolException("Truncated scope in header dictionary definition");
+        }
+        entry.scope.assign(data, length);
+        if (!(reader.varint(length) && reader.bytes(length, data))) {
+            throw protocol::ProtocolException("Truncated wire-schema in header dictionary definition");
+        }
+        entry.wireSchema.assign(data, length);
+        if (!(reader.varint(length) && reader.bytes(length, data))) {
+            throw protocol::ProtocolException("Truncated sender id in header dictionary definition");
+        }
+        entry.senderId.assign(data, length);
+        this->entries.push_back(entry);
+    } else if (id >= this->entries.size()) {
+        throw protocol::ProtocolException("Unknown header dictionary id");
+    }
+    const Entry& entry = this->entries[id];
+
+    boost::uint64_t sequenceNumber;
+    if (!reader.varint(sequenceNumber)) {
+        throw protocol::ProtocolException("Truncated sequence number in header dictionary frame");
+    }
+    const char* rest = reader.getPosition();
+    const size_t restLength = frame->data() + frame->size() - rest;
+
+    // Reconstruct the notification with fields in the order of their
+    // field numbers.
+    const size_t eventIdLength
+        = (1 + varintSize(entry.senderId.size()) + entry.senderId.size()
+           + 1 + varintSize(sequenceNumber));
+    const size_t size
+        = (1 + varintSize(entry.scope.size()) + entry.scope.size()
+           + 1 + varintSize(entry.wireSchema.size()) + entry.wireSchema.size()
+           + restLength
+           + varintSize((NOTIFICATION_EVENT_ID << 3) | WIRETYPE_LENGTH_DELIMITED)
+           + varintSize(eventIdLength) + eventIdLength);
+
+    const boost::uint32_t flags
+        = readLengthHeader(*frame) & ~FRAME_LENGTH_MASK & ~HEADER_DICTIONARY_FLAG;
+    boost::shared_ptr<string> result(new string());
+    result->reserve(4 + size);
+    appendLengthHeader(*result, size | flags);
+    appendBytesField(*result, NOTIFICATION_SCOPE,
+                     entry.scope.data(), entry.scope.size());
+    appendBytesField(*result, NOTIFICATION_WIRE_SCHEMA,
+                     entry.wireSchema.data(), entry.wireSchema.size());
+    result->append(rest, restLength);
+    appendVarint(*result, (NOTIFICATION_EVENT_ID << 3) | WIRETYPE_LENGTH_DELIMITED);
+    appendVarint(*result, eventIdLength);
+    appendBytesField(*result, EVENT_ID_SENDER_ID,
+                     entry.senderId.data(), entry.senderId.size());
+    appendVarint(*result, (EVENT_ID_SEQUENCE_NUMBER << 3) | WIRETYPE_VARINT);
+    appendVarint(*result, sequenceNumber);
+    return result;
+}
+
+}
+}
+}
@@ -0,0 +1,139 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/unordered_map.hpp>
+
+#include "Serialization.h"
+
+#include "rsb/rsbexports.h"
+
+namespace rsb {
+namespace transport {
+namespace socket {
+
+/**
+ * Bit of the length header of a frame which indicates that the
+ * scope, wire-schema and sender id of the notification in the frame
+ * have been replaced by an id of a header dictionary.
+ */
+const boost::uint32_t HEADER_DICTIONARY_FLAG = 0x80000000ul;
+
+/**
+ * Indicates whether @a frame has been produced by @ref
+ * HeaderDictionaryEncoder::encode.
+ *
+ * @param frame A frame including its length header.
+ * @return @c true if the header dictionary flag is set in the
+ *         length header of @a frame.
+ */
+bool isHeaderDictionaryFrame(const std::string& frame);
+
+/**
+ * Replaces the (scope, wire-schema, sender id) tuples of outgoing
+ * frames by small integer ids.
+ *
+ * Each tuple is transmitted once together with its newly assigned
+ * id. Subsequent frames containing the same tuple only carry the
+ * id. The receiving peer has to use a @ref HeaderDictionaryDecoder
+ * to reconstruct the original frames. Since ids are assigned in the
+ * order in which frames are encoded, frames have to be transmitted
+ * in that order.
+ *
+ * Instances are not thread-safe.
+ *
+ * @author jmoringe
+ */
+class RSB_EXPORT HeaderDictionaryEncoder {
+public:
+    /**
+     * @param maxEntries Maximum number of tuples in the
+     *                   dictionary. Frames containing other tuples
+     *                   are not encoded once the dictionary is full.
+     */
+    explicit HeaderDictionaryEncoder(std::size_t maxEntries = 4096);
+
+    /**
+     * Encodes @a frame using the dictionary, adding its header tuple
+     * if necessary.
+     *
+     * @param frame The frame, including its length header, that
+     *              should be encoded.
+     * @return The encoded frame or @a frame itself if it cannot be
+     *         encoded.
+     */
+    FramePtr encode(FramePtr frame);
+
+    /**
+     * Returns the number of tuples in the dictionary.
+     */
+    std::size_t size() const;
+private:
+    typedef boost::unordered_map<std::string, boost::uint32_t> EntryMap;
+
+    std::size_t maxEntries;
+    EntryMap    entries;
+};
+
+/**
+ * Reconstructs frames produced by a @ref HeaderDictionaryEncoder on
+ * the remote side of a connection.
+ *
+ * Instances are not thread-safe.
+ *
+ * @author jmoringe
+ */
+class RSB_EXPORT HeaderDictionaryDecoder {
+public:
+    /**
+     * Decodes @a frame, adding the header tuple it defines, if any,
+     * to the dictionary.
+     *
+     * @param frame A frame, including its length header, for which
+     *              @ref isHeaderDictionaryFrame is true.
+     * @return The reconstructed frame.
+     * @throw protocol::ProtocolException If @a frame is malformed or
+     *                                    refers to an unknown id.
+     */
+    FramePtr decode(FramePtr frame);
+private:
+    struct Entry {
+        std::string scope;
+        std::string wireSchema;
+        std::string senderId;
+    };
+
+    std::vector<Entry> entries;
+};
+
+}
+}
+}
@@ -26,9 +26,13 @@
 
 #include "InConnector.h"
 
+#include <rsc/runtime/NoSuchObject.h>
+
 #include "../../MetaData.h"
 
 #include "Factory.h"
+#include "OutgoingEvent.h"
+#include "ReceivedFrame.h"
 
 using namespace std;
 
@@ -47,22 +51,13 @@ transport::InConnector* InConnector::create(const Properties& args) {
 
     return new InConnector(getDefaultFactory(),
                            args.get<ConverterSelectionStrategyPtr>("converters"),
-                           args.get<string>                       ("host",       DEFAULT_HOST),
-                           args.getAs<unsigned int>               ("port",       DEFAULT_PORT),
-                           args.getAs<Server>                     ("server",     SERVER_AUTO),
-                           args.getAs<bool>                       ("tcpnodelay", true),
-                           args.getAs<bool>                       ("wait",       true));
+                           busOptionsFromProperties(args));
 }
 
 InConnector::InConnector(FactoryPtr                    factory,
                          ConverterSelectionStrategyPtr converters,
-                         const string&                 host,
-                         unsigned int                  port,
-                         Server                        server,
-                         bool                          tcpnodelay,
-                         bool                          waitForClientDisconnects) :
-    ConnectorBase(factory, converters, host, port, server, tcpnodelay,
-                  waitForClientDisconnects),
+                         const BusOptions&             options) :
+    ConnectorBase(factory, converters, options),
     logger(Logger::getLogger("rsb.transport.socket.InConnector")) {
 }
 
@@ -105,26 +100,36 @@ void InConnector::setScope(const Scope& scope) {
 }
 
 void InConnector::handle(EventPtr busEvent) {
-    if (!this->active) {
-        throw std::runtime_error("Cannot handle events when not active");
-    }
-
     // busEvent is an intermediate object. The deserialization of the
     // payload still has to be performed.
-    EventPtr event(new Event(*busEvent));
-
-    event->mutableMetaData().setReceiveTime();
-
+    //
     // Extract the serialized data and wire-schema from the
-    // intermediate event.
-    boost::shared_ptr<string> wireData = static_pointer_cast<string>(event->getData());
-    string wireSchema = event->getMetaData().getUserInfo("rsb.wire-schema");
+    // intermediate event and apply the configured converter.
+    boost::shared_ptr<string> wireData = static_pointer_cast<string>(busEvent->getData());
+    string wireSchema = busEvent->getMetaData().getUserInfo("rsb.wire-schema");
+    AnnotatedData d = getConverter(wireSchema)->deserialize(wireSchema, *wireData);
 
-    // Apply the configured converter.
-    AnnotatedData d
-        = getConverter(wireSchema)->deserialize(wireSchema, *wireData);
+    EventPtr event(new Event(*busEvent));
     event->setData(d.second);
     event->setType(d.first);
+    dispatch(event);
+}
+
+void InConnector::handleReceived(ReceivedFrame& frame) {
+    EventPtr busEvent = frame.getEvent();
+    string wireSchema = busEvent->getMetaData().getUserInfo("rsb.wire-schema");
+    ConverterPtr converter = getConverter(wireSchema);
+
+    // The payload is only deserialized when it is requested for the
+    // first time. The data-type is known from the converter.
+    EventPtr event(new Event(*busEvent));
+    event->setDataLoader(frame.getDataLoader(converter));
+    event->setType(converter->getDataType());
+    dispatch(event);
+}
+
+void InConnector::dispatch(EventPtr event) {
+    event->mutableMetaData().setReceiveTime();
 
     // Dispatch the final result to all handlers (typically a single
     // object implementing the EventReceivingStrategy interface).
@@ -134,6 +139,41 @@ void InConnector::handle(EventPtr busEvent) {
     }
 }
 
+void InConnector::handleLocal(OutgoingEvent& outgoing) {
+    EventPtr localEvent = outgoing.getEvent();
+
+    // localEvent is shared with other local connectors. Its payload
+    // can be shared as well since it is not modified.
+    EventPtr event(new Event(*localEvent));
+
+    // Select the converter based on the wire-schema declared by the
+    // sending converter. If the selected converter produces the data
+    // type of the original payload, the payload is passed to the
+    // handlers without serializing it.
+    if (!outgoing.isSerialized()) {
+        const string declaredWireSchema = outgoing.getDeclaredWireSchema();
+        ConverterPtr converter;
+        try {
+            converter = getConverter(declaredWireSchema);
+        } catch (const rsc::runtime::NoSuchObject&) {
+        }
+        if (converter && (converter->getDataType() == localEvent->getType())) {
+            event->mutableMetaData().setUserInfo("rsb.wire-schema",
+                                                 declaredWireSchema);
+            dispatch(event);
+            return;
+        }
+    }
+
+    const string& wireSchema = outgoing.getWireSchema();
+    AnnotatedData d = getConverter(wireSchema)->deserialize(wireSchema,
+                                                            *outgoing.getWireData());
+    event->setData(d.second);
+    event->setType(d.first);
+    event->mutableMetaData().setUserInfo("rsb.wire-schema", wireSchema);
+    dispatch(event);
+}
+
 const std::string InConnector::getTransportURL() const {
     return ConnectorBase::getTransportURL();
 }
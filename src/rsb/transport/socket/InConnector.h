@@ -46,6 +46,9 @@ namespace rsb {
 namespace transport {
 namespace socket {
 
+class OutgoingEvent;
+class ReceivedFrame;
+
 /**
  * Instances of this class receive events from a bus that is accessed
  * via a socket connection.
@@ -69,11 +72,7 @@ public:
      */
     InConnector(FactoryPtr                    factory,
                 ConverterSelectionStrategyPtr converters,
-                const std::string&            host,
-                unsigned int                  port,
-                Server                        server,
-                bool                          tcpnodelay,
-                bool                          waitForClientDisconnects);
+                const BusOptions&             options);
 
     virtual ~InConnector();
 
@@ -86,12 +85,38 @@ public:
 
     void handle(EventPtr event);
 
+    /**
+     * Handles @a event which has been submitted to the bus by a
+     * connector in this process. In contrast to @ref handle, the
+     * original payload of @a event is passed to the handlers directly
+     * and without serializing it if the converter selected for the
+     * wire-schema declared by the sending converter produces the data
+     * type of the payload. Otherwise, the serialized payload is
+     * deserialized like for remote events.
+     *
+     * @param event The event submitted to the bus.
+     */
+    void handleLocal(OutgoingEvent& event);
+
+    /**
+     * Handles @a frame which has been received by the bus. The
+     * payload is deserialized lazily via @a frame when it is first
+     * requested, so that events rejected by filters are never
+     * deserialized and connectors which select the same converter
+     * share the deserialized payload.
+     *
+     * @param frame The received frame.
+     */
+    void handleReceived(ReceivedFrame& frame);
+
     // Overwrites method in ConnectorBase.
     virtual const std::string getTransportURL() const;
 private:
     rsc::logging::LoggerPtr logger;
 
     void printContents(std::ostream& stream) const;
+
+    void dispatch(EventPtr event);
 };
 
 typedef boost::shared_ptr<InConnector> InConnectorPtr;
@@ -63,14 +63,18 @@ void LifecycledBusServer::removeConnection(BusConnectionPtr connection) {
     this->server->removeConnection(connection);
 }
 
-bool LifecycledBusServer::isTcpnodelay() const {
-    return this->server->isTcpnodelay();
+const BusOptions& LifecycledBusServer::getOptions() const {
+    return this->server->getOptions();
 }
 
 void LifecycledBusServer::handle(EventPtr event) {
     this->server->handle(event);
 }
 
+void LifecycledBusServer::handleOutgoing(OutgoingEvent& event) {
+    this->server->handleOutgoing(event);
+}
+
 void LifecycledBusServer::activate() {
     RSCDEBUG(logger, "Activating");
     this->server->activate();
@@ -81,9 +85,9 @@ void LifecycledBusServer::deactivate() {
     this->server->deactivate();
 }
 
-void LifecycledBusServer::handleIncoming(EventPtr event,
+void LifecycledBusServer::handleIncoming(ReceivedFrame& frame,
         BusConnectionPtr connection) {
-    this->server->handleIncoming(event, connection);
+    this->server->handleIncoming(frame, connection);
 }
 
 const string LifecycledBusServer::getTransportURL() const {
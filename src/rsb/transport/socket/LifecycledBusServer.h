@@ -59,15 +59,17 @@ public:
     virtual void addConnection(BusConnectionPtr connection);
     virtual void removeConnection(BusConnectionPtr connection);
 
-    virtual bool isTcpnodelay() const;
+    virtual const BusOptions& getOptions() const;
 
     virtual void handle(EventPtr event);
 
+    virtual void handleOutgoing(OutgoingEvent& event);
+
     void activate();
 
     void deactivate();
 
-    void handleIncoming(EventPtr         event,
+    void handleIncoming(ReceivedFrame&   frame,
                         BusConnectionPtr connection);
 
     virtual const std::string getTransportURL() const;
@@ -27,6 +27,7 @@
 #include "OutConnector.h"
 
 #include "Bus.h"
+#include "OutgoingEvent.h"
 #include "../../MetaData.h"
 #include "../../EventId.h"
 
@@ -47,22 +48,13 @@ transport::OutConnector* OutConnector::create(const Properties& args) {
 
     return new OutConnector(getDefaultFactory(),
                             args.get<ConverterSelectionStrategyPtr>("converters"),
-                            args.get<string>                       ("host",       DEFAULT_HOST),
-                            args.getAs<unsigned int>               ("port",       DEFAULT_PORT),
-                            args.getAs<Server>                     ("server",     SERVER_AUTO),
-                            args.getAs<bool>                       ("tcpnodelay", true),
-                            args.getAs<bool>                       ("wait", true));
+                            busOptionsFromProperties(args));
 }
 
 OutConnector::OutConnector(FactoryPtr                    factory,
-                           ConverterSelectionStrategyPtr  converters,
-                           const string&                  host,
-                           unsigned int                   port,
-                           Server                         server,
-                           bool                           tcpnodelay,
-                           bool                           waitForClientDisconnects) :
-    ConnectorBase(factory, converters, host, port, server, tcpnodelay,
-                  waitForClientDisconnects),
+                           ConverterSelectionStrategyPtr converters,
+                           const BusOptions&             options) :
+    ConnectorBase(factory, converters, options),
     logger(Logger::getLogger("rsb.transport.socket.OutConnector")){
 }
 
@@ -89,14 +81,12 @@ void OutConnector::setQualityOfServiceSpecs(const QualityOfServiceSpec& /*specs*
 void OutConnector::handle(EventPtr event) {
     event->mutableMetaData().setSendTime();
 
+    // The payload is only serialized if the bus has sinks or
+    // connections for the event. Local sinks receive the original
+    // payload if possible.
     EventPtr busEvent(new Event(*event));
-    boost::shared_ptr<string> wireData(new string());
-    AnnotatedData d(busEvent->getType(), busEvent->getData());
-    string wireSchema = getConverter(busEvent->getType())->serialize(d, *wireData);
-    busEvent->setData(wireData);
-    busEvent->mutableMetaData().setUserInfo("rsb.wire-schema", wireSchema);
-
-    getBus()->handle(busEvent);
+    OutgoingEvent outgoing(busEvent, getConverter(busEvent->getType()));
+    getBus()->handleOutgoing(outgoing);
 }
 
 const std::string OutConnector::getTransportURL() const {
@@ -54,11 +54,7 @@ public:
      */
     OutConnector(FactoryPtr                    factory,
                  ConverterSelectionStrategyPtr converters,
-                 const std::string&            host,
-                 unsigned int                  port,
-                 Server                        server,
-                 bool                          tcpnodelay,
-                 bool                          waitForClientDisconnects=true);
+                 const BusOptions&             options);
 
     virtual ~OutConnector();
 
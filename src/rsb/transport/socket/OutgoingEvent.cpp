@@ -0,0 +1,105 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#include "OutgoingEvent.h"
+
+#include "../../MetaData.h"
+
+using namespace std;
+
+namespace rsb {
+namespace transport {
+namespace socket {
+
+OutgoingEvent::OutgoingEvent(EventPtr event, ConverterPtr converter) :
+    event(event), converter(converter) {
+}
+
+OutgoingEvent::OutgoingEvent(EventPtr event) :
+    event(event) {
+}
+
+EventPtr OutgoingEvent::getEvent() const {
+    return this->event;
+}
+
+bool OutgoingEvent::isSerialized() const {
+    return !this->converter;
+}
+
+string OutgoingEvent::getDeclaredWireSchema() {
+    if (this->converter) {
+        return this->converter->getWireSchema();
+    }
+    return getWireSchema();
+}
+
+const string& OutgoingEvent::getWireSchema() {
+    serialize();
+    return this->wireSchema;
+}
+
+boost::shared_ptr<string> OutgoingEvent::getWireData() {
+    serialize();
+    return this->wireData;
+}
+
+FramePtr OutgoingEvent::getFrame() {
+    if (!this->frame) {
+        serialize();
+        this->frame = eventToFrame(this->event, this->wireSchema, *this->wireData);
+    }
+    return this->frame;
+}
+
+FrameVariants& OutgoingEvent::getFrames() {
+    if (!this->frames) {
+        this->frames.reset(new FrameVariants(getFrame()));
+    }
+    return *this->frames;
+}
+
+void OutgoingEvent::serialize() {
+    if (this->wireData) {
+        return;
+    }
+
+    if (this->converter) {
+        boost::shared_ptr<string> wireData(new string());
+        AnnotatedData d(this->event->getType(), this->event->getData());
+        this->wireSchema = this->converter->serialize(d, *wireData);
+        this->wireData = wireData;
+        this->event->mutableMetaData().setUserInfo("rsb.wire-schema",
+                                                   this->wireSchema);
+    } else {
+        this->wireSchema = this->event->getMetaData().getUserInfo("rsb.wire-schema");
+        this->wireData = boost::static_pointer_cast<string>(this->event->getData());
+    }
+}
+
+}
+}
+}
@@ -0,0 +1,160 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#pragma once
+
+#include <string>
+
+#include "../../Event.h"
+
+#include "../../converter/Converter.h"
+
+#include "Serialization.h"
+#include "Compression.h"
+
+#include "rsb/rsbexports.h"
+
+namespace rsb {
+namespace transport {
+namespace socket {
+
+/**
+ * Instances of this class represent an event that is submitted to a
+ * @ref Bus by a local out-direction connector.
+ *
+ * If the event carries its original, unserialized payload, the
+ * payload is serialized at most once, when the wire-schema, the
+ * serialized payload or the frame is requested for the first
+ * time. Local sinks select their converters based on the wire-schema
+ * declared by the sending converter (see @ref
+ * getDeclaredWireSchema), which does not require serializing the
+ * payload, and receive the original payload directly if the
+ * selected converter produces its data type. The payload is
+ * therefore only serialized for remote peers and local sinks which
+ * need a different data type. Events with already serialized
+ * payloads are supported for callers of @ref Bus::handle.
+ *
+ * @author jmoringe
+ */
+class RSB_EXPORT OutgoingEvent {
+public:
+    typedef converter::Converter<std::string>::Ptr ConverterPtr;
+
+    /**
+     * Constructs an outgoing event with unserialized payload.
+     *
+     * @param event The event with its original payload. When the
+     *              payload is serialized, the wire-schema is stored
+     *              in the "rsb.wire-schema" meta data item of @a
+     *              event.
+     * @param converter The converter which should be used to
+     *                  serialize the payload of @a event.
+     */
+    OutgoingEvent(EventPtr event, ConverterPtr converter);
+
+    /**
+     * Constructs an outgoing event with already serialized payload.
+     *
+     * @param event The event with a payload of type std::string and
+     *              the wire-schema stored in the "rsb.wire-schema"
+     *              meta data item.
+     */
+    explicit OutgoingEvent(EventPtr event);
+
+    /**
+     * Returns the event that has been submitted to the bus.
+     *
+     * @return The event.
+     */
+    EventPtr getEvent() const;
+
+    /**
+     * Indicates whether the payload of the event returned by @ref
+     * getEvent is already serialized.
+     *
+     * @return @c true if the payload is serialized, @c false if it is
+     *         the original payload.
+     */
+    bool isSerialized() const;
+
+    /**
+     * Returns the wire-schema declared by the converter which
+     * serializes the payload without serializing it. The wire-schema
+     * returned by @ref getWireSchema can be more specific, for
+     * example for converters which accept arbitrary wire-schemas.
+     *
+     * @return The declared wire-schema or, if the payload is already
+     *         serialized, the wire-schema of the serialized payload.
+     */
+    std::string getDeclaredWireSchema();
+
+    /**
+     * Returns the wire-schema of the serialized payload, serializing
+     * the payload if necessary.
+     *
+     * @return The wire-schema.
+     */
+    const std::string& getWireSchema();
+
+    /**
+     * Returns the serialized payload, serializing the payload if
+     * necessary.
+     *
+     * @return The serialized payload.
+     */
+    boost::shared_ptr<std::string> getWireData();
+
+    /**
+     * Returns the frame for the event, serializing the payload if
+     * necessary. The frame is only produced once.
+     *
+     * @return The frame.
+     */
+    FramePtr getFrame();
+
+    /**
+     * Returns the variants of the frame returned by @ref getFrame
+     * from which connections select the one suitable for their
+     * peers. This allows compressing the payload once for all
+     * connections.
+     *
+     * @return The frame variants.
+     */
+    FrameVariants& getFrames();
+private:
+    EventPtr                         event;
+    ConverterPtr                     converter;
+    std::string                      wireSchema;
+    boost::shared_ptr<std::string>   wireData;
+    FramePtr                         frame;
+    boost::shared_ptr<FrameVariants> frames;
+
+    void serialize();
+};
+
+}
+}
+}
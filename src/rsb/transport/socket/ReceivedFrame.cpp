@@ -0,0 +1,194 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#include "ReceivedFrame.h"
+
+#include <boost/thread/mutex.hpp>
+
+#include "../../protocol/ProtocolException.h"
+
+#include "WireFormat.h"
+
+using namespace std;
+
+namespace rsb {
+namespace transport {
+namespace socket {
+
+namespace {
+
+// Field number of the scope in rsb/protocol/Notification.proto.
+const unsigned int NOTIFICATION_SCOPE = 6;
+
+/**
+ * Reads the scope of the notification in @a frame without parsing
+ * the complete notification. Returns false if the frame is malformed
+ * or does not contain a scope.
+ */
+bool readScope(const string& frame, string& scope) {
+    bool found = false;
+    WireReader reader(frame.data() + 4, frame.data() + frame.size());
+    while (!reader.atEnd()) {
+        unsigned int number, type;
+        const char* value = 0;
+        boost::uint64_t length = 0;
+        if (!reader.field(number, type, value, length)) {
+            return false;
+        }
+        // Like the protocol buffer parser, use the last occurrence.
+        if ((number == NOTIFICATION_SCOPE)
+            && (type == WIRETYPE_LENGTH_DELIMITED)) {
+            scope.assign(value, length);
+            found = true;
+        }
+    }
+    return found;
+}
+
+/**
+ * Deserializes a payload on the first invocation and returns the
+ * cached result afterwards. Instances are shared between all events
+ * created from one received frame for one converter.
+ */
+class Deserializer {
+public:
+    Deserializer(converter::Converter<string>::Ptr converter,
+                 const string&                     wireSchema,
+                 boost::shared_ptr<string>         wireData) :
+        converter(converter), wireSchema(wireSchema), wireData(wireData) {
+    }
+
+    VoidPtr operator()() {
+        boost::mutex::scoped_lock lock(this->mutex);
+        if (this->wireData) {
+            this->data = this->converter->deserialize(this->wireSchema,
+                                                      *this->wireData).second;
+            this->wireData.reset();
+        }
+        return this->data;
+    }
+private:
+    boost::mutex                      mutex;
+    converter::Converter<string>::Ptr converter;
+    string                            wireSchema;
+    boost::shared_ptr<string>         wireData;
+    VoidPtr                           data;
+};
+
+// Allows storing a shared Deserializer in a boost::function.
+struct DeserializerRef {
+    boost::shared_ptr<Deserializer> deserializer;
+    VoidPtr operator()() const {
+        return (*this->deserializer)();
+    }
+};
+
+}
+
+ReceivedFrame::ReceivedFrame(FramePtr                frame,
+                             protocol::Notification& notification) :
+    frame(frame), notification(notification), parsed(false) {
+    string scope;
+    if (!readScope(*frame, scope)) {
+        throw protocol::ProtocolException("Received frame without readable scope");
+    }
+    try {
+        this->scope = internScope(scope);
+    } catch (const std::exception& e) {
+        throw protocol::ProtocolException(string("Received frame with invalid scope: ")
+                                          + e.what());
+    }
+}
+
+FramePtr ReceivedFrame::getFrame() const {
+    return this->frame;
+}
+
+FrameVariants& ReceivedFrame::getFrames() {
+    if (!this->frames) {
+        this->frames.reset(new FrameVariants(this->frame));
+    }
+    return *this->frames;
+}
+
+const Scope& ReceivedFrame::getScope() const {
+    return *this->scope;
+}
+
+protocol::Notification& ReceivedFrame::getNotification() {
+    if (!this->parsed) {
+        if (!this->notification.ParseFromArray(this->frame->data() + 4,
+                                               this->frame->size() - 4)) {
+            throw protocol::ProtocolException("Received unparseable notification");
+        }
+
+        // The frame itself is relayed as it is to connections the
+        // peers of which can decompress it.
+        if (isCompressedFrame(*this->frame)) {
+            const string& data = this->notification.data();
+            string decompressed;
+            decompressPayload(data.data(), data.size(), decompressed);
+            this->notification.mutable_data()->swap(decompressed);
+        }
+        this->parsed = true;
+    }
+    return this->notification;
+}
+
+EventPtr ReceivedFrame::getEvent() {
+    if (!this->event) {
+        getNotification();
+
+        // Take ownership of the payload instead of copying it. The
+        // notification is not used for anything else afterwards
+        // since the frame is relayed verbatim.
+        boost::shared_ptr<string> data(new string());
+        data->swap(*this->notification.mutable_data());
+        this->event = notificationToEvent(this->notification, true,
+                                          this->scope, data);
+    }
+    return this->event;
+}
+
+Event::DataLoader ReceivedFrame::getDataLoader(converter::Converter<std::string>::Ptr converter) {
+    DataCache::const_iterator it = this->data.find(converter);
+    if (it == this->data.end()) {
+        // The wire data of the event is shared with the loader and
+        // therefore not copied.
+        boost::shared_ptr<string> wireData
+            = boost::static_pointer_cast<string>(getEvent()->getData());
+        DeserializerRef loader;
+        loader.deserializer.reset(new Deserializer(converter,
+                                                   this->notification.wire_schema(),
+                                                   wireData));
+        it = this->data.insert(make_pair(converter, Event::DataLoader(loader))).first;
+    }
+    return it->second;
+}
+
+}
+}
+}
@@ -0,0 +1,156 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#pragma once
+
+#include <string>
+#include <map>
+
+#include "../../Event.h"
+#include "../../Scope.h"
+
+#include "../../converter/Converter.h"
+
+#include "../../protocol/Notification.h"
+
+#include "Serialization.h"
+#include "Compression.h"
+
+#include "rsb/rsbexports.h"
+
+namespace rsb {
+namespace transport {
+namespace socket {
+
+/**
+ * Instances of this class represent a frame that has been received
+ * from a @ref BusConnection.
+ *
+ * Only the scope is read from the frame upon construction. The
+ * original bytes of the frame are retained so that the frame can be
+ * relayed verbatim to other connections. The notification is only
+ * parsed, and its payload decompressed, when it or the corresponding
+ * @ref Event is requested, that is, when a local sink is interested
+ * in the frame. The payload is moved from the notification into the
+ * event instead of being copied. Similarly, the payload is
+ * deserialized at most once per converter via the loaders returned
+ * by @ref getDataLoader, no matter how many local sinks receive the
+ * frame, and only if one of them requests the payload.
+ *
+ * @author jmoringe
+ */
+class RSB_EXPORT ReceivedFrame {
+public:
+    /**
+     * @param frame The received frame including its length header.
+     * @param notification The notification into which @a frame is
+     *                     parsed when required. The notification has
+     *                     to stay valid during the lifetime of the
+     *                     constructed object. Its payload is moved
+     *                     into the event returned by @ref getEvent.
+     * @throw protocol::ProtocolException If the scope cannot be read
+     *                                    from @a frame.
+     */
+    ReceivedFrame(FramePtr                frame,
+                  protocol::Notification& notification);
+
+    /**
+     * Returns the received frame including its length header.
+     *
+     * @return The frame.
+     */
+    FramePtr getFrame() const;
+
+    /**
+     * Returns the variants of the received frame from which
+     * connections select the one suitable for their peers when
+     * relaying the frame.
+     *
+     * @return The frame variants.
+     */
+    FrameVariants& getFrames();
+
+    /**
+     * Returns the scope of the received notification.
+     *
+     * @return The scope.
+     */
+    const Scope& getScope() const;
+
+    /**
+     * Returns the notification contained in the received frame. The
+     * notification is parsed and its payload decompressed when this
+     * method is called for the first time.
+     *
+     * @return The notification.
+     * @throw protocol::ProtocolException If the frame cannot be
+     *                                    parsed or its payload cannot
+     *                                    be decompressed.
+     */
+    protocol::Notification& getNotification();
+
+    /**
+     * Returns an @ref Event constructed from the received
+     * notification. The event is constructed when this method is
+     * called for the first time. Its payload is not deserialized and
+     * the wire-schema is exposed via the "rsb.wire-schema" meta-data
+     * item.
+     *
+     * @return A shared pointer to the event.
+     * @throw protocol::ProtocolException If the frame cannot be
+     *                                    parsed or its payload cannot
+     *                                    be decompressed.
+     */
+    EventPtr getEvent();
+
+    /**
+     * Returns a function which deserializes the payload of the
+     * received notification using @a converter when it is called for
+     * the first time and returns the cached result on subsequent
+     * calls. Sinks which select the same converter share the
+     * function and thus the deserialized object. The function remains
+     * valid after this object has been destroyed.
+     *
+     * @param converter The converter that should be applied to the
+     *                  payload.
+     * @return The function producing the deserialized payload.
+     */
+    Event::DataLoader getDataLoader(converter::Converter<std::string>::Ptr converter);
+private:
+    typedef std::map<converter::Converter<std::string>::Ptr, Event::DataLoader> DataCache;
+
+    FramePtr                         frame;
+    boost::shared_ptr<FrameVariants> frames;
+    protocol::Notification&          notification;
+    bool                             parsed;
+    ScopePtr                         scope;
+    EventPtr                         event;
+    DataCache                        data;
+};
+
+}
+}
+}
@@ -26,6 +26,11 @@
 
 #include "Serialization.h"
 
+#include <cassert>
+#include <stdexcept>
+
+#include <boost/format.hpp>
+
 #include "../../MetaData.h"
 #include "../../EventId.h"
 #include "../../Scope.h"
@@ -36,8 +41,10 @@ namespace rsb {
 namespace transport {
 namespace socket {
 
-EventPtr notificationToEvent(protocol::Notification& notification,
-                             bool                    exposeWireSchema) {
+EventPtr notificationToEvent(const protocol::Notification&  notification,
+                             bool                           exposeWireSchema,
+                             ScopePtr                       scope,
+                             boost::shared_ptr<std::string> data) {
     /** TODO(jmoringe): it may be possible to keep a single event
      * instance here since connectors probably have to copy events  */
     EventPtr event(new Event());
@@ -51,7 +58,7 @@ EventPtr notificationToEvent(protocol::Notification& notification,
         rsc::misc::UUID(
             (boost::uint8_t*) notification.event_id().sender_id().c_str()),
         notification.event_id().sequence_number());
-    event->setScopePtr(ScopePtr(new Scope(notification.scope())));
+    event->setScopePtr(scope ? scope : internScope(notification.scope()));
     if (notification.has_method()) {
         event->setMethod(notification.method());
     }
@@ -69,7 +76,7 @@ EventPtr notificationToEvent(protocol::Notification& notification,
                                 notification.causes(i).sequence_number()));
     }
 
-    event->setData(boost::shared_ptr<string>(new string(notification.data())));
+    event->setData(data ? data : boost::shared_ptr<string>(new string(notification.data())));
 
     if (exposeWireSchema) {
         metaData.setUserInfo("rsb.wire-schema", notification.wire_schema());
@@ -125,6 +132,349 @@ void eventToNotification(protocol::Notification& notification,
     notification.set_data(data);
 }
 
+namespace {
+
+// Field numbers and wire types of the protocol buffer messages
+// emitted by the frame encoder. These have to match the definitions
+// in rsb/protocol/{Notification,EventId,EventMetaData}.proto.
+enum WireType {
+    WIRETYPE_VARINT           = 0,
+    WIRETYPE_LENGTH_DELIMITED = 2
+};
+
+enum {
+    NOTIFICATION_SCOPE       = 6,
+    NOTIFICATION_WIRE_SCHEMA = 7,
+    NOTIFICATION_DATA        = 9,
+    NOTIFICATION_CAUSES      = 13,
+    NOTIFICATION_METHOD      = 14,
+    NOTIFICATION_META_DATA   = 15,
+    NOTIFICATION_EVENT_ID    = 108,
+
+    EVENT_ID_SENDER_ID       = 1,
+    EVENT_ID_SEQUENCE_NUMBER = 2,
+
+    META_DATA_CREATE_TIME    = 2,
+    META_DATA_SEND_TIME      = 3,
+    META_DATA_USER_TIMES     = 6,
+    META_DATA_USER_INFOS     = 7,
+
+    USER_TIME_KEY            = 1,
+    USER_TIME_TIMESTAMP      = 2,
+
+    USER_INFO_KEY            = 1,
+    USER_INFO_VALUE          = 2
+};
+
+size_t varintSize(boost::uint64_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+size_t varintFieldSize(unsigned int field, boost::uint64_t value) {
+    return varintSize(field << 3) + varintSize(value);
+}
+
+size_t delimitedFieldSize(unsigned int field, size_t length) {
+    return varintSize(field << 3) + varintSize(length) + length;
+}
+
+size_t eventIdSize(const EventId& id) {
+    return (delimitedFieldSize(EVENT_ID_SENDER_ID,
+                               id.getParticipantId().getId().size())
+            + varintFieldSize(EVENT_ID_SEQUENCE_NUMBER,
+                              id.getSequenceNumber()));
+}
+
+size_t userTimeSize(const string& key, boost::uint64_t timestamp) {
+    return (delimitedFieldSize(USER_TIME_KEY, key.size())
+            + varintFieldSize(USER_TIME_TIMESTAMP, timestamp));
+}
+
+size_t userInfoSize(const string& key, const string& value) {
+    return (delimitedFieldSize(USER_INFO_KEY, key.size())
+            + delimitedFieldSize(USER_INFO_VALUE, value.size()));
+}
+
+size_t metaDataSize(const MetaData& metaData) {
+    size_t size
+        = (varintFieldSize(META_DATA_CREATE_TIME, metaData.getCreateTime())
+           + varintFieldSize(META_DATA_SEND_TIME, metaData.getSendTime()));
+    for (map<string, boost::uint64_t>::const_iterator it
+             = metaData.userTimesBegin();
+         it != metaData.userTimesEnd(); ++it) {
+        size += delimitedFieldSize(META_DATA_USER_TIMES,
+                                   userTimeSize(it->first, it->second));
+    }
+    for (map<string, string>::const_iterator it = metaData.userInfosBegin();
+         it != metaData.userInfosEnd(); ++it) {
+        size += delimitedFieldSize(META_DATA_USER_INFOS,
+                                   userInfoSize(it->first, it->second));
+    }
+    return size;
+}
+
+/**
+ * Appends protocol buffer wire format elements to a string which has
+ * been reserved to the final size.
+ */
+class WireWriter {
+public:
+    WireWriter(string& buffer) :
+        buffer(buffer) {
+    }
+
+    void varint(boost::uint64_t value) {
+        while (value >= 0x80) {
+            this->buffer.push_back(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        this->buffer.push_back(static_cast<char>(value));
+    }
+
+    void tag(unsigned int field, WireType type) {
+        varint((field << 3) | type);
+    }
+
+    void varintField(unsigned int field, boost::uint64_t value) {
+        tag(field, WIRETYPE_VARINT);
+        varint(value);
+    }
+
+    void delimitedHeader(unsigned int field, size_t length) {
+        tag(field, WIRETYPE_LENGTH_DELIMITED);
+        varint(length);
+    }
+
+    void bytesField(unsigned int field, const void* data, size_t length) {
+        delimitedHeader(field, length);
+        this->buffer.append(static_cast<const char*>(data), length);
+    }
+
+    void bytesField(unsigned int field, const string& data) {
+        bytesField(field, data.data(), data.size());
+    }
+
+    void eventId(unsigned int field, const EventId& id) {
+        const boost::uuids::uuid senderId = id.getParticipantId().getId();
+        delimitedHeader(field, eventIdSize(id));
+        bytesField(EVENT_ID_SENDER_ID, senderId.data, senderId.size());
+        varintField(EVENT_ID_SEQUENCE_NUMBER, id.getSequenceNumber());
+    }
+private:
+    string& buffer;
+};
+
+}
+
+void checkFrameSize(size_t size) {
+    if (size > FRAME_LENGTH_MASK) {
+        throw invalid_argument(boost::str(boost::format("Frame of size %1% exceeds maximum frame size %2%")
+                                          % size % FRAME_LENGTH_MASK));
+    }
+}
+
+FramePtr eventToFrame(const EventPtr& event,
+                      const string&   wireSchema,
+                      const string&   data) {
+    // Fields are emitted in the order of their field numbers, like
+    // the protocol buffer implementation does, so that the produced
+    // frames are identical to serialized protocol::Notification
+    // objects.
+    // mutableMetaData avoids copying the meta-data.
+    const string&      scope    = event->getScopePtr()->toString();
+    const string       method   = event->getMethod();
+    const MetaData&    metaData = event->mutableMetaData();
+    const EventId      id       = event->getId();
+    const set<EventId> causes   = event->getCauses();
+
+    // Compute the exact size of the notification.
+    const size_t metaSize = metaDataSize(metaData);
+    size_t size
+        = (delimitedFieldSize(NOTIFICATION_SCOPE, scope.size())
+           + delimitedFieldSize(NOTIFICATION_WIRE_SCHEMA, wireSchema.size())
+           + delimitedFieldSize(NOTIFICATION_DATA, data.size())
+           + delimitedFieldSize(NOTIFICATION_META_DATA, metaSize)
+           + delimitedFieldSize(NOTIFICATION_EVENT_ID, eventIdSize(id)));
+    for (set<EventId>::const_iterator it = causes.begin();
+         it != causes.end(); ++it) {
+        size += delimitedFieldSize(NOTIFICATION_CAUSES, eventIdSize(*it));
+    }
+    if (!method.empty()) {
+        size += delimitedFieldSize(NOTIFICATION_METHOD, method.size());
+    }
+    checkFrameSize(size);
+
+    boost::shared_ptr<string> frame(new string());
+    frame->reserve(4 + size);
+
+    // Size header.
+    frame->push_back(static_cast<char>((size & 0x000000fful) >> 0));
+    frame->push_back(static_cast<char>((size & 0x0000ff00ul) >> 8));
+    frame->push_back(static_cast<char>((size & 0x00ff0000ul) >> 16));
+    frame->push_back(static_cast<char>((size & 0xff000000ul) >> 24));
+
+    // Notification.
+    WireWriter writer(*frame);
+    writer.bytesField(NOTIFICATION_SCOPE, scope);
+    writer.bytesField(NOTIFICATION_WIRE_SCHEMA, wireSchema);
+    writer.bytesField(NOTIFICATION_DATA, data);
+    for (set<EventId>::const_iterator it = causes.begin();
+         it != causes.end(); ++it) {
+        writer.eventId(NOTIFICATION_CAUSES, *it);
+    }
+    if (!method.empty()) {
+        writer.bytesField(NOTIFICATION_METHOD, method);
+    }
+
+    writer.delimitedHeader(NOTIFICATION_META_DATA, metaSize);
+    writer.varintField(META_DATA_CREATE_TIME, metaData.getCreateTime());
+    writer.varintField(META_DATA_SEND_TIME, metaData.getSendTime());
+    for (map<string, boost::uint64_t>::const_iterator it
+             = metaData.userTimesBegin();
+         it != metaData.userTimesEnd(); ++it) {
+        writer.delimitedHeader(META_DATA_USER_TIMES,
+                               userTimeSize(it->first, it->second));
+        writer.bytesField(USER_TIME_KEY, it->first);
+        writer.varintField(USER_TIME_TIMESTAMP, it->second);
+    }
+    for (map<string, string>::const_iterator it = metaData.userInfosBegin();
+         it != metaData.userInfosEnd(); ++it) {
+        writer.delimitedHeader(META_DATA_USER_INFOS,
+                               userInfoSize(it->first, it->second));
+        writer.bytesField(USER_INFO_KEY, it->first);
+        writer.bytesField(USER_INFO_VALUE, it->second);
+    }
+
+    writer.eventId(NOTIFICATION_EVENT_ID, id);
+
+    assert(frame->size() == 4 + size);
+
+    return frame;
+}
+
+const Scope& subscriptionScope() {
+    static const Scope scope("/__rsb/transport/socket/subscriptions/");
+    return scope;
+}
+
+FramePtr subscriptionsToFrame(const rsc::misc::UUID& senderId,
+                              boost::uint32_t        sequenceNumber,
+                              const set<Scope>&      scopes) {
+    // The subscribed scopes are transmitted as a newline-separated
+    // list in the payload.
+    boost::shared_ptr<string> data(new string());
+    for (set<Scope>::const_iterator it = scopes.begin();
+         it != scopes.end(); ++it) {
+        *data += it->toString();
+        *data += '\n';
+    }
+
+    EventPtr event(new Event(subscriptionScope(), data, "bytes",
+                             "SUBSCRIPTIONS"));
+    event->setId(senderId, sequenceNumber);
+    return eventToFrame(event, "bytes", *data);
+}
+
+FramePtr subscriptionNegotiationToFrame(bool acknowledgement) {
+    EventPtr event(new Event(subscriptionScope(),
+                             boost::shared_ptr<string>(new string()),
+                             "bytes",
+                             acknowledgement ? "ACKNOWLEDGE" : "PROPOSE"));
+    event->setId(rsc::misc::UUID(), 0);
+    return eventToFrame(event, "bytes", "");
+}
+
+bool isSubscriptionNegotiationNotification(const protocol::Notification& notification) {
+    return ((notification.method() == "PROPOSE")
+            || (notification.method() == "ACKNOWLEDGE"))
+        && (notification.scope() == subscriptionScope().toString());
+}
+
+bool isSubscriptionNotification(const protocol::Notification& notification) {
+    return (notification.method() == "SUBSCRIPTIONS")
+        && (notification.scope() == subscriptionScope().toString());
+}
+
+set<Scope> notificationToSubscriptions(const protocol::Notification& notification) {
+    set<Scope> result;
+    const string& data = notification.data();
+    string::size_type start = 0;
+    string::size_type end;
+    while ((end = data.find('\n', start)) != string::npos) {
+        result.insert(Scope(data.substr(start, end - start)));
+        start = end + 1;
+    }
+    return result;
+}
+
+const Scope& headerDictionaryScope() {
+    static const Scope scope("/__rsb/transport/socket/headerdictionary/");
+    return scope;
+}
+
+FramePtr headerDictionaryToFrame(bool acknowledgement) {
+    EventPtr event(new Event(headerDictionaryScope(),
+                             boost::shared_ptr<string>(new string()),
+                             "bytes",
+                             acknowledgement ? "ACKNOWLEDGE" : "PROPOSE"));
+    event->setId(rsc::misc::UUID(), 0);
+    return eventToFrame(event, "bytes", "");
+}
+
+bool isHeaderDictionaryNotification(const protocol::Notification& notification) {
+    return ((notification.method() == "PROPOSE")
+            || (notification.method() == "ACKNOWLEDGE"))
+        && (notification.scope() == headerDictionaryScope().toString());
+}
+
+const Scope& compressionScope() {
+    static const Scope scope("/__rsb/transport/socket/compression/");
+    return scope;
+}
+
+FramePtr compressionToFrame(bool acknowledgement, const set<string>& codecs) {
+    // Like subscribed scopes, codec names are transmitted as a
+    // newline-separated list.
+    boost::shared_ptr<string> data(new string());
+    for (set<string>::const_iterator it = codecs.begin();
+         it != codecs.end(); ++it) {
+        *data += *it;
+        *data += '\n';
+    }
+
+    EventPtr event(new Event(compressionScope(), data, "bytes",
+                             acknowledgement ? "ACKNOWLEDGE" : "PROPOSE"));
+    event->setId(rsc::misc::UUID(), 0);
+    return eventToFrame(event, "bytes", *data);
+}
+
+bool isCompressionNotification(const protocol::Notification& notification) {
+    return ((notification.method() == "PROPOSE")
+            || (notification.method() == "ACKNOWLEDGE"))
+        && (notification.scope() == compressionScope().toString());
+}
+
+set<string> notificationToCodecs(const protocol::Notification& notification) {
+    set<string> result;
+    const string& data = notification.data();
+    string::size_type start = 0;
+    string::size_type end;
+    while ((end = data.find('\n', start)) != string::npos) {
+        result.insert(data.substr(start, end - start));
+        start = end + 1;
+    }
+    return result;
+}
+
+bool isNegotiationAcknowledgement(const protocol::Notification& notification) {
+    return notification.method() == "ACKNOWLEDGE";
+}
+
 }
 }
 }
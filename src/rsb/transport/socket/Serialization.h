@@ -26,12 +26,68 @@
 
 #pragma once
 
+#include <string>
+#include <set>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/cstdint.hpp>
+
+#include <rsc/misc/UUID.h>
+
 #include "../../Event.h"
+#include "../../Scope.h"
 #include "../../protocol/Notification.h"
 
 namespace rsb {
 namespace transport {
 namespace socket {
+
+/**
+ * A frame is the unit of transmission of the socket transport: a
+ * 4-byte little-endian length header followed by a serialized @ref
+ * protocol::Notification. Frames are immutable and can therefore be
+ * shared between all connections to which they are sent.
+ */
+typedef boost::shared_ptr<const std::string> FramePtr;
+
+/**
+ * Bits of the length header of a frame which contain the length of
+ * the frame body. The remaining bits are flags which indicate
+ * encodings negotiated between the peers of a connection (see @ref
+ * HEADER_DICTIONARY_FLAG and @ref COMPRESSION_FLAG).
+ *
+ * Frame bodies are therefore limited to @c FRAME_LENGTH_MASK bytes
+ * (1 GiB - 1) instead of the 4 GiB - 1 bytes the plain 32-bit length
+ * header could describe. Since the flags are only set for negotiated
+ * encodings, older peers sending larger frames cannot be
+ * distinguished from peers using these encodings.
+ */
+const boost::uint32_t FRAME_LENGTH_MASK = 0x3ffffffful;
+
+/**
+ * Checks that a frame body of @a size bytes can be described by the
+ * length header of a frame.
+ *
+ * @param size The size of the frame body in bytes.
+ * @throw std::invalid_argument If @a size exceeds @ref
+ *                              FRAME_LENGTH_MASK.
+ */
+void checkFrameSize(std::size_t size);
+
+/**
+ * Flag in the 4-byte little-endian handshake a bus server sends to
+ * each newly connected client. The flag indicates that the bus
+ * server understands the negotiation notifications on @ref
+ * subscriptionScope, @ref headerDictionaryScope and @ref
+ * compressionScope and does not relay them to other clients. Bus
+ * clients only send these notifications if the flag is set.
+ *
+ * Older bus servers send a handshake of zero while older bus clients
+ * ignore the value of the handshake. Peers which do not support the
+ * negotiations therefore never receive negotiation notifications.
+ */
+const boost::uint32_t HANDSHAKE_NEGOTIATION_FLAG = 0x00000001ul;
+
 /**
  * Converts @a notification into an @ref Event. The event payload will
  * be copied from @a notification into the event unmodified to allow
@@ -42,10 +98,20 @@ namespace socket {
  * @param exposeWireSchema Controls whether the wire-schema stored in
  *                         @a notification should be exposed in a meta
  *                         data item of the created event.
+ * @param scope If not empty, the scope of the created event, which
+ *              has to correspond to the scope stored in @a
+ *              notification. Otherwise, the scope is constructed from
+ *              @a notification.
+ * @param data If not empty, the payload of the created event, which
+ *             replaces the payload stored in @a notification.
+ *             Otherwise, the payload is copied from @a notification.
  * @return A shared pointer to a newly allocated @ref rsb::Event.
  */
-EventPtr notificationToEvent(protocol::Notification& notification,
-                             bool                    exposeWireSchema = false);
+EventPtr notificationToEvent(const protocol::Notification&  notification,
+                             bool                           exposeWireSchema = false,
+                             ScopePtr                       scope = ScopePtr(),
+                             boost::shared_ptr<std::string> data
+                             = boost::shared_ptr<std::string>());
 /**
  * Converts the @ref Event @a event into a @ref
  * protocol::Notification, storing the result in @a notification.
@@ -62,6 +128,187 @@ void eventToNotification(protocol::Notification& notification,
                          const std::string&      wireSchema,
                          const std::string&      data);
 
+/**
+ * Converts the @ref Event @a event into a @ref protocol::Notification
+ * and produces a frame consisting of the length header and the
+ * serialized notification.
+ *
+ * @param event event The @ref Event object that should be serialized.
+ * @param wireSchema The wire-Schema that should be stored in the
+ *                   notification.
+ * @param data The payload that should be stored in the notification.
+ * @return A shared pointer to the newly allocated frame.
+ * @throw std::invalid_argument If the serialized notification exceeds
+ *                              @ref FRAME_LENGTH_MASK bytes.
+ */
+FramePtr eventToFrame(const EventPtr&    event,
+                      const std::string& wireSchema,
+                      const std::string& data);
+
+/**
+ * Returns the scope on which bus clients announce the scopes of
+ * their local sinks to the bus server. Notifications on this scope
+ * are control messages of the socket transport and are neither
+ * dispatched to connectors nor relayed to other connections.
+ *
+ * Announcements are negotiated like header dictionaries (see @ref
+ * headerDictionaryScope): a bus client proposes announcements and
+ * only sends them after the bus server acknowledged the
+ * proposal. Bus clients only send the proposal to bus servers which
+ * advertise @ref HANDSHAKE_NEGOTIATION_FLAG in their handshake, so
+ * that older bus servers do not relay it to their clients as an
+ * ordinary event.
+ *
+ * @return The scope for subscription announcements.
+ */
+const Scope& subscriptionScope();
+
+/**
+ * Produces a frame proposing or acknowledging subscription
+ * announcements.
+ *
+ * @param acknowledgement Whether an acknowledgement or a proposal
+ *                        should be produced.
+ * @return A shared pointer to the newly allocated frame.
+ */
+FramePtr subscriptionNegotiationToFrame(bool acknowledgement);
+
+/**
+ * Indicates whether @a notification has been produced by @ref
+ * subscriptionNegotiationToFrame.
+ *
+ * @param notification The notification that should be checked.
+ * @return @c true if @a notification negotiates subscription
+ *         announcements, @c false otherwise.
+ */
+bool isSubscriptionNegotiationNotification(const protocol::Notification& notification);
+
+/**
+ * Produces a frame announcing that the sender is interested in events
+ * on @a scopes and their respective sub-scopes.
+ *
+ * @param senderId Sender id stored in the notification.
+ * @param sequenceNumber Sequence number stored in the notification.
+ * @param scopes The complete set of subscribed scopes of the sender.
+ * @return A shared pointer to the newly allocated frame.
+ */
+FramePtr subscriptionsToFrame(const rsc::misc::UUID& senderId,
+                              boost::uint32_t        sequenceNumber,
+                              const std::set<Scope>& scopes);
+
+/**
+ * Indicates whether @a notification is a subscription announcement
+ * produced by @ref subscriptionsToFrame.
+ *
+ * @param notification The notification that should be checked.
+ * @return @c true if @a notification announces subscriptions, @c
+ *         false otherwise.
+ */
+bool isSubscriptionNotification(const protocol::Notification& notification);
+
+/**
+ * Extracts the set of subscribed scopes from the subscription
+ * announcement @a notification.
+ *
+ * @param notification The notification from which the scopes should
+ *                     be extracted.
+ * @return The set of subscribed scopes.
+ */
+std::set<Scope> notificationToSubscriptions(const protocol::Notification& notification);
+
+/**
+ * Returns the scope on which peers negotiate the use of header
+ * dictionaries (see @ref HeaderDictionaryEncoder). Like subscription
+ * announcements, these notifications are control messages of the
+ * socket transport.
+ *
+ * A bus client which wants to use a header dictionary sends a
+ * proposal to the bus server if the bus server advertised @ref
+ * HANDSHAKE_NEGOTIATION_FLAG in its handshake. A bus server which
+ * has header dictionaries enabled answers with an
+ * acknowledgement. Afterwards, both peers may send encoded frames on
+ * the connection.
+ *
+ * @return The scope for header dictionary negotiation.
+ */
+const Scope& headerDictionaryScope();
+
+/**
+ * Produces a frame proposing or acknowledging the use of header
+ * dictionaries.
+ *
+ * @param acknowledgement Whether an acknowledgement or a proposal
+ *                        should be produced.
+ * @return A shared pointer to the newly allocated frame.
+ */
+FramePtr headerDictionaryToFrame(bool acknowledgement);
+
+/**
+ * Indicates whether @a notification has been produced by @ref
+ * headerDictionaryToFrame.
+ *
+ * @param notification The notification that should be checked.
+ * @return @c true if @a notification negotiates header
+ *         dictionaries, @c false otherwise.
+ */
+bool isHeaderDictionaryNotification(const protocol::Notification& notification);
+
+/**
+ * Returns the scope on which peers negotiate payload compression. The
+ * negotiation works like the one for header dictionaries (see @ref
+ * headerDictionaryScope) but proposals and acknowledgements carry
+ * the names of the codecs the sender can decompress. After the
+ * negotiation, each peer compresses payloads using its configured
+ * codec if the other peer can decompress it.
+ *
+ * @return The scope for compression negotiation.
+ */
+const Scope& compressionScope();
+
+/**
+ * Produces a frame proposing or acknowledging payload compression.
+ *
+ * @param acknowledgement Whether an acknowledgement or a proposal
+ *                        should be produced.
+ * @param codecs The names of the codecs the sender can decompress.
+ * @return A shared pointer to the newly allocated frame.
+ */
+FramePtr compressionToFrame(bool                         acknowledgement,
+                            const std::set<std::string>& codecs);
+
+/**
+ * Indicates whether @a notification has been produced by @ref
+ * compressionToFrame.
+ *
+ * @param notification The notification that should be checked.
+ * @return @c true if @a notification negotiates compression, @c
+ *         false otherwise.
+ */
+bool isCompressionNotification(const protocol::Notification& notification);
+
+/**
+ * Extracts the codec names from the compression negotiation @a
+ * notification.
+ *
+ * @param notification A notification for which @ref
+ *                     isCompressionNotification is true.
+ * @return The names of the codecs the sender can decompress.
+ */
+std::set<std::string> notificationToCodecs(const protocol::Notification& notification);
+
+/**
+ * Indicates whether the subscription, header dictionary or
+ * compression negotiation @a notification is an acknowledgement.
+ *
+ * @param notification A notification for which @ref
+ *                     isSubscriptionNegotiationNotification, @ref
+ *                     isHeaderDictionaryNotification or @ref
+ *                     isCompressionNotification is true.
+ * @return @c true if @a notification is an acknowledgement, @c false
+ *         if it is a proposal.
+ */
+bool isNegotiationAcknowledgement(const protocol::Notification& notification);
+
 }
 }
 }
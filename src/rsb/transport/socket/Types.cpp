@@ -26,6 +26,11 @@
 
 #include "Types.h"
 
+#include <cstring>
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+
 using namespace std;
 
 using namespace boost;
@@ -38,6 +43,67 @@ const string DEFAULT_HOST = "localhost";
 
 const uint16_t DEFAULT_PORT = 55555;
 
+SocketEndpoint localEndpoint(const string& path) {
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+    if (path.empty()) {
+        throw invalid_argument("Local socket path must not be empty");
+    }
+
+    // A leading "@" designates the abstract namespace in which names
+    // start with a null byte.
+    string name = path;
+    if (name[0] == '@') {
+        name[0] = '\0';
+    }
+
+    try {
+        return SocketEndpoint(boost::asio::local::stream_protocol::endpoint(name));
+    } catch (const boost::system::system_error& e) {
+        throw invalid_argument(str(format("Invalid local socket path %1%: %2%")
+                                   % path % e.what()));
+    }
+#else
+    throw invalid_argument(str(format("Cannot use local socket path %1%:"
+                                      " local sockets are not supported on this platform")
+                               % path));
+#endif
+}
+
+bool isLocalEndpoint(const SocketEndpoint& endpoint) {
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+    return endpoint.protocol().family() == AF_UNIX;
+#else
+    return false;
+#endif
+}
+
+string localEndpointPath(const SocketEndpoint& endpoint) {
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+    boost::asio::local::stream_protocol::endpoint local;
+    std::memcpy(local.data(), endpoint.data(), endpoint.size());
+    local.resize(endpoint.size());
+
+    string path = local.path();
+    if (!path.empty() && (path[0] == '\0')) {
+        path[0] = '@';
+    }
+    return path;
+#else
+    return "";
+#endif
+}
+
+string endpointToURL(const SocketEndpoint& endpoint) {
+    if (isLocalEndpoint(endpoint)) {
+        return "socket:" + localEndpointPath(endpoint);
+    }
+
+    boost::asio::ip::tcp::endpoint tcp;
+    std::memcpy(tcp.data(), endpoint.data(), endpoint.size());
+    return str(format("socket://%1%:%2%")
+               % tcp.address().to_string() % tcp.port());
+}
+
 }
 }
 }
@@ -33,6 +33,8 @@
 #include <boost/cstdint.hpp>
 #include <boost/format.hpp>
 
+#include <boost/asio/generic/stream_protocol.hpp>
+
 namespace rsb {
 namespace transport {
 namespace socket {
@@ -87,6 +89,52 @@ extern const std::string DEFAULT_HOST;
 
 extern const boost::uint16_t DEFAULT_PORT;
 
+/**
+ * Stream sockets of the socket transport can either be TCP sockets or
+ * local (AF_UNIX) sockets.
+ */
+typedef boost::asio::generic::stream_protocol::endpoint SocketEndpoint;
+
+/**
+ * Returns an endpoint designating the local (AF_UNIX) socket @a
+ * path.
+ *
+ * @param path A filesystem path or, if starting with "@", the name of
+ *             a socket in the abstract namespace.
+ * @return The endpoint.
+ * @throw std::invalid_argument If @a path is empty or too long or
+ *                              local sockets are not supported on
+ *                              the platform.
+ */
+SocketEndpoint localEndpoint(const std::string& path);
+
+/**
+ * Indicates whether @a endpoint designates a local (AF_UNIX) socket.
+ *
+ * @param endpoint The endpoint to check.
+ * @return @c true if @a endpoint is a local endpoint, @c false
+ *         otherwise.
+ */
+bool isLocalEndpoint(const SocketEndpoint& endpoint);
+
+/**
+ * Returns the path of the local endpoint @a endpoint. Names in the
+ * abstract namespace are returned with a leading "@".
+ *
+ * @param endpoint A local endpoint.
+ * @return The path.
+ */
+std::string localEndpointPath(const SocketEndpoint& endpoint);
+
+/**
+ * Returns a transport URL describing @a endpoint.
+ *
+ * @param endpoint A TCP or local endpoint.
+ * @return A URL of the form socket://HOST:PORT for TCP endpoints and
+ *         socket:PATH for local endpoints.
+ */
+std::string endpointToURL(const SocketEndpoint& endpoint);
+
 }
 }
 }
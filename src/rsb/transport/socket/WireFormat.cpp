@@ -0,0 +1,142 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#include "WireFormat.h"
+
+using namespace std;
+
+namespace rsb {
+namespace transport {
+namespace socket {
+
+WireReader::WireReader(const char* begin, const char* end) :
+    position(begin), end(end) {
+}
+
+bool WireReader::atEnd() const {
+    return this->position == this->end;
+}
+
+const char* WireReader::getPosition() const {
+    return this->position;
+}
+
+bool WireReader::varint(boost::uint64_t& value) {
+    value = 0;
+    for (unsigned int shift = 0; shift < 64; shift += 7) {
+        if (this->position == this->end) {
+            return false;
+        }
+        const unsigned char byte = *this->position++;
+        value |= (boost::uint64_t) (byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool WireReader::bytes(boost::uint64_t length, const char*& data) {
+    if ((boost::uint64_t) (this->end - this->position) < length) {
+        return false;
+    }
+    data = this->position;
+    this->position += length;
+    return true;
+}
+
+bool WireReader::field(unsigned int&    number,
+                       unsigned int&    type,
+                       const char*&     data,
+                       boost::uint64_t& length) {
+    boost::uint64_t tag;
+    if (!varint(tag)) {
+        return false;
+    }
+    number = tag >> 3;
+    type   = tag & 0x7;
+    switch (type) {
+    case WIRETYPE_VARINT:
+        return varint(length);
+    case WIRETYPE_FIXED64:
+        return bytes(8, data);
+    case WIRETYPE_LENGTH_DELIMITED:
+        return varint(length) && bytes(length, data);
+    case WIRETYPE_FIXED32:
+        return bytes(4, data);
+    default:
+        // Groups are not used by the protocol.
+        return false;
+    }
+}
+
+size_t varintSize(boost::uint64_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+void appendVarint(string& buffer, boost::uint64_t value) {
+    while (value >= 0x80) {
+        buffer.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back(static_cast<char>(value));
+}
+
+void appendBytes(string& buffer, const char* data, size_t length) {
+    appendVarint(buffer, length);
+    buffer.append(data, length);
+}
+
+void appendBytesField(string& buffer, unsigned int field,
+                      const char* data, size_t length) {
+    appendVarint(buffer, (field << 3) | WIRETYPE_LENGTH_DELIMITED);
+    appendBytes(buffer, data, length);
+}
+
+boost::uint32_t readLengthHeader(const string& frame) {
+    const unsigned char* header
+        = reinterpret_cast<const unsigned char*>(frame.data());
+    return ((((boost::uint32_t) header[0]) << 0)
+            | (((boost::uint32_t) header[1]) << 8)
+            | (((boost::uint32_t) header[2]) << 16)
+            | (((boost::uint32_t) header[3]) << 24));
+}
+
+void appendLengthHeader(string& frame, boost::uint32_t header) {
+    frame.push_back(static_cast<char>((header & 0x000000fful) >> 0));
+    frame.push_back(static_cast<char>((header & 0x0000ff00ul) >> 8));
+    frame.push_back(static_cast<char>((header & 0x00ff0000ul) >> 16));
+    frame.push_back(static_cast<char>((header & 0xff000000ul) >> 24));
+}
+
+}
+}
+}
@@ -0,0 +1,102 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#pragma once
+
+#include <string>
+
+#include <boost/cstdint.hpp>
+
+namespace rsb {
+namespace transport {
+namespace socket {
+
+// Helpers for inspecting and rewriting frames at the level of the
+// protocol buffer wire format without a full protocol::Notification
+// object.
+
+enum {
+    WIRETYPE_VARINT           = 0,
+    WIRETYPE_FIXED64          = 1,
+    WIRETYPE_LENGTH_DELIMITED = 2,
+    WIRETYPE_FIXED32          = 5
+};
+
+/**
+ * Sequentially reads protocol buffer wire format elements from a
+ * buffer. Methods return @c false if the buffer ends prematurely or
+ * contains unsupported elements.
+ *
+ * @author jmoringe
+ */
+class WireReader {
+public:
+    WireReader(const char* begin, const char* end);
+
+    bool atEnd() const;
+
+    const char* getPosition() const;
+
+    bool varint(boost::uint64_t& value);
+
+    bool bytes(boost::uint64_t length, const char*& data);
+
+    /**
+     * Reads a field. For length-delimited fields, @a data and @a
+     * length designate the value of the field. For varint fields, @a
+     * length contains the value.
+     */
+    bool field(unsigned int&    number,
+               unsigned int&    type,
+               const char*&     data,
+               boost::uint64_t& length);
+private:
+    const char* position;
+    const char* end;
+};
+
+std::size_t varintSize(boost::uint64_t value);
+
+void appendVarint(std::string& buffer, boost::uint64_t value);
+
+/**
+ * Appends @a length followed by @a length bytes starting at @a data.
+ */
+void appendBytes(std::string& buffer, const char* data, std::size_t length);
+
+void appendBytesField(std::string& buffer, unsigned int field,
+                      const char* data, std::size_t length);
+
+/**
+ * Returns the raw length header of @a frame including flag bits.
+ */
+boost::uint32_t readLengthHeader(const std::string& frame);
+
+void appendLengthHeader(std::string& frame, boost::uint32_t header);
+
+}
+}
+}
@@ -40,6 +40,11 @@
 #include "socket/OutConnector.h"
 #endif
 
+#ifdef RSB_WITH_SHM_TRANSPORT
+#include "shm/InConnector.h"
+#include "shm/OutConnector.h"
+#endif
+
 using namespace std;
 
 namespace rsb {
@@ -72,6 +77,13 @@ void registerDefaultTransports() {
             options.insert("server");
             options.insert("tcpnodelay");
             options.insert("wait");
+            options.insert("threads");
+            options.insert("path");
+            options.insert("flushdelay");
+            options.insert("headerdictionary");
+            options.insert("compression");
+            options.insert("compressionthreshold");
+            options.insert("maxqueuedbytes");
 
             factory.registerConnector("socket",
                                       &socket::InConnector::create,
@@ -81,6 +93,20 @@ void registerDefaultTransports() {
         }
 #endif
 
+#ifdef RSB_WITH_SHM_TRANSPORT
+        {
+            set<string> options;
+            options.insert("name");
+            options.insert("capacity");
+
+            factory.registerConnector("shm",
+                                      &shm::InConnector::create,
+                                      "shm",
+                                      true,
+                                      options);
+        }
+#endif
+
     }
 
     // Out-direction connectors
@@ -99,6 +125,13 @@ void registerDefaultTransports() {
             options.insert("server");
             options.insert("tcpnodelay");
             options.insert("wait");
+            options.insert("threads");
+            options.insert("path");
+            options.insert("flushdelay");
+            options.insert("headerdictionary");
+            options.insert("compression");
+            options.insert("compressionthreshold");
+            options.insert("maxqueuedbytes");
 
             factory.registerConnector("socket",
                                       &socket::OutConnector::create,
@@ -108,6 +141,20 @@ void registerDefaultTransports() {
         }
 #endif
 
+#ifdef RSB_WITH_SHM_TRANSPORT
+        {
+            set<string> options;
+            options.insert("name");
+            options.insert("capacity");
+
+            factory.registerConnector("shm",
+                                      &shm::OutConnector::create,
+                                      "shm",
+                                      true,
+                                      options);
+        }
+#endif
+
     }
 
 }
@@ -38,6 +38,19 @@ using namespace std;
 using namespace testing;
 using namespace rsb;
 
+namespace {
+
+struct CountingLoader {
+    int* calls;
+    VoidPtr data;
+    VoidPtr operator()() const {
+        ++*this->calls;
+        return this->data;
+    }
+};
+
+}
+
 TEST(EventTest, testCausality) {
 
     EventId cause1(rsc::misc::UUID(), rand());
@@ -82,3 +95,30 @@ TEST(EventTest, testCausality) {
     EXPECT_EQ(size_t(1), event.getCauses().size());
 
 }
+
+TEST(EventTest, testDataLoader) {
+
+    int calls = 0;
+    CountingLoader loader;
+    loader.calls = &calls;
+    loader.data.reset(new string("lazy"));
+
+    Event event;
+    event.setDataLoader(loader);
+    EXPECT_EQ(0, calls);
+
+    EXPECT_EQ(loader.data, event.getData());
+    EXPECT_EQ(1, calls);
+
+    // Copies share the loader.
+    Event copy(event);
+    EXPECT_EQ(loader.data, copy.getData());
+    EXPECT_EQ(2, calls);
+
+    // setData replaces the loader.
+    VoidPtr eager(new string("eager"));
+    event.setData(eager);
+    EXPECT_EQ(eager, event.getData());
+    EXPECT_EQ(2, calls);
+
+}
@@ -32,6 +32,7 @@
 #include <gmock/gmock.h>
 
 #include "rsb/Informer.h"
+#include "rsb/EventId.h"
 #include "rsb/Scope.h"
 #include "rsb/ParticipantConfig.h"
 
@@ -50,3 +51,21 @@ TEST(InformerTest, testCreateEvent) {
     EXPECT_EQ(rsc::runtime::typeName<string>(), event->getType());
 
 }
+
+TEST(InformerTest, testPublishAsync) {
+
+    const Scope scope("/foo/bar");
+    Informer<string> informer(vector<transport::OutConnectorPtr>(), scope,
+            ParticipantConfig());
+
+    EventPtr event = informer.createEvent();
+    event->setData(boost::shared_ptr<string>(new string("foo")));
+    Informer<string>::CompletionFuturePtr future = informer.publishAsync(event);
+    EventPtr sent = future->get(10.0);
+    EXPECT_EQ(event->getId(), sent->getId());
+
+    EventPtr wrongScope = informer.createEvent();
+    wrongScope->setScope(Scope("/other"));
+    EXPECT_THROW(informer.publishAsync(wrongScope), invalid_argument);
+
+}
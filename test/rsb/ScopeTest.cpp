@@ -183,3 +183,21 @@ TEST(ScopeTest, testRootScopeConstruction)
     EXPECT_TRUE(Scope().getComponents().empty());
     EXPECT_TRUE(Scope("/").getComponents().empty());
 }
+
+TEST(ScopeTest, testInterning)
+{
+
+    ScopePtr first = internScope("/a/b");
+    ScopePtr second = internScope("/a/b");
+    EXPECT_EQ(first.get(), second.get());
+    EXPECT_EQ(Scope("/a/b/"), *first);
+    EXPECT_EQ(Scope("/a/b/").getHash(), first->getHash());
+
+    // Different spellings of the same scope may yield different
+    // objects, but they have to be equal.
+    ScopePtr third = internScope("/a/b/");
+    EXPECT_EQ(*first, *third);
+
+    EXPECT_THROW(internScope("invalid"), invalid_argument);
+
+}
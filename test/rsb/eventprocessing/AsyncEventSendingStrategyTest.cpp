@@ -0,0 +1,165 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#include <stdexcept>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <gtest/gtest.h>
+
+#include "rsb/eventprocessing/AsyncEventSendingStrategy.h"
+#include "rsb/transport/OutConnector.h"
+#include "rsb/MetaData.h"
+#include "rsb/Scope.h"
+
+using namespace std;
+
+using namespace rsb;
+using namespace rsb::eventprocessing;
+using namespace rsb::transport;
+
+class RecordingOutConnector: public OutConnector {
+public:
+
+    RecordingOutConnector() :
+        fail(false) {
+    }
+
+    string getClassName() const {
+        return "RecordingOutConnector";
+    }
+
+    void setScope(const Scope& /*scope*/) {
+    }
+
+    void activate() {
+    }
+
+    void deactivate() {
+    }
+
+    void setQualityOfServiceSpecs(const QualityOfServiceSpec& /*specs*/) {
+    }
+
+    const string getTransportURL() const {
+        return "recording:";
+    }
+
+    void handle(EventPtr event) {
+        // Slow down sending such that events queue up.
+        boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+
+        boost::mutex::scoped_lock lock(mutex);
+        if (fail) {
+            throw runtime_error("send failed");
+        }
+        // Like actual connectors, modify the event.
+        event->mutableMetaData().setSendTime((boost::uint64_t) 1);
+        events.push_back(event);
+    }
+
+    boost::mutex mutex;
+    bool fail;
+    vector<EventPtr> events;
+
+};
+
+typedef boost::shared_ptr<RecordingOutConnector> RecordingOutConnectorPtr;
+
+TEST(AsyncEventSendingStrategyTest, testOrderAndFlush)
+{
+
+    RecordingOutConnectorPtr connector(new RecordingOutConnector());
+    AsyncEventSendingStrategy strategy;
+    strategy.addConnector(connector);
+
+    const unsigned int numEvents = 100;
+    for (unsigned int i = 0; i < numEvents; ++i) {
+        EventPtr event(new Event());
+        event->setScope(Scope("/"));
+        event->mutableMetaData().setUserInfo("index",
+                                            boost::lexical_cast<string>(i));
+        strategy.process(event);
+    }
+    strategy.flush();
+
+    boost::mutex::scoped_lock lock(connector->mutex);
+    ASSERT_EQ(numEvents, connector->events.size());
+    for (unsigned int i = 0; i < numEvents; ++i) {
+        EXPECT_EQ(boost::lexical_cast<string>(i),
+                  connector->events[i]->getMetaData().getUserInfo("index"));
+    }
+
+}
+
+TEST(AsyncEventSendingStrategyTest, testCompletion)
+{
+
+    RecordingOutConnectorPtr connector(new RecordingOutConnector());
+    AsyncEventSendingStrategy strategy(10);
+    strategy.addConnector(connector);
+
+    EventPtr event(new Event());
+    event->setScope(Scope("/"));
+    EventSendingStrategy::CompletionFuturePtr future
+        = strategy.processWithCompletion(event);
+    EventPtr sent = future->get(10.0);
+    EXPECT_EQ(*event->getScopePtr(), *sent->getScopePtr());
+    EXPECT_EQ(1u, sent->getMetaData().getSendTime());
+    // The event of the caller is not modified by the connector.
+    EXPECT_EQ(0u, event->getMetaData().getSendTime());
+
+    {
+        boost::mutex::scoped_lock lock(connector->mutex);
+        connector->fail = true;
+    }
+    future = strategy.processWithCompletion(event);
+    EXPECT_ANY_THROW(future->get(10.0));
+
+}
+
+TEST(AsyncEventSendingStrategyTest, testDestructionDeliversQueuedEvents)
+{
+
+    RecordingOutConnectorPtr connector(new RecordingOutConnector());
+    {
+        AsyncEventSendingStrategy strategy;
+        strategy.addConnector(connector);
+        for (unsigned int i = 0; i < 20; ++i) {
+            EventPtr event(new Event());
+            event->setScope(Scope("/"));
+            strategy.process(event);
+        }
+    }
+
+    boost::mutex::scoped_lock lock(connector->mutex);
+    EXPECT_EQ(20u, connector->events.size());
+
+}
@@ -0,0 +1,163 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "rsb/eventprocessing/DirectEventReceivingStrategy.h"
+#include "rsb/filter/ScopeFilter.h"
+#include "rsb/Handler.h"
+#include "rsb/MetaData.h"
+#include "rsb/EventId.h"
+#include "rsb/Scope.h"
+
+using namespace std;
+using namespace rsb;
+using namespace rsb::eventprocessing;
+using namespace rsb::filter;
+
+namespace {
+
+class CountingHandler: public rsb::Handler {
+public:
+    CountingHandler() :
+        count(0) {
+    }
+
+    string getClassName() const {
+        return "CountingHandler";
+    }
+
+    void handle(EventPtr /*event*/) {
+        ++this->count;
+    }
+
+    unsigned int count;
+};
+
+/**
+ * Replaces @a removed with @a added and adds @a filter while
+ * handling the first event.
+ */
+class ModifyingHandler: public rsb::Handler {
+public:
+    ModifyingHandler(DirectEventReceivingStrategy& strategy,
+                     rsb::HandlerPtr               removed,
+                     rsb::HandlerPtr               added,
+                     FilterPtr                     filter = FilterPtr()) :
+        strategy(strategy), removed(removed), added(added), filter(filter),
+        count(0) {
+    }
+
+    string getClassName() const {
+        return "ModifyingHandler";
+    }
+
+    void handle(EventPtr /*event*/) {
+        if (this->count++ == 0) {
+            this->strategy.removeHandler(this->removed, true);
+            this->strategy.addHandler(this->added, true);
+            if (this->filter) {
+                this->strategy.addFilter(this->filter);
+            }
+        }
+    }
+
+    DirectEventReceivingStrategy& strategy;
+    rsb::HandlerPtr               removed;
+    rsb::HandlerPtr               added;
+    FilterPtr                     filter;
+    unsigned int                  count;
+};
+
+EventPtr makeEvent(const Scope& scope) {
+    EventPtr event(new Event);
+    event->setScope(scope);
+    event->setData(boost::shared_ptr<string>(new string("hello")));
+    return event;
+}
+
+}
+
+TEST(DirectEventReceivingStrategyTest, testModifyHandlersDuringDispatch)
+{
+
+    for (int singleThreaded = 0; singleThreaded < 2; ++singleThreaded) {
+        SCOPED_TRACE(singleThreaded ? "single-threaded" : "multi-threaded");
+
+        DirectEventReceivingStrategy strategy(singleThreaded);
+        boost::shared_ptr<CountingHandler> removed(new CountingHandler());
+        boost::shared_ptr<CountingHandler> added(new CountingHandler());
+        boost::shared_ptr<ModifyingHandler> modifier(
+            new ModifyingHandler(strategy, removed, added));
+        strategy.addHandler(modifier, true);
+        strategy.addHandler(removed, true);
+
+        // Modifications during dispatch do not affect the handlers
+        // receiving the current event.
+        strategy.handle(makeEvent(Scope("/foo")));
+        EXPECT_EQ(1u, modifier->count);
+        EXPECT_EQ(1u, removed->count);
+        EXPECT_EQ(0u, added->count);
+
+        strategy.handle(makeEvent(Scope("/foo")));
+        EXPECT_EQ(2u, modifier->count);
+        EXPECT_EQ(1u, removed->count);
+        EXPECT_EQ(1u, added->count);
+    }
+
+}
+
+TEST(DirectEventReceivingStrategyTest, testAddFilterDuringDispatch)
+{
+
+    for (int singleThreaded = 0; singleThreaded < 2; ++singleThreaded) {
+        SCOPED_TRACE(singleThreaded ? "single-threaded" : "multi-threaded");
+
+        DirectEventReceivingStrategy strategy(singleThreaded);
+        boost::shared_ptr<CountingHandler> counter(new CountingHandler());
+        boost::shared_ptr<ModifyingHandler> modifier(
+            new ModifyingHandler(strategy, counter, counter,
+                                 FilterPtr(new ScopeFilter(Scope("/foo")))));
+        strategy.addHandler(modifier, true);
+        strategy.addHandler(counter, true);
+
+        // The filter added while dispatching the first event only
+        // applies to subsequent events.
+        strategy.handle(makeEvent(Scope("/bar")));
+        EXPECT_EQ(1u, counter->count);
+
+        strategy.handle(makeEvent(Scope("/bar")));
+        EXPECT_EQ(1u, modifier->count);
+        EXPECT_EQ(1u, counter->count);
+
+        strategy.handle(makeEvent(Scope("/foo/baz")));
+        EXPECT_EQ(2u, modifier->count);
+        EXPECT_EQ(2u, counter->count);
+    }
+
+}
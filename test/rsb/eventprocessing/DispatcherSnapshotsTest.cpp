@@ -0,0 +1,193 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#include <string>
+
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include <gtest/gtest.h>
+
+#include "rsb/eventprocessing/DispatcherSnapshots.h"
+#include "rsb/eventprocessing/ScopeDispatcher.h"
+
+using namespace std;
+
+using namespace rsb::eventprocessing;
+
+typedef ScopeDispatcher<string>         Dispatcher;
+typedef DispatcherSnapshots<Dispatcher> Snapshots;
+
+namespace {
+
+void dispatchUntilReleased(Snapshots* snapshots, boost::mutex* mutex,
+                           boost::condition* condition, bool* started,
+                           bool* released) {
+    Snapshots::Dispatch dispatch(*snapshots);
+
+    boost::mutex::scoped_lock lock(*mutex);
+    *started = true;
+    condition->notify_all();
+    while (!*released) {
+        condition->wait(lock);
+    }
+}
+
+void waitForDispatches(Snapshots* snapshots, boost::uint64_t generation,
+                       boost::mutex* mutex, boost::condition* condition,
+                       bool* done) {
+    snapshots->waitForDispatches(generation);
+
+    boost::mutex::scoped_lock lock(*mutex);
+    *done = true;
+    condition->notify_all();
+}
+
+}
+
+TEST(DispatcherSnapshotsTest, testSet)
+{
+
+    Snapshots snapshots;
+    EXPECT_TRUE(snapshots.get()->empty());
+
+    boost::shared_ptr<Dispatcher> dispatcher(new Dispatcher());
+    dispatcher->addSink("/foo", "bar");
+    boost::uint64_t generation = snapshots.set(dispatcher);
+    EXPECT_EQ(dispatcher, snapshots.get());
+
+    Snapshots::Dispatch dispatch(snapshots);
+    EXPECT_EQ(1u, dispatch->size());
+
+    // Neither the own dispatch nor dispatches using the new snapshot
+    // are waited for.
+    snapshots.waitForDispatches(generation);
+    snapshots.waitForDispatches(snapshots.set(dispatcher));
+}
+
+TEST(DispatcherSnapshotsTest, testWaitForDispatches)
+{
+
+    Snapshots snapshots;
+    boost::mutex mutex;
+    boost::condition condition;
+    bool started = false;
+    bool released = false;
+    bool done = false;
+
+    boost::thread dispatcher(boost::bind(&dispatchUntilReleased, &snapshots,
+                                         &mutex, &condition, &started, &released));
+    {
+        boost::mutex::scoped_lock lock(mutex);
+        while (!started) {
+            condition.wait(lock);
+        }
+    }
+
+    boost::uint64_t generation
+        = snapshots.set(boost::shared_ptr<Dispatcher>(new Dispatcher()));
+    boost::thread waiter(boost::bind(&waitForDispatches, &snapshots, generation,
+                                     &mutex, &condition, &done));
+
+    // The waiter has to wait for the dispatch using the old snapshot.
+    boost::this_thread::sleep(boost::posix_time::milliseconds(100));
+    {
+        boost::mutex::scoped_lock lock(mutex);
+        EXPECT_FALSE(done);
+        released = true;
+        condition.notify_all();
+    }
+
+    waiter.join();
+    dispatcher.join();
+    EXPECT_TRUE(done);
+}
+
+namespace {
+
+/**
+ * Replaces the snapshot while dispatching, like a handler removing
+ * its sink, once the other thread has started dispatching too.
+ */
+void removeWhileDispatching(Snapshots* snapshots, boost::mutex* mutex,
+                            boost::condition* condition,
+                            unsigned int* started, unsigned int* done) {
+    Snapshots::Dispatch dispatch(*snapshots);
+
+    {
+        boost::mutex::scoped_lock lock(*mutex);
+        ++*started;
+        condition->notify_all();
+        while (*started < 2) {
+            condition->wait(lock);
+        }
+    }
+
+    snapshots->waitForDispatches(
+        snapshots->set(boost::shared_ptr<Dispatcher>(new Dispatcher())));
+
+    boost::mutex::scoped_lock lock(*mutex);
+    ++*done;
+    condition->notify_all();
+}
+
+}
+
+TEST(DispatcherSnapshotsTest, testConcurrentRemovalWhileDispatching)
+{
+
+    Snapshots snapshots;
+    boost::mutex mutex;
+    boost::condition condition;
+    unsigned int started = 0;
+    unsigned int done = 0;
+
+    // Each thread waits for the dispatch of the other thread, which
+    // is itself waiting. Neither must block forever.
+    boost::thread first(boost::bind(&removeWhileDispatching, &snapshots,
+                                    &mutex, &condition, &started, &done));
+    boost::thread second(boost::bind(&removeWhileDispatching, &snapshots,
+                                     &mutex, &condition, &started, &done));
+
+    {
+        boost::mutex::scoped_lock lock(mutex);
+        while (done < 2) {
+            if (!condition.timed_wait(lock, boost::posix_time::seconds(10))) {
+                break;
+            }
+        }
+        EXPECT_EQ(2u, done);
+    }
+
+    if (done == 2) {
+        first.join();
+        second.join();
+    } else {
+        first.detach();
+        second.detach();
+    }
+}
@@ -0,0 +1,185 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#include <stdexcept>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+
+#include <gtest/gtest.h>
+
+#include "rsb/eventprocessing/EventQueue.h"
+#include "rsb/Scope.h"
+
+using namespace std;
+
+using namespace rsb;
+using namespace rsb::eventprocessing;
+
+EventPtr makeEvent(const string& scope, unsigned int number) {
+    EventPtr event(new Event);
+    event->setScope(Scope(scope));
+    event->setData(boost::shared_ptr<unsigned int>(new unsigned int(number)));
+    return event;
+}
+
+unsigned int numberOf(EventPtr event) {
+    return *boost::static_pointer_cast<unsigned int>(event->getData());
+}
+
+TEST(EventQueueTest, testParseOverflowPolicy)
+{
+
+    EXPECT_EQ(EventQueue::OVERFLOW_BLOCK,
+              EventQueue::parseOverflowPolicy("block"));
+    EXPECT_EQ(EventQueue::OVERFLOW_DROP_OLDEST,
+              EventQueue::parseOverflowPolicy("drop-oldest"));
+    EXPECT_EQ(EventQueue::OVERFLOW_DROP_NEWEST,
+              EventQueue::parseOverflowPolicy("drop-newest"));
+    EXPECT_EQ(EventQueue::OVERFLOW_KEEP_LATEST_PER_SCOPE,
+              EventQueue::parseOverflowPolicy("keep-latest-per-scope"));
+    EXPECT_THROW(EventQueue::parseOverflowPolicy("no-such-policy"),
+                 invalid_argument);
+
+}
+
+TEST(EventQueueTest, testUnbounded)
+{
+
+    EventQueue queue;
+    for (unsigned int i = 0; i < 100; ++i) {
+        EXPECT_TRUE(queue.push(makeEvent("/a", i)));
+    }
+    EXPECT_EQ(100u, queue.size());
+    for (unsigned int i = 0; i < 100; ++i) {
+        EXPECT_EQ(i, numberOf(queue.tryPop()));
+    }
+    EXPECT_FALSE(queue.tryPop());
+    EXPECT_EQ(0u, queue.getDroppedCount());
+
+}
+
+TEST(EventQueueTest, testDropOldest)
+{
+
+    EventQueue queue(2, EventQueue::OVERFLOW_DROP_OLDEST);
+    EXPECT_TRUE(queue.push(makeEvent("/a", 1)));
+    EXPECT_TRUE(queue.push(makeEvent("/a", 2)));
+    EXPECT_TRUE(queue.push(makeEvent("/a", 3)));
+    EXPECT_EQ(2u, queue.size());
+    EXPECT_EQ(1u, queue.getDroppedCount());
+    EXPECT_EQ(2u, numberOf(queue.tryPop()));
+    EXPECT_EQ(3u, numberOf(queue.tryPop()));
+
+}
+
+TEST(EventQueueTest, testDropNewest)
+{
+
+    EventQueue queue(2, EventQueue::OVERFLOW_DROP_NEWEST);
+    EXPECT_TRUE(queue.push(makeEvent("/a", 1)));
+    EXPECT_TRUE(queue.push(makeEvent("/a", 2)));
+    EXPECT_FALSE(queue.push(makeEvent("/a", 3)));
+    EXPECT_EQ(2u, queue.size());
+    EXPECT_EQ(1u, queue.getDroppedCount());
+    EXPECT_EQ(1u, numberOf(queue.tryPop()));
+    EXPECT_EQ(2u, numberOf(queue.tryPop()));
+
+}
+
+TEST(EventQueueTest, testKeepLatestPerScope)
+{
+
+    EventQueue queue(2, EventQueue::OVERFLOW_KEEP_LATEST_PER_SCOPE);
+    EXPECT_TRUE(queue.push(makeEvent("/a", 1)));
+    EXPECT_TRUE(queue.push(makeEvent("/b", 2)));
+    EXPECT_TRUE(queue.push(makeEvent("/a", 3)));
+    EXPECT_EQ(2u, queue.size());
+    EXPECT_EQ(1u, queue.getDroppedCount());
+    // The newer event on /a replaces the older one in place.
+    EXPECT_EQ(3u, numberOf(queue.tryPop()));
+    EXPECT_EQ(2u, numberOf(queue.tryPop()));
+
+    // Distinct scopes exceeding the capacity evict the oldest event.
+    EXPECT_TRUE(queue.push(makeEvent("/a", 4)));
+    EXPECT_TRUE(queue.push(makeEvent("/b", 5)));
+    EXPECT_TRUE(queue.push(makeEvent("/c", 6)));
+    EXPECT_EQ(2u, queue.getDroppedCount());
+    EXPECT_EQ(5u, numberOf(queue.tryPop()));
+    EXPECT_EQ(6u, numberOf(queue.tryPop()));
+
+    // Replacement still finds queued events after others have been
+    // removed.
+    EXPECT_TRUE(queue.push(makeEvent("/a", 7)));
+    EXPECT_TRUE(queue.push(makeEvent("/b", 8)));
+    EXPECT_EQ(7u, numberOf(queue.tryPop()));
+    EXPECT_TRUE(queue.push(makeEvent("/a", 9)));
+    EXPECT_TRUE(queue.push(makeEvent("/b", 10)));
+    EXPECT_TRUE(queue.push(makeEvent("/a", 11)));
+    EXPECT_EQ(2u, queue.size());
+    EXPECT_EQ(4u, queue.getDroppedCount());
+    EXPECT_EQ(10u, numberOf(queue.tryPop()));
+    EXPECT_EQ(11u, numberOf(queue.tryPop()));
+    EXPECT_FALSE(queue.tryPop());
+
+}
+
+void pushEvent(EventQueue& queue, unsigned int number) {
+    queue.push(makeEvent("/a", number));
+}
+
+TEST(EventQueueTest, testBlock)
+{
+
+    EventQueue queue(1, EventQueue::OVERFLOW_BLOCK);
+    EXPECT_TRUE(queue.push(makeEvent("/a", 1)));
+
+    boost::thread pusher(boost::bind(&pushEvent, boost::ref(queue), 2));
+    boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+    EXPECT_EQ(1u, queue.size());
+
+    EXPECT_EQ(1u, numberOf(queue.pop()));
+    EXPECT_EQ(2u, numberOf(queue.pop()));
+    pusher.join();
+    EXPECT_EQ(0u, queue.getDroppedCount());
+
+}
+
+TEST(EventQueueTest, testClose)
+{
+
+    EventQueue queue(1, EventQueue::OVERFLOW_BLOCK);
+    EXPECT_TRUE(queue.push(makeEvent("/a", 1)));
+
+    boost::thread pusher(boost::bind(&pushEvent, boost::ref(queue), 2));
+    boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+    queue.close();
+    pusher.join();
+
+    EXPECT_FALSE(queue.pop());
+    EXPECT_FALSE(queue.push(makeEvent("/a", 3)));
+
+}
@@ -25,6 +25,8 @@
  * ============================================================ */
 
 #include <string>
+#include <map>
+#include <stdexcept>
 
 #include <rsc/misc/UUID.h>
 #include <rsc/threading/SynchronizedQueue.h>
@@ -33,12 +35,16 @@
 #include <gmock/gmock.h>
 
 #include <boost/thread.hpp>
+#include <boost/thread/condition.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/bind.hpp>
 
 #include <rsc/misc/langutils.h>
 
 #include "rsb/eventprocessing/ParallelEventReceivingStrategy.h"
 #include "rsb/util/QueuePushHandler.h"
 #include "rsb/filter/ScopeFilter.h"
+#include "rsb/Handler.h"
 #include "rsb/MetaData.h"
 #include "rsb/EventId.h"
 #include "rsb/Scope.h"
@@ -224,3 +230,355 @@ TEST(ParallelEventReceivingStrategyTest, testHandlerErrorStrategyCatchAll)
     boost::this_thread::sleep(boost::posix_time::milliseconds(100));
 
 }
+
+class OrderRecordingHandler: public rsb::Handler {
+public:
+
+    string getClassName() const {
+        return "OrderRecordingHandler";
+    }
+
+    void handle(EventPtr event) {
+        boost::mutex::scoped_lock lock(mutex);
+        numbers.push_back(*boost::static_pointer_cast<unsigned int>(event->getData()));
+        condition.notify_all();
+    }
+
+    void waitForEvents(unsigned int count) {
+        boost::mutex::scoped_lock lock(mutex);
+        while (numbers.size() < count) {
+            if (!condition.timed_wait(lock, boost::posix_time::seconds(10))) {
+                return;
+            }
+        }
+    }
+
+    boost::mutex mutex;
+    boost::condition condition;
+    vector<unsigned int> numbers;
+
+};
+
+TEST(ParallelEventReceivingStrategyTest, testOrderingWithSharedExecutor)
+{
+
+    // Both strategies submit to the same executor which is run by
+    // multiple threads. The order of events has to be preserved per
+    // handler nonetheless.
+    ParallelEventReceivingStrategy processor1(4);
+    ParallelEventReceivingStrategy processor2(2);
+
+    const unsigned int numEvents = 1000;
+    boost::shared_ptr<OrderRecordingHandler> handlers[3] = {
+        boost::shared_ptr<OrderRecordingHandler>(new OrderRecordingHandler()),
+        boost::shared_ptr<OrderRecordingHandler>(new OrderRecordingHandler()),
+        boost::shared_ptr<OrderRecordingHandler>(new OrderRecordingHandler())
+    };
+    processor1.addHandler(handlers[0], true);
+    processor1.addHandler(handlers[1], true);
+    processor2.addHandler(handlers[2], true);
+
+    for (unsigned int i = 0; i < numEvents; ++i) {
+        EventPtr event(new Event);
+        event->setScope(Scope("/"));
+        event->setData(boost::shared_ptr<unsigned int>(new unsigned int(i)));
+        processor1.handle(event);
+        processor2.handle(event);
+    }
+
+    for (unsigned int i = 0; i < 3; ++i) {
+        handlers[i]->waitForEvents(numEvents);
+        boost::mutex::scoped_lock lock(handlers[i]->mutex);
+        ASSERT_EQ(numEvents, handlers[i]->numbers.size());
+        for (unsigned int j = 0; j < numEvents; ++j) {
+            EXPECT_EQ(j, handlers[i]->numbers[j]);
+        }
+    }
+
+    processor1.removeHandler(handlers[0], true);
+    processor1.removeHandler(handlers[1], true);
+    processor2.removeHandler(handlers[2], true);
+
+}
+
+class KeyOrderRecordingHandler: public rsb::Handler {
+public:
+
+    string getClassName() const {
+        return "KeyOrderRecordingHandler";
+    }
+
+    void handle(EventPtr event) {
+        boost::mutex::scoped_lock lock(mutex);
+        numbers[event->getMetaData().getUserInfo("robot")].push_back(
+            *boost::static_pointer_cast<unsigned int>(event->getData()));
+        ++count;
+        condition.notify_all();
+    }
+
+    void waitForEvents(unsigned int expected) {
+        boost::mutex::scoped_lock lock(mutex);
+        while (count < expected) {
+            if (!condition.timed_wait(lock, boost::posix_time::seconds(10))) {
+                return;
+            }
+        }
+    }
+
+    boost::mutex mutex;
+    boost::condition condition;
+    unsigned int count;
+    map<string, vector<unsigned int> > numbers;
+
+};
+
+TEST(ParallelEventReceivingStrategyTest, testPartitionedOrdering)
+{
+
+    ParallelEventReceivingStrategy processor(4, false, 0,
+                                             EventQueue::OVERFLOW_BLOCK,
+                                             "user-info:robot", 8);
+
+    const unsigned int numRobots = 50;
+    const unsigned int numEvents = 100;
+    boost::shared_ptr<KeyOrderRecordingHandler> handler(new KeyOrderRecordingHandler());
+    handler->count = 0;
+    processor.addHandler(handler, true);
+
+    for (unsigned int i = 0; i < numEvents; ++i) {
+        for (unsigned int robot = 0; robot < numRobots; ++robot) {
+            EventPtr event(new Event);
+            event->setScope(Scope("/robots"));
+            event->mutableMetaData().setUserInfo(
+                "robot", boost::lexical_cast<string>(robot));
+            event->setData(boost::shared_ptr<unsigned int>(new unsigned int(i)));
+            processor.handle(event);
+        }
+    }
+
+    handler->waitForEvents(numRobots * numEvents);
+    boost::mutex::scoped_lock lock(handler->mutex);
+    ASSERT_EQ(numRobots, handler->numbers.size());
+    for (map<string, vector<unsigned int> >::const_iterator it
+             = handler->numbers.begin(); it != handler->numbers.end(); ++it) {
+        ASSERT_EQ(numEvents, it->second.size());
+        for (unsigned int i = 0; i < numEvents; ++i) {
+            EXPECT_EQ(i, it->second[i]);
+        }
+    }
+    lock.unlock();
+
+    processor.removeHandler(handler, true);
+
+}
+
+TEST(ParallelEventReceivingStrategyTest, testInvalidPartitionKey)
+{
+
+    EXPECT_THROW(ParallelEventReceivingStrategy(1, false, 0,
+                                                EventQueue::OVERFLOW_BLOCK,
+                                                "no-such-key"),
+                 invalid_argument);
+    EXPECT_THROW(ParallelEventReceivingStrategy(1, true, 0,
+                                                EventQueue::OVERFLOW_BLOCK,
+                                                "scope"),
+                 invalid_argument);
+
+}
+
+class RecordingBatchHandler: public rsb::BatchHandler {
+public:
+
+    RecordingBatchHandler(unsigned int maxBatchSize, unsigned int maxDelay) :
+        BatchHandler(maxBatchSize, maxDelay), count(0) {
+    }
+
+    void handleBatch(const EventBatch& events) {
+        boost::mutex::scoped_lock lock(mutex);
+        batchSizes.push_back(events.size());
+        for (EventBatch::const_iterator it = events.begin();
+             it != events.end(); ++it) {
+            numbers.push_back(*boost::static_pointer_cast<unsigned int>((*it)->getData()));
+        }
+        count += events.size();
+        condition.notify_all();
+    }
+
+    void waitForEvents(unsigned int expected) {
+        boost::mutex::scoped_lock lock(mutex);
+        while (count < expected) {
+            if (!condition.timed_wait(lock, boost::posix_time::seconds(10))) {
+                return;
+            }
+        }
+    }
+
+    boost::mutex mutex;
+    boost::condition condition;
+    unsigned int count;
+    vector<unsigned int> batchSizes;
+    vector<unsigned int> numbers;
+
+};
+
+TEST(ParallelEventReceivingStrategyTest, testBatchHandler)
+{
+
+    ParallelEventReceivingStrategy processor(2);
+
+    const unsigned int numEvents = 25;
+    boost::shared_ptr<RecordingBatchHandler> handler(new RecordingBatchHandler(10, 50));
+    processor.addHandler(handler, true);
+
+    for (unsigned int i = 0; i < numEvents; ++i) {
+        EventPtr event(new Event);
+        event->setScope(Scope("/"));
+        event->setData(boost::shared_ptr<unsigned int>(new unsigned int(i)));
+        processor.handle(event);
+    }
+
+    // The last, incomplete batch is delivered after the delay.
+    handler->waitForEvents(numEvents);
+    boost::mutex::scoped_lock lock(handler->mutex);
+    ASSERT_EQ(numEvents, handler->numbers.size());
+    for (unsigned int i = 0; i < numEvents; ++i) {
+        EXPECT_EQ(i, handler->numbers[i]);
+    }
+    EXPECT_LT(handler->batchSizes.size(), numEvents);
+    for (vector<unsigned int>::const_iterator it = handler->batchSizes.begin();
+         it != handler->batchSizes.end(); ++it) {
+        EXPECT_LE(*it, 10u);
+    }
+    lock.unlock();
+
+    processor.removeHandler(handler, true);
+
+}
+
+TEST(ParallelEventReceivingStrategyTest, testDestructionWithQueuedEvents)
+{
+
+    // Calls and batch timers which are still queued in the shared
+    // executor when the strategies are destroyed must not use them.
+    for (unsigned int i = 0; i < 20; ++i) {
+        ParallelEventReceivingStrategy processor(2);
+        processor.addHandler(rsb::HandlerPtr(new OrderRecordingHandler()), true);
+        processor.addHandler(rsb::HandlerPtr(new RecordingBatchHandler(10, 5)), true);
+
+        for (unsigned int j = 0; j < 105; ++j) {
+            EventPtr event(new Event);
+            event->setScope(Scope("/"));
+            event->setData(boost::shared_ptr<unsigned int>(new unsigned int(j)));
+            processor.handle(event);
+        }
+    }
+
+    boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+
+}
+
+/**
+ * Passes each received event on to another strategy and blocks until
+ * a handler of that strategy has received it, like a handler making
+ * a synchronous call.
+ */
+class NestedCallHandler: public rsb::Handler {
+public:
+
+    NestedCallHandler(ParallelEventReceivingStrategy& inner) :
+        inner(inner), received(false), completed(0) {
+    }
+
+    string getClassName() const {
+        return "NestedCallHandler";
+    }
+
+    void handle(EventPtr event) {
+        inner.handle(event);
+
+        boost::mutex::scoped_lock lock(mutex);
+        while (!received) {
+            if (!condition.timed_wait(lock, boost::posix_time::seconds(5))) {
+                return;
+            }
+        }
+        received = false;
+        ++completed;
+        condition.notify_all();
+    }
+
+    void handleInner(EventPtr /*event*/) {
+        boost::mutex::scoped_lock lock(mutex);
+        received = true;
+        condition.notify_all();
+    }
+
+    bool waitForCompleted(unsigned int expected) {
+        boost::mutex::scoped_lock lock(mutex);
+        while (completed < expected) {
+            if (!condition.timed_wait(lock, boost::posix_time::seconds(10))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    ParallelEventReceivingStrategy& inner;
+    boost::mutex mutex;
+    boost::condition condition;
+    bool received;
+    unsigned int completed;
+
+};
+
+void testNestedCalls(ParallelEventReceivingStrategy& outer,
+                     ParallelEventReceivingStrategy& inner) {
+    boost::shared_ptr<NestedCallHandler> handler(new NestedCallHandler(inner));
+    rsb::HandlerPtr innerHandler(new EventFunctionHandler(
+            boost::bind(&NestedCallHandler::handleInner, handler.get(), _1)));
+    outer.addHandler(handler, true);
+    inner.addHandler(innerHandler, true);
+
+    const unsigned int numEvents = 3;
+    for (unsigned int i = 0; i < numEvents; ++i) {
+        EventPtr event(new Event);
+        event->setScope(Scope("/"));
+        outer.handle(event);
+    }
+    EXPECT_TRUE(handler->waitForCompleted(numEvents));
+
+    outer.removeHandler(handler, true);
+    inner.removeHandler(innerHandler, true);
+}
+
+TEST(ParallelEventReceivingStrategyTest, testBlockingHandlerWithPrivateExecutor)
+{
+
+    // A single thread of the shared executor is blocked by the outer
+    // handler. The inner strategy can only make progress using its
+    // private executor.
+    ParallelEventReceivingStrategy outer(1, false, 0, EventQueue::OVERFLOW_BLOCK,
+                                         "", 0, "nested-test-private");
+    ParallelEventReceivingStrategy inner(1, false, 0, EventQueue::OVERFLOW_BLOCK,
+                                         "", 0, "private");
+    testNestedCalls(outer, inner);
+
+}
+
+TEST(ParallelEventReceivingStrategyTest, testBlockingHandlerWithConfiguredExecutorThreads)
+{
+
+    // Both strategies request a single thread, but the configured
+    // size of shared executors leaves a thread for the inner
+    // strategy.
+    ParallelEventReceivingStrategy::setExecutorThreads(2);
+    {
+        ParallelEventReceivingStrategy outer(1, false, 0, EventQueue::OVERFLOW_BLOCK,
+                                             "", 0, "nested-test-shared");
+        ParallelEventReceivingStrategy inner(1, false, 0, EventQueue::OVERFLOW_BLOCK,
+                                             "", 0, "nested-test-shared");
+        testNestedCalls(outer, inner);
+    }
+    ParallelEventReceivingStrategy::setExecutorThreads(0);
+
+}
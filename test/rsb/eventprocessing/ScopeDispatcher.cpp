@@ -167,3 +167,75 @@ TEST(WeakScopeDispatcherTest, testMapSinks)
     EXPECT_EQ(lambda.calls.size(), 1);
     EXPECT_EQ(lambda.calls[0], "bar");
     }*/
+
+namespace {
+
+struct RecordingFunction {
+    std::vector<std::string>* calls;
+    void operator()(const std::string& sink) const {
+        this->calls->push_back(sink);
+    }
+};
+
+}
+
+TEST(ScopeDispatcherTest, testMapSinksSuperScopes)
+{
+    ScopeDispatcher<std::string> dispatcher;
+    dispatcher.addSink("/",        "root");
+    dispatcher.addSink("/foo",     "bar");
+    dispatcher.addSink("/foo/fez", "baz");
+    dispatcher.addSink("/whoop",   "di");
+
+    std::vector<std::string> calls;
+    RecordingFunction function;
+    function.calls = &calls;
+
+    dispatcher.mapSinks("/foo/fez/bla", function);
+    ASSERT_EQ(3u, calls.size());
+    EXPECT_EQ("root", calls[0]);
+    EXPECT_EQ("bar", calls[1]);
+    EXPECT_EQ("baz", calls[2]);
+
+    calls.clear();
+    dispatcher.mapSinks("/fo", function);
+    ASSERT_EQ(1u, calls.size());
+    EXPECT_EQ("root", calls[0]);
+
+    // Removing the sink of an inner scope must retain the sinks of
+    // its sub-scopes.
+    dispatcher.removeSink("/foo", "bar");
+    EXPECT_EQ(3u, dispatcher.size());
+    calls.clear();
+    dispatcher.mapSinks("/foo/fez", function);
+    ASSERT_EQ(2u, calls.size());
+    EXPECT_EQ("baz", calls[1]);
+
+    dispatcher.removeSink("/foo/fez", "baz");
+    EXPECT_EQ(2u, dispatcher.size());
+    EXPECT_EQ(2u, dispatcher.getScopes().size());
+    EXPECT_THROW(dispatcher.removeSink("/foo", "bar"), std::logic_error);
+}
+
+TEST(ScopeDispatcherTest, testCopy)
+{
+    ScopeDispatcher<std::string> dispatcher;
+    dispatcher.addSink("/foo/bar", "baz");
+
+    ScopeDispatcher<std::string> copy(dispatcher);
+    copy.addSink("/foo/bar", "fez");
+    copy.removeSink("/foo/bar", "baz");
+
+    std::vector<std::string> calls;
+    RecordingFunction function;
+    function.calls = &calls;
+
+    dispatcher.mapSinks("/foo/bar", function);
+    ASSERT_EQ(1u, calls.size());
+    EXPECT_EQ("baz", calls[0]);
+
+    calls.clear();
+    copy.mapSinks("/foo/bar", function);
+    ASSERT_EQ(1u, calls.size());
+    EXPECT_EQ("fez", calls[0]);
+}
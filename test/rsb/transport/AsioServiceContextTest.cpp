@@ -0,0 +1,145 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/thread/condition.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <gtest/gtest.h>
+
+#include "rsb/transport/AsioServiceContext.h"
+
+using namespace std;
+
+using namespace rsb::transport;
+
+namespace {
+
+/**
+ * Counts handlers which are running at the same time.
+ */
+struct Rendezvous {
+    Rendezvous() :
+        running(0), maxRunning(0), completed(0) {
+    }
+
+    // Waits for @a expected handlers to run concurrently, but not
+    // forever.
+    void meet(unsigned int expected) {
+        boost::mutex::scoped_lock lock(this->mutex);
+        ++this->running;
+        this->maxRunning = max(this->maxRunning, this->running);
+        this->condition.notify_all();
+        while (this->running < expected) {
+            if (!this->condition.timed_wait(lock, boost::posix_time::seconds(10))) {
+                break;
+            }
+        }
+        ++this->completed;
+        this->condition.notify_all();
+    }
+
+    void enter(vector<unsigned int>* order, unsigned int index) {
+        {
+            boost::mutex::scoped_lock lock(this->mutex);
+            this->maxRunning = max(this->maxRunning, ++this->running);
+        }
+        boost::this_thread::yield();
+        {
+            boost::mutex::scoped_lock lock(this->mutex);
+            order->push_back(index);
+            --this->running;
+            ++this->completed;
+            this->condition.notify_all();
+        }
+    }
+
+    bool waitForCompleted(unsigned int expected) {
+        boost::mutex::scoped_lock lock(this->mutex);
+        while (this->completed < expected) {
+            if (!this->condition.timed_wait(lock, boost::posix_time::seconds(10))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    boost::mutex     mutex;
+    boost::condition condition;
+    unsigned int     running;
+    unsigned int     maxRunning;
+    unsigned int     completed;
+};
+
+}
+
+TEST(AsioServiceContextTest, testEnsureThreads)
+{
+    AsioServiceContext context;
+    EXPECT_EQ(1u, context.getThreads());
+
+    context.ensureThreads(3);
+    EXPECT_EQ(3u, context.getThreads());
+
+    // Threads are never stopped.
+    context.ensureThreads(2);
+    EXPECT_EQ(3u, context.getThreads());
+}
+
+TEST(AsioServiceContextTest, testConcurrentHandlers)
+{
+    AsioServiceContext context(2);
+    Rendezvous rendezvous;
+
+    // Both handlers only complete quickly if they run concurrently.
+    for (unsigned int i = 0; i < 2; ++i) {
+        context.getService()->post(boost::bind(&Rendezvous::meet, &rendezvous, 2));
+    }
+    ASSERT_TRUE(rendezvous.waitForCompleted(2));
+    EXPECT_EQ(2u, rendezvous.maxRunning);
+}
+
+TEST(AsioServiceContextTest, testStrandOrdering)
+{
+    AsioServiceContext context(4);
+    boost::asio::io_service::strand strand(*context.getService());
+    Rendezvous rendezvous;
+    vector<unsigned int> order;
+
+    // Handlers dispatched via a strand neither run concurrently nor
+    // out of order, like the handlers of a socket connection.
+    const unsigned int count = 1000;
+    for (unsigned int i = 0; i < count; ++i) {
+        strand.post(boost::bind(&Rendezvous::enter, &rendezvous, &order, i));
+    }
+    ASSERT_TRUE(rendezvous.waitForCompleted(count));
+    EXPECT_EQ(1u, rendezvous.maxRunning);
+    for (unsigned int i = 0; i < count; ++i) {
+        EXPECT_EQ(i, order[i]);
+    }
+}
@@ -0,0 +1,187 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#include <string>
+#include <vector>
+
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include <gtest/gtest.h>
+
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
+
+#include "rsb/transport/shm/Ring.h"
+
+using namespace std;
+using namespace rsb::transport::shm;
+
+namespace {
+
+bool storeFrame(string* result, const char* frame, size_t size) {
+    result->assign(frame, size);
+    return true;
+}
+
+class RingTest: public ::testing::Test {
+protected:
+    RingTest() :
+        name("rsb-ringtest-" + boost::lexical_cast<string>(getpid())) {
+    }
+
+    virtual void SetUp() {
+        Ring::remove(this->name);
+    }
+
+    virtual void TearDown() {
+        Ring::remove(this->name);
+    }
+
+    bool read(Ring& ring, boost::uint64_t& position, string& frame,
+              unsigned int timeoutMillis = 0) {
+        return ring.read(position, boost::bind(&storeFrame, &frame, _1, _2),
+                         timeoutMillis);
+    }
+
+    string name;
+};
+
+void writeDelayed(Ring* ring, string frame) {
+    boost::this_thread::sleep(boost::posix_time::milliseconds(100));
+    ring->write(frame.data(), frame.size());
+}
+
+}
+
+TEST_F(RingTest, testRoundtripWithWrapAround) {
+    Ring writer(this->name, 1024);
+    Ring reader(this->name, 0);
+    boost::uint64_t position = reader.getWritePosition();
+
+    for (unsigned int i = 0; i < 100; ++i) {
+        string frame(1 + (i * 37) % 500, char('a' + i % 26));
+        writer.write(frame.data(), frame.size());
+
+        string received;
+        ASSERT_TRUE(read(reader, position, received));
+        EXPECT_EQ(frame, received);
+        EXPECT_EQ(writer.getWritePosition(), position);
+    }
+
+    string received;
+    EXPECT_FALSE(read(reader, position, received, 10));
+}
+
+TEST_F(RingTest, testFrameTooLarge) {
+    Ring ring(this->name, 1024);
+    string frame(1024, 'x');
+    EXPECT_THROW(ring.write(frame.data(), frame.size()), std::invalid_argument);
+}
+
+TEST_F(RingTest, testReaderFallsBehind) {
+    Ring ring(this->name, 1024);
+    boost::uint64_t position = ring.getWritePosition();
+
+    string frame(300, 'x');
+    for (unsigned int i = 0; i < 10; ++i) {
+        ring.write(frame.data(), frame.size());
+    }
+
+    // The overwritten frames are skipped.
+    string received;
+    EXPECT_FALSE(read(ring, position, received));
+    EXPECT_EQ(ring.getWritePosition(), position);
+
+    frame = "after";
+    ring.write(frame.data(), frame.size());
+    ASSERT_TRUE(read(ring, position, received));
+    EXPECT_EQ(frame, received);
+}
+
+TEST_F(RingTest, testWakeUp) {
+    Ring ring(this->name, 1024);
+    boost::uint64_t position = ring.getWritePosition();
+
+    boost::thread writer(boost::bind(&writeDelayed, &ring, string("frame")));
+    string received;
+    EXPECT_TRUE(read(ring, position, received, 10000));
+    EXPECT_EQ("frame", received);
+    writer.join();
+}
+
+TEST_F(RingTest, testReplaceStaleSegment) {
+    // Simulate a process which died while creating the segment.
+    int fd = shm_open(("/" + this->name).c_str(), O_RDWR | O_CREAT, 0666);
+    ASSERT_NE(-1, fd);
+    ASSERT_EQ(0, ftruncate(fd, 4096));
+    close(fd);
+
+    Ring ring(this->name, 1024);
+    boost::uint64_t position = ring.getWritePosition();
+    string frame = "frame";
+    ring.write(frame.data(), frame.size());
+    string received;
+    ASSERT_TRUE(read(ring, position, received));
+    EXPECT_EQ(frame, received);
+}
+
+TEST_F(RingTest, testWriterDiesWhileWriting) {
+    Ring ring(this->name, 64 * 1024);
+    boost::uint64_t position = ring.getWritePosition();
+
+    pid_t child = fork();
+    ASSERT_NE(-1, child);
+    if (child == 0) {
+        // Crash while copying a frame whose second half is not
+        // readable, i.e. while holding the write lock.
+        const size_t pageSize = sysconf(_SC_PAGESIZE);
+        char* frame = static_cast<char*>(mmap(0, 2 * pageSize,
+                                              PROT_READ | PROT_WRITE,
+                                              MAP_PRIVATE | MAP_ANONYMOUS,
+                                              -1, 0));
+        mprotect(frame + pageSize, pageSize, PROT_NONE);
+        Ring childRing(this->name, 0);
+        childRing.write(frame, 2 * pageSize);
+        _exit(0);
+    }
+    int status;
+    ASSERT_EQ(child, waitpid(child, &status, 0));
+    ASSERT_TRUE(WIFSIGNALED(status));
+
+    // The partially written frame is discarded and the ring remains
+    // usable.
+    string frame = "frame";
+    ring.write(frame.data(), frame.size());
+    string received;
+    ASSERT_TRUE(read(ring, position, received));
+    EXPECT_EQ(frame, received);
+}
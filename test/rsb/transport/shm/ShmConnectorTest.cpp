@@ -0,0 +1,94 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringe <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <boost/lexical_cast.hpp>
+
+#include "rsb/converter/Repository.h"
+
+#include "rsb/transport/shm/InConnector.h"
+#include "rsb/transport/shm/OutConnector.h"
+#include "rsb/transport/shm/Ring.h"
+
+#include "testconfig.h"
+#include "../ConnectorTest.h"
+
+using namespace std;
+using namespace testing;
+using namespace rsb::converter;
+
+static int dummy
+#if defined(__GNUC__)
+__attribute__((used))
+#endif
+= pullInConnectorTest();
+
+// Large enough to hold all events of the roundtrip tests so that
+// slow receivers do not lose events.
+static const size_t RING_CAPACITY = 64 * 1024 * 1024;
+
+string ringName() {
+    return "rsb-test-" + boost::lexical_cast<string>(SOCKET_PORT);
+}
+
+// Removes the shared memory segment of the tests, including a stale
+// one left behind by an earlier run.
+class RingEnvironment: public ::testing::Environment {
+public:
+    virtual void SetUp() {
+        rsb::transport::shm::Ring::remove(ringName());
+    }
+
+    virtual void TearDown() {
+        rsb::transport::shm::Ring::remove(ringName());
+    }
+};
+
+static ::testing::Environment* const ringEnvironment
+    = ::testing::AddGlobalTestEnvironment(new RingEnvironment());
+
+rsb::transport::InConnectorPtr createShmInConnector() {
+    return rsb::transport::InConnectorPtr(
+            new rsb::transport::shm::InConnector(
+                    converterRepository<string>()->getConvertersForDeserialization(),
+                    ringName(), RING_CAPACITY));
+}
+
+rsb::transport::OutConnectorPtr createShmOutConnector() {
+    return rsb::transport::OutConnectorPtr(
+            new rsb::transport::shm::OutConnector(
+                    converterRepository<string>()->getConvertersForSerialization(),
+                    ringName(), RING_CAPACITY));
+}
+
+const ConnectorTestSetup shmSetup(createShmInConnector,
+                                  createShmOutConnector);
+
+INSTANTIATE_TEST_CASE_P(ShmConnector, ConnectorTest,
+        ::testing::Values(shmSetup));
@@ -0,0 +1,479 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#include <sys/socket.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/condition.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/weak_ptr.hpp>
+
+#include <gtest/gtest.h>
+
+#include "rsb/Event.h"
+#include "rsb/EventId.h"
+#include "rsb/transport/AsioServiceContext.h"
+#include "rsb/transport/socket/Bus.h"
+#include "rsb/transport/socket/BusConnection.h"
+#include "rsb/transport/socket/ReceivedFrame.h"
+#include "rsb/transport/socket/Serialization.h"
+#include "rsb/transport/socket/WireFormat.h"
+
+using namespace std;
+using namespace rsb;
+using namespace rsb::transport;
+using namespace rsb::transport::socket;
+
+namespace {
+
+/**
+ * A bus which records the frames received by its connections.
+ */
+class RecordingBus: public Bus {
+public:
+
+    RecordingBus() :
+        removed(false) {
+    }
+
+    void addSink(InConnectorPtr /*sink*/) {
+    }
+
+    void removeSink(const InConnector* /*sink*/) {
+    }
+
+    void addConnection(BusConnectionPtr /*connection*/) {
+    }
+
+    void removeConnection(BusConnectionPtr /*connection*/) {
+        boost::mutex::scoped_lock lock(this->mutex);
+        this->removed = true;
+        this->condition.notify_all();
+    }
+
+    const BusOptions& getOptions() const {
+        return this->options;
+    }
+
+    void handle(EventPtr /*event*/) {
+    }
+
+    void handleOutgoing(OutgoingEvent& /*event*/) {
+    }
+
+    void handleIncoming(ReceivedFrame&   frame,
+                        BusConnectionPtr /*connection*/) {
+        boost::mutex::scoped_lock lock(this->mutex);
+        this->frames.push_back(*frame.getFrame());
+        this->condition.notify_all();
+    }
+
+    const string getTransportURL() const {
+        return "recording:";
+    }
+
+    bool waitForRemoval() {
+        boost::mutex::scoped_lock lock(this->mutex);
+        while (!this->removed) {
+            if (!this->condition.timed_wait(lock, boost::posix_time::seconds(10))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool waitForFrames(size_t count) {
+        boost::mutex::scoped_lock lock(this->mutex);
+        while (this->frames.size() < count) {
+            if (!this->condition.timed_wait(lock, boost::posix_time::seconds(10))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    BusOptions       options;
+    boost::mutex     mutex;
+    boost::condition condition;
+    vector<string>   frames;
+    bool             removed;
+
+};
+
+typedef boost::shared_ptr<RecordingBus> RecordingBusPtr;
+
+FramePtr makeFrame(const Scope& scope, const string& data = "") {
+    EventPtr event(new Event(scope, boost::shared_ptr<string>(new string(data)),
+                             "bytes"));
+    event->setId(rsc::misc::UUID(), 0);
+    return eventToFrame(event, "bytes", data);
+}
+
+void sendFrames(BusConnectionPtr connection, vector<FramePtr>* frames) {
+    for (vector<FramePtr>::const_iterator it = frames->begin();
+         it != frames->end(); ++it) {
+        connection->sendFrame(*it);
+    }
+}
+
+}
+
+/**
+ * Connects a server-side @ref BusConnection to a socket which is used
+ * by the test as the remote peer.
+ */
+class BusConnectionTest: public ::testing::Test {
+protected:
+
+    void SetUp() {
+        this->service.reset(new AsioServiceContext());
+        this->bus.reset(new RecordingBus());
+
+        int fds[2];
+        ASSERT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+        const boost::asio::generic::stream_protocol protocol(AF_UNIX, 0);
+        this->socket.reset(new boost::asio::generic::stream_protocol::socket(
+                               *this->service->getService(), protocol, fds[0]));
+        this->peer.reset(new boost::asio::generic::stream_protocol::socket(
+                             *this->service->getService(), protocol, fds[1]));
+    }
+
+    void TearDown() {
+        this->connection.reset();
+        this->peer.reset();
+        this->socket.reset();
+    }
+
+    void connect(unsigned int flushDelay = 0) {
+        BusOptions options;
+        options.tcpnodelay = false;
+        options.flushDelay = flushDelay;
+        connect(options);
+    }
+
+    void connect(const BusOptions& options) {
+        this->connection.reset(
+            new BusConnection(this->bus, this->socket, *this->service->getService(),
+                              false, options));
+        this->handshake = read(4);
+        this->connection->startReceiving();
+    }
+
+    void connectClient(boost::uint32_t handshake) {
+        string data;
+        appendLengthHeader(data, handshake);
+        write(data);
+        BusOptions options;
+        options.tcpnodelay = false;
+        this->connection.reset(
+            new BusConnection(this->bus, this->socket, *this->service->getService(),
+                              true, options));
+        this->connection->startReceiving();
+    }
+
+    void write(const string& data) {
+        boost::asio::write(*this->peer, boost::asio::buffer(data));
+    }
+
+    string read(size_t size) {
+        string result(size, '\0');
+        boost::asio::read(*this->peer, boost::asio::buffer(&result[0], size));
+        return result;
+    }
+
+    string readFrame() {
+        const string header = read(4);
+        return header + read(readLengthHeader(header) & FRAME_LENGTH_MASK);
+    }
+
+    AsioServiceContextPtr                                            service;
+    RecordingBusPtr                                                  bus;
+    boost::shared_ptr<boost::asio::generic::stream_protocol::socket> socket;
+    boost::shared_ptr<boost::asio::generic::stream_protocol::socket> peer;
+    BusConnectionPtr                                                 connection;
+    string                                                           handshake;
+
+};
+
+TEST_F(BusConnectionTest, testFlushDelayCoalescesFrames) {
+    const boost::posix_time::milliseconds delay(100);
+    connect(delay.total_microseconds());
+
+    vector<FramePtr> frames;
+    size_t size = 0;
+    for (unsigned int i = 0; i < 3; ++i) {
+        frames.push_back(makeFrame(Scope("/foo"), string(i * 100, 'x')));
+        size += frames.back()->size();
+    }
+
+    const boost::posix_time::ptime start
+        = boost::posix_time::microsec_clock::universal_time();
+    for (vector<FramePtr>::const_iterator it = frames.begin();
+         it != frames.end(); ++it) {
+        this->connection->sendFrame(*it);
+    }
+
+    // Nothing is written before the delay has passed. Afterwards, all
+    // frames are written at once.
+    string received = read(1);
+    EXPECT_GE(boost::posix_time::microsec_clock::universal_time() - start,
+              delay - boost::posix_time::milliseconds(10));
+    EXPECT_EQ(size - 1, this->peer->available());
+    received += read(size - 1);
+
+    string expected;
+    for (vector<FramePtr>::const_iterator it = frames.begin();
+         it != frames.end(); ++it) {
+        expected += **it;
+    }
+    EXPECT_EQ(expected, received);
+}
+
+TEST_F(BusConnectionTest, testFramesAfterFlushDelay) {
+    connect(1000);
+
+    // Frames sent after the queue has been written start a new
+    // delay.
+    for (unsigned int i = 0; i < 3; ++i) {
+        FramePtr frame = makeFrame(Scope("/foo"), string(i, 'x'));
+        this->connection->sendFrame(frame);
+        EXPECT_EQ(*frame, read(frame->size()));
+    }
+}
+
+TEST_F(BusConnectionTest, testCloseCancelsFlushTimer) {
+    connect(boost::posix_time::seconds(60).total_microseconds());
+    this->connection->sendFrame(makeFrame(Scope("/foo")));
+
+    // Closing the connection cancels the pending flush timer which
+    // would otherwise keep the connection alive.
+    boost::weak_ptr<BusConnection> weak = this->connection;
+    this->connection.reset();
+    this->peer->close();
+
+    const boost::posix_time::ptime deadline
+        = boost::posix_time::microsec_clock::universal_time()
+        + boost::posix_time::seconds(10);
+    while (!weak.expired()
+           && (boost::posix_time::microsec_clock::universal_time() < deadline)) {
+        boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    }
+    EXPECT_TRUE(weak.expired());
+}
+
+TEST_F(BusConnectionTest, testSeveralFramesInOneRead) {
+    connect();
+
+    vector<string> frames;
+    string data;
+    for (unsigned int i = 0; i < 10; ++i) {
+        frames.push_back(*makeFrame(Scope("/foo"), string(i, 'x')));
+        data += frames.back();
+    }
+    write(data);
+
+    ASSERT_TRUE(this->bus->waitForFrames(frames.size()));
+    boost::mutex::scoped_lock lock(this->bus->mutex);
+    EXPECT_EQ(frames, this->bus->frames);
+}
+
+TEST_F(BusConnectionTest, testHeaderSplitAcrossReads) {
+    connect();
+
+    const string frame = *makeFrame(Scope("/foo"), "bar");
+    write(frame.substr(0, 2));
+    boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+    write(frame.substr(2));
+
+    ASSERT_TRUE(this->bus->waitForFrames(1));
+    boost::mutex::scoped_lock lock(this->bus->mutex);
+    EXPECT_EQ(frame, this->bus->frames[0]);
+}
+
+TEST_F(BusConnectionTest, testFrameSplitAcrossReads) {
+    connect();
+
+    // The second frame is split after its header and in its body.
+    const string first  = *makeFrame(Scope("/foo"), "bar");
+    const string second = *makeFrame(Scope("/foo"), string(1000, 'x'));
+    write(first + second.substr(0, 4));
+    boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+    write(second.substr(4, 500));
+    boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+    write(second.substr(504));
+
+    ASSERT_TRUE(this->bus->waitForFrames(2));
+    boost::mutex::scoped_lock lock(this->bus->mutex);
+    EXPECT_EQ(first, this->bus->frames[0]);
+    EXPECT_EQ(second, this->bus->frames[1]);
+}
+
+TEST_F(BusConnectionTest, testFrameLargerThanReceiveBuffer) {
+    connect();
+
+    // The large frame does not fit into the receive buffer and is
+    // completed separately. Receiving continues with the following
+    // frame.
+    const string small = *makeFrame(Scope("/foo"), "bar");
+    const string large = *makeFrame(Scope("/foo"), string(200000, 'x'));
+    write(small + large + small);
+
+    ASSERT_TRUE(this->bus->waitForFrames(3));
+    boost::mutex::scoped_lock lock(this->bus->mutex);
+    EXPECT_EQ(small, this->bus->frames[0]);
+    EXPECT_EQ(large, this->bus->frames[1]);
+    EXPECT_EQ(small, this->bus->frames[2]);
+}
+
+TEST_F(BusConnectionTest, testSendDoesNotBlockOnStalledPeer) {
+    connect();
+
+    // The frames exceed the socket buffers by far. Since the peer
+    // does not read, blocking writes would not return.
+    vector<FramePtr> frames;
+    for (unsigned int i = 0; i < 100; ++i) {
+        frames.push_back(makeFrame(Scope("/foo"), string(65536, 'a' + i % 26)));
+    }
+    boost::thread sender(boost::bind(&sendFrames, this->connection, &frames));
+    const bool returned = sender.timed_join(boost::posix_time::seconds(5));
+    EXPECT_TRUE(returned);
+    if (!returned) {
+        this->peer->close();
+        sender.join();
+        return;
+    }
+
+    // The queued frames are written in order once the peer reads.
+    for (vector<FramePtr>::const_iterator it = frames.begin();
+         it != frames.end(); ++it) {
+        EXPECT_EQ(**it, read((*it)->size()));
+    }
+}
+
+TEST_F(BusConnectionTest, testStalledPeerIsDisconnected) {
+    BusOptions options;
+    options.tcpnodelay     = false;
+    options.maxQueuedBytes = 1024 * 1024;
+    connect(options);
+
+    // The peer does not read. Instead of queuing frames without
+    // bound, the connection is closed and removed from the bus once
+    // the queued frames exceed the limit.
+    for (unsigned int i = 0; i < 100; ++i) {
+        this->connection->sendFrame(makeFrame(Scope("/foo"), string(65536, 'x')));
+    }
+    EXPECT_TRUE(this->bus->waitForRemoval());
+
+    // The peer receives at most the frames which fit into the socket
+    // buffers and the queue before the connection is closed.
+    size_t received = 0;
+    char data[65536];
+    boost::system::error_code error;
+    while (!error) {
+        received += this->peer->read_some(boost::asio::buffer(data), error);
+    }
+    EXPECT_EQ(boost::asio::error::eof, error);
+    EXPECT_LT(received, 100 * 65536);
+}
+
+TEST_F(BusConnectionTest, testServerAdvertisesNegotiation) {
+    connect();
+
+    EXPECT_TRUE(readLengthHeader(this->handshake) & HANDSHAKE_NEGOTIATION_FLAG);
+}
+
+TEST_F(BusConnectionTest, testProposalsToServerWithNegotiation) {
+    connectClient(HANDSHAKE_NEGOTIATION_FLAG);
+
+    const string frame = readFrame();
+    protocol::Notification notification;
+    ASSERT_TRUE(notification.ParseFromArray(frame.data() + 4, frame.size() - 4));
+    EXPECT_TRUE(isSubscriptionNegotiationNotification(notification));
+    EXPECT_FALSE(isNegotiationAcknowledgement(notification));
+}
+
+TEST_F(BusConnectionTest, testNoProposalsToServerWithoutNegotiation) {
+    // Older bus servers send a zero handshake and would relay
+    // proposals to their other clients.
+    connectClient(0);
+
+    FramePtr frame = makeFrame(Scope("/foo"));
+    this->connection->sendFrame(frame);
+    EXPECT_EQ(*frame, readFrame());
+}
+
+TEST_F(BusConnectionTest, testFramesAreNotParsedForRelaying) {
+    connect();
+
+    // The frame lacks required fields of the notification. Since it
+    // is only parsed when a local sink is interested in it, it is
+    // passed to the bus for relaying instead of closing the
+    // connection.
+    const string scope = "/foo/";
+    string body;
+    appendBytesField(body, 6, scope.data(), scope.size());
+    string frame;
+    appendLengthHeader(frame, body.size());
+    frame += body;
+    write(frame);
+
+    ASSERT_TRUE(this->bus->waitForFrames(1));
+    boost::mutex::scoped_lock lock(this->bus->mutex);
+    EXPECT_EQ(frame, this->bus->frames[0]);
+    EXPECT_FALSE(this->bus->removed);
+}
+
+TEST_F(BusConnectionTest, testRepeatedCompressionProposalIsNotAcknowledged) {
+    BusOptions options;
+    options.tcpnodelay  = false;
+    options.compression = CODEC_LZ4;
+    connect(options);
+
+    set<string> codecs;
+    codecs.insert("lz4");
+    const FramePtr proposal = compressionToFrame(false, codecs);
+    write(*proposal);
+    write(*proposal);
+
+    protocol::Notification notification;
+    const string frame = readFrame();
+    ASSERT_TRUE(notification.ParseFromArray(frame.data() + 4, frame.size() - 4));
+    EXPECT_TRUE(isCompressionNotification(notification));
+    EXPECT_TRUE(isNegotiationAcknowledgement(notification));
+
+    // The second proposal does not change the codecs in effect, so
+    // the next frame is the event rather than another
+    // acknowledgement.
+    FramePtr event = makeFrame(Scope("/foo"));
+    this->connection->sendFrame(event);
+    EXPECT_EQ(*event, readFrame());
+}
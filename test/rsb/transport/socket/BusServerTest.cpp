@@ -0,0 +1,226 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#include <string>
+
+#include <cstdio>
+
+#include <boost/asio.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <gtest/gtest.h>
+
+#include "rsb/Event.h"
+#include "rsb/EventId.h"
+#include "rsb/transport/AsioServiceContext.h"
+#include "rsb/transport/socket/BusServerImpl.h"
+#include "rsb/transport/socket/Serialization.h"
+
+#include "testconfig.h"
+
+using namespace std;
+using namespace rsb;
+using namespace rsb::transport;
+using namespace rsb::transport::socket;
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+
+namespace {
+
+/**
+ * A bus client which speaks the protocol directly on a socket to
+ * control which notifications reach the bus server.
+ */
+class RawClient {
+public:
+    RawClient(boost::asio::io_service& service, const SocketEndpoint& endpoint) :
+        socket(service) {
+        this->socket.connect(endpoint);
+        char handshake[4];
+        boost::asio::read(this->socket, boost::asio::buffer(handshake));
+    }
+
+    void send(FramePtr frame) {
+        boost::asio::write(this->socket, boost::asio::buffer(*frame));
+    }
+
+    void send(const Scope& scope) {
+        EventPtr event(new Event(scope, boost::shared_ptr<string>(new string()),
+                                 "bytes"));
+        event->setId(rsc::misc::UUID(), 0);
+        send(eventToFrame(event, "bytes", ""));
+    }
+
+    string receiveFrame() {
+        string frame(4, '\0');
+        boost::asio::read(this->socket, boost::asio::buffer(&frame[0], 4));
+        const size_t size
+            = (((size_t) (unsigned char) frame[0]) << 0)
+            | (((size_t) (unsigned char) frame[1]) << 8)
+            | (((size_t) (unsigned char) frame[2]) << 16)
+            | (((size_t) (unsigned char) frame[3]) << 24);
+        frame.resize(4 + size);
+        boost::asio::read(this->socket, boost::asio::buffer(&frame[4], size));
+        return frame;
+    }
+
+    protocol::Notification receive() {
+        const string frame = receiveFrame();
+        protocol::Notification notification;
+        EXPECT_TRUE(notification.ParseFromArray(frame.data() + 4, frame.size() - 4));
+        return notification;
+    }
+
+private:
+    boost::asio::generic::stream_protocol::socket socket;
+};
+
+BusOptions serverOptions() {
+    BusOptions options;
+    options.waitForClientDisconnects = false;
+    return options;
+}
+
+}
+
+TEST(BusServerTest, testSubscriptionsStopForwarding) {
+    AsioServiceContextPtr service(new AsioServiceContext());
+    const SocketEndpoint endpoint = localEndpoint(
+        "@rsb-test-subscriptions-" + boost::lexical_cast<string>(SOCKET_PORT));
+    boost::shared_ptr<BusServerImpl> server(
+        new BusServerImpl(service, endpoint, serverOptions()));
+    server->activate();
+
+    RawClient subscriber(*service->getService(), endpoint);
+    RawClient publisher(*service->getService(), endpoint);
+
+    // The subscriber negotiates announcements and announces a single
+    // scope.
+    subscriber.send(subscriptionNegotiationToFrame(false));
+    protocol::Notification acknowledgement = subscriber.receive();
+    ASSERT_TRUE(isSubscriptionNegotiationNotification(acknowledgement));
+    ASSERT_TRUE(isNegotiationAcknowledgement(acknowledgement));
+    set<Scope> scopes;
+    scopes.insert(Scope("/a"));
+    subscriber.send(subscriptionsToFrame(rsc::misc::UUID(), 0, scopes));
+
+    // Since the publisher did not announce subscriptions, it receives
+    // all events. Receiving this event ensures that the bus server
+    // processed the announcement.
+    subscriber.send(Scope("/sync"));
+    EXPECT_EQ(Scope("/sync").toString(), publisher.receive().scope());
+
+    // Events on other scopes are not forwarded to the subscriber.
+    publisher.send(Scope("/b"));
+    publisher.send(Scope("/a/b"));
+    EXPECT_EQ(Scope("/a/b").toString(), subscriber.receive().scope());
+
+    server->deactivate();
+}
+
+TEST(BusServerTest, testAnnouncementsWithoutNegotiationAreIgnored) {
+    AsioServiceContextPtr service(new AsioServiceContext());
+    const SocketEndpoint endpoint = localEndpoint(
+        "@rsb-test-subscriptions-" + boost::lexical_cast<string>(SOCKET_PORT));
+    boost::shared_ptr<BusServerImpl> server(
+        new BusServerImpl(service, endpoint, serverOptions()));
+    server->activate();
+
+    RawClient subscriber(*service->getService(), endpoint);
+    RawClient publisher(*service->getService(), endpoint);
+
+    // An announcement which has not been negotiated does not restrict
+    // the events the subscriber receives.
+    set<Scope> scopes;
+    scopes.insert(Scope("/a"));
+    subscriber.send(subscriptionsToFrame(rsc::misc::UUID(), 0, scopes));
+    subscriber.send(Scope("/sync"));
+    EXPECT_EQ(Scope("/sync").toString(), publisher.receive().scope());
+
+    publisher.send(Scope("/b"));
+    EXPECT_EQ(Scope("/b").toString(), subscriber.receive().scope());
+
+    server->deactivate();
+}
+
+TEST(BusServerTest, testFramesAreRelayedVerbatim) {
+    AsioServiceContextPtr service(new AsioServiceContext());
+    const SocketEndpoint endpoint = localEndpoint(
+        "@rsb-test-relay-" + boost::lexical_cast<string>(SOCKET_PORT));
+    boost::shared_ptr<BusServerImpl> server(
+        new BusServerImpl(service, endpoint, serverOptions()));
+    server->activate();
+
+    RawClient receiver(*service->getService(), endpoint);
+    RawClient sender(*service->getService(), endpoint);
+
+    // Append a field which is unknown to the bus server (field number
+    // 100, varint 42). Frames are relayed without re-encoding the
+    // notification and therefore arrive unmodified.
+    EventPtr event(new Event(Scope("/relay"),
+                             boost::shared_ptr<string>(new string("payload")),
+                             "bytes"));
+    event->setId(rsc::misc::UUID(), 7);
+    string frame = *eventToFrame(event, "bytes", "payload");
+    frame += "\xa0\x06\x2a";
+    frame[0] = static_cast<char>(frame[0] + 3);
+    ASSERT_LT(frame.size(), 256u);
+
+    sender.send(FramePtr(new string(frame)));
+    EXPECT_EQ(frame, receiver.receiveFrame());
+
+    server->deactivate();
+}
+
+TEST(BusServerTest, testStaleSocketFileIsRemoved) {
+    AsioServiceContextPtr service(new AsioServiceContext());
+    const string path
+        = "/tmp/rsb-test-stale-" + boost::lexical_cast<string>(SOCKET_PORT);
+    const SocketEndpoint endpoint = localEndpoint(path);
+    std::remove(path.c_str());
+
+    // Closing a bound socket leaves its socket file behind, like a
+    // crashed server process.
+    {
+        boost::asio::basic_socket_acceptor<boost::asio::generic::stream_protocol>
+            stale(*service->getService(), endpoint);
+    }
+
+    boost::shared_ptr<BusServerImpl> server(
+        new BusServerImpl(service, endpoint, serverOptions()));
+    server->activate();
+    RawClient client(*service->getService(), endpoint);
+
+    // The socket file of a running server is not removed.
+    EXPECT_THROW(BusServerImpl(service, endpoint, serverOptions()),
+                 boost::system::system_error);
+    RawClient other(*service->getService(), endpoint);
+
+    server->deactivate();
+    std::remove(path.c_str());
+}
+
+#endif
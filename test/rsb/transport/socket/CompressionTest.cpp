@@ -0,0 +1,168 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include "rsb/Event.h"
+#include "rsb/protocol/ProtocolException.h"
+#include "rsb/transport/socket/Compression.h"
+#include "rsb/transport/socket/HeaderDictionary.h"
+
+using namespace std;
+using namespace rsb;
+using namespace rsb::transport::socket;
+
+namespace {
+
+FramePtr makeFrame(const string& data) {
+    EventPtr event(new Event(Scope("/compression"),
+                             boost::shared_ptr<string>(new string(data)),
+                             "bytes", "METHOD"));
+    event->setId(rsc::misc::UUID(), 1);
+    return eventToFrame(event, "bytes", data);
+}
+
+string compressibleData(size_t size) {
+    string result;
+    while (result.size() < size) {
+        result += "0123456789abcdef";
+    }
+    return result.substr(0, size);
+}
+
+}
+
+TEST(CompressionTest, testParseCodec) {
+    EXPECT_EQ(CODEC_NONE, parseCodec("none"));
+    EXPECT_THROW(parseCodec("no-such-codec"), invalid_argument);
+
+    CodecSet codecs = availableCodecs();
+    for (CodecSet::const_iterator it = codecs.begin(); it != codecs.end(); ++it) {
+        EXPECT_EQ(*it, parseCodec(codecName(*it)));
+    }
+    EXPECT_EQ(codecs, parseCodecs(codecNames(codecs)));
+}
+
+TEST(CompressionTest, testUncompressed) {
+    FramePtr frame = makeFrame(compressibleData(10000));
+
+    EXPECT_FALSE(isCompressedFrame(*frame));
+    EXPECT_EQ(CODEC_NONE, frameCodec(*frame));
+    EXPECT_EQ(frame, compressFrame(frame, CODEC_NONE, 0));
+    EXPECT_EQ(frame, decompressFrame(frame));
+
+    FrameVariants variants(frame);
+    EXPECT_EQ(frame, variants.getFrame(CODEC_NONE, 0, availableCodecs()));
+}
+
+TEST(CompressionTest, testRoundtrip) {
+    CodecSet codecs = availableCodecs();
+    for (CodecSet::const_iterator it = codecs.begin(); it != codecs.end(); ++it) {
+        SCOPED_TRACE(codecName(*it));
+
+        // Payloads below the threshold are not compressed.
+        FramePtr small = makeFrame(compressibleData(100));
+        EXPECT_EQ(small, compressFrame(small, *it, 1024));
+
+        FramePtr frame      = makeFrame(compressibleData(100000));
+        FramePtr compressed = compressFrame(frame, *it, 1024);
+        EXPECT_TRUE(isCompressedFrame(*compressed));
+        EXPECT_EQ(*it, frameCodec(*compressed));
+        EXPECT_LT(compressed->size(), frame->size() / 2);
+        EXPECT_EQ(*frame, *decompressFrame(compressed));
+
+        // Compressed frames can be encoded using a header dictionary.
+        HeaderDictionaryEncoder encoder;
+        HeaderDictionaryDecoder decoder;
+        FramePtr encoded = encoder.encode(compressed);
+        EXPECT_TRUE(isHeaderDictionaryFrame(*encoded));
+        EXPECT_TRUE(isCompressedFrame(*encoded));
+        EXPECT_EQ(*compressed, *decoder.decode(encoded));
+    }
+}
+
+TEST(CompressionTest, testFrameVariants) {
+    CodecSet codecs = availableCodecs();
+    for (CodecSet::const_iterator it = codecs.begin(); it != codecs.end(); ++it) {
+        SCOPED_TRACE(codecName(*it));
+
+        FramePtr frame = makeFrame(compressibleData(100000));
+        CodecSet peerCodecs;
+        peerCodecs.insert(*it);
+
+        // Uncompressed frames are compressed once for peers which can
+        // decompress them.
+        FrameVariants variants(frame);
+        EXPECT_EQ(frame, variants.getFrame(*it, 1024, CodecSet()));
+        FramePtr compressed = variants.getFrame(*it, 1024, peerCodecs);
+        EXPECT_TRUE(isCompressedFrame(*compressed));
+        EXPECT_EQ(compressed, variants.getFrame(*it, 1024, peerCodecs));
+
+        // Compressed frames are decompressed once for peers which
+        // cannot decompress them.
+        FrameVariants received(compressed);
+        EXPECT_EQ(compressed, received.getFrame(CODEC_NONE, 0, peerCodecs));
+        FramePtr decompressed = received.getFrame(CODEC_NONE, 0, CodecSet());
+        EXPECT_EQ(*frame, *decompressed);
+        EXPECT_EQ(decompressed, received.getFrame(CODEC_NONE, 0, CodecSet()));
+    }
+}
+
+TEST(CompressionTest, testFrameVariantsCompressionFailure) {
+    // Codecs which fail to compress the payload fall back to the
+    // uncompressed frame.
+    const Codec invalid = static_cast<Codec>(99);
+    CodecSet peerCodecs;
+    peerCodecs.insert(invalid);
+
+    FramePtr frame = makeFrame(compressibleData(100000));
+    FrameVariants variants(frame);
+    EXPECT_EQ(frame, variants.getFrame(invalid, 0, peerCodecs));
+    EXPECT_EQ(frame, variants.getFrame(invalid, 0, peerCodecs));
+}
+
+TEST(CompressionTest, testFrameVariantsMalformed) {
+    // Payload announcing 1000 uncompressed LZ4 bytes followed by
+    // garbage.
+    string data;
+    data.push_back(static_cast<char>(CODEC_LZ4));
+    data += "\xe8\x07garbage";
+    boost::shared_ptr<string> malformed(new string(*makeFrame(data)));
+    (*malformed)[3] |= static_cast<char>(COMPRESSION_FLAG >> 24);
+    FramePtr frame(malformed);
+    ASSERT_THROW(decompressFrame(frame), protocol::ProtocolException);
+
+    // Peers which can decompress the frame receive it as it is,
+    // other peers do not receive it.
+    CodecSet peerCodecs;
+    peerCodecs.insert(CODEC_LZ4);
+    FrameVariants variants(frame);
+    EXPECT_EQ(frame, variants.getFrame(CODEC_NONE, 0, peerCodecs));
+    EXPECT_FALSE(variants.getFrame(CODEC_NONE, 0, CodecSet()));
+    EXPECT_FALSE(variants.getFrame(CODEC_NONE, 0, CodecSet()));
+}
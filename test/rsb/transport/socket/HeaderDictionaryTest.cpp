@@ -0,0 +1,90 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#include <gtest/gtest.h>
+
+#include "rsb/Event.h"
+#include "rsb/protocol/ProtocolException.h"
+#include "rsb/transport/socket/HeaderDictionary.h"
+
+using namespace std;
+using namespace rsb;
+using namespace rsb::transport::socket;
+
+namespace {
+
+FramePtr makeFrame(const string& scope, boost::uint32_t sequenceNumber,
+                   const string& data) {
+    EventPtr event(new Event(Scope(scope),
+                             boost::shared_ptr<string>(new string(data)),
+                             "bytes", "METHOD"));
+    event->setId(rsc::misc::UUID(), sequenceNumber);
+    return eventToFrame(event, "bytes", data);
+}
+
+}
+
+TEST(HeaderDictionaryTest, testRoundtrip) {
+    HeaderDictionaryEncoder encoder;
+    HeaderDictionaryDecoder decoder;
+
+    const char* scopes[] = { "/a/", "/b/", "/a/", "/a/", "/b/" };
+    for (unsigned int i = 0; i < 5; ++i) {
+        FramePtr frame   = makeFrame(scopes[i], i * 1000, string(60, 'x'));
+        FramePtr encoded = encoder.encode(frame);
+        EXPECT_TRUE(isHeaderDictionaryFrame(*encoded));
+        EXPECT_FALSE(isHeaderDictionaryFrame(*frame));
+        EXPECT_EQ(*frame, *decoder.decode(encoded));
+        if (i >= 2) {
+            EXPECT_LT(encoded->size() + 20, frame->size());
+        }
+    }
+    EXPECT_EQ(2u, encoder.size());
+}
+
+TEST(HeaderDictionaryTest, testFullDictionary) {
+    HeaderDictionaryEncoder encoder(1);
+
+    FramePtr first = makeFrame("/a/", 1, "");
+    EXPECT_TRUE(isHeaderDictionaryFrame(*encoder.encode(first)));
+
+    // Tuples which do not fit into the dictionary are sent
+    // unmodified.
+    FramePtr second = makeFrame("/b/", 2, "");
+    EXPECT_EQ(second, encoder.encode(second));
+    EXPECT_EQ(1u, encoder.size());
+}
+
+TEST(HeaderDictionaryTest, testUnknownId) {
+    HeaderDictionaryEncoder encoder;
+    HeaderDictionaryDecoder decoder;
+
+    encoder.encode(makeFrame("/a/", 1, ""));
+    FramePtr reference = encoder.encode(makeFrame("/a/", 2, ""));
+
+    // The decoder did not see the definition.
+    EXPECT_THROW(decoder.decode(reference), protocol::ProtocolException);
+}
@@ -0,0 +1,118 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "rsb/Event.h"
+#include "rsb/EventId.h"
+#include "rsb/MetaData.h"
+#include "rsb/transport/socket/OutgoingEvent.h"
+
+using namespace std;
+using namespace rsb;
+using namespace rsb::converter;
+using namespace rsb::transport::socket;
+
+namespace {
+
+/**
+ * A converter for std::string payloads which counts its invocations.
+ */
+class CountingConverter: public Converter<string> {
+public:
+    CountingConverter() :
+        Converter<string>("std::string", "counting", true), serialized(0) {
+    }
+
+    string serialize(const AnnotatedData& data, string& wire) {
+        ++this->serialized;
+        wire = *boost::static_pointer_cast<string>(data.second);
+        return getWireSchema();
+    }
+
+    AnnotatedData deserialize(const string& /*wireSchema*/,
+                              const string& wire) {
+        return make_pair(getDataType(), VoidPtr(new string(wire)));
+    }
+
+    unsigned int serialized;
+};
+
+EventPtr makeEvent(const string& data) {
+    EventPtr event(new Event(Scope("/foo"),
+                             boost::shared_ptr<string>(new string(data)),
+                             "std::string"));
+    event->setId(rsc::misc::UUID(), 1);
+    return event;
+}
+
+}
+
+TEST(OutgoingEventTest, testSerializeOnce) {
+    boost::shared_ptr<CountingConverter> converter(new CountingConverter());
+    EventPtr event = makeEvent("payload");
+    OutgoingEvent outgoing(event, converter);
+    EXPECT_FALSE(outgoing.isSerialized());
+
+    // The payload is serialized and the frame is produced once, no
+    // matter how many connections request it.
+    FramePtr frame = outgoing.getFrame();
+    EXPECT_EQ(frame, outgoing.getFrame());
+    EXPECT_EQ(&outgoing.getFrames(), &outgoing.getFrames());
+    EXPECT_EQ(frame, outgoing.getFrames().getFrame(CODEC_NONE, 0, CodecSet()));
+    EXPECT_EQ("counting", outgoing.getWireSchema());
+    EXPECT_EQ("payload", *outgoing.getWireData());
+    EXPECT_EQ(1u, converter->serialized);
+
+    EXPECT_EQ("counting", event->getMetaData().getUserInfo("rsb.wire-schema"));
+    EXPECT_EQ(*eventToFrame(event, "counting", "payload"), *frame);
+}
+
+TEST(OutgoingEventTest, testDeclaredWireSchema) {
+    boost::shared_ptr<CountingConverter> converter(new CountingConverter());
+    EventPtr event = makeEvent("payload");
+    OutgoingEvent outgoing(event, converter);
+
+    // The declared wire-schema is available without serializing the
+    // payload.
+    EXPECT_EQ("counting", outgoing.getDeclaredWireSchema());
+    EXPECT_EQ(0u, converter->serialized);
+    EXPECT_FALSE(event->getMetaData().hasUserInfo("rsb.wire-schema"));
+}
+
+TEST(OutgoingEventTest, testSerializedPayload) {
+    EventPtr event = makeEvent("payload");
+    event->mutableMetaData().setUserInfo("rsb.wire-schema", "counting");
+    OutgoingEvent outgoing(event);
+    EXPECT_TRUE(outgoing.isSerialized());
+
+    // Serialized payloads are used without copying them.
+    EXPECT_EQ(event->getData(), outgoing.getWireData());
+    EXPECT_EQ("counting", outgoing.getWireSchema());
+    EXPECT_EQ(*eventToFrame(event, "counting", "payload"), *outgoing.getFrame());
+}
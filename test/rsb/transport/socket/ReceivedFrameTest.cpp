@@ -0,0 +1,184 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "rsb/Event.h"
+#include "rsb/EventId.h"
+#include "rsb/MetaData.h"
+#include "rsb/protocol/ProtocolException.h"
+#include "rsb/transport/socket/ReceivedFrame.h"
+#include "rsb/transport/socket/WireFormat.h"
+
+using namespace std;
+using namespace rsb;
+using namespace rsb::converter;
+using namespace rsb::transport::socket;
+
+namespace {
+
+/**
+ * A converter for std::string payloads which counts its invocations.
+ */
+class CountingConverter: public Converter<string> {
+public:
+    CountingConverter() :
+        Converter<string>("std::string", "counting", true), deserialized(0),
+        lastWire(0) {
+    }
+
+    string serialize(const AnnotatedData& data, string& wire) {
+        wire = *boost::static_pointer_cast<string>(data.second);
+        return getWireSchema();
+    }
+
+    AnnotatedData deserialize(const string& /*wireSchema*/,
+                              const string& wire) {
+        ++this->deserialized;
+        this->lastWire = &wire;
+        return make_pair(getDataType(), VoidPtr(new string(wire)));
+    }
+
+    unsigned int  deserialized;
+    const string* lastWire;
+};
+
+typedef boost::shared_ptr<CountingConverter> CountingConverterPtr;
+
+FramePtr makeFrame(const string& data) {
+    EventPtr event(new Event(Scope("/foo/bar"),
+                             boost::shared_ptr<string>(new string(data)),
+                             "std::string"));
+    event->setId(rsc::misc::UUID(), 1);
+    return eventToFrame(event, "counting", data);
+}
+
+// Produces a frame which only contains a scope field and thus lacks
+// required fields of the notification.
+FramePtr makeScopeOnlyFrame(const string& scope) {
+    string body;
+    appendBytesField(body, 6, scope.data(), scope.size());
+    string frame;
+    appendLengthHeader(frame, body.size());
+    return FramePtr(new string(frame + body));
+}
+
+}
+
+TEST(ReceivedFrameTest, testDeserializeOncePerConverter) {
+    FramePtr frame = makeFrame("payload");
+    protocol::Notification notification;
+    ReceivedFrame received(frame, notification);
+
+    CountingConverterPtr first(new CountingConverter());
+    CountingConverterPtr second(new CountingConverter());
+
+    // Sinks selecting the same converter share the loader. Payloads
+    // are only deserialized when a sink requests them.
+    Event::DataLoader loader1 = received.getDataLoader(first);
+    Event::DataLoader loader2 = received.getDataLoader(first);
+    Event::DataLoader loader3 = received.getDataLoader(second);
+    EXPECT_EQ(0u, first->deserialized);
+    EXPECT_EQ(0u, second->deserialized);
+
+    VoidPtr data = loader1();
+    EXPECT_EQ("payload", *boost::static_pointer_cast<string>(data));
+    EXPECT_EQ(data, loader2());
+    EXPECT_EQ(data, loader1());
+    EXPECT_EQ(1u, first->deserialized);
+
+    // Other converters deserialize separately.
+    VoidPtr other = loader3();
+    EXPECT_NE(data, other);
+    EXPECT_EQ("payload", *boost::static_pointer_cast<string>(other));
+    EXPECT_EQ(1u, second->deserialized);
+}
+
+TEST(ReceivedFrameTest, testLoaderOutlivesFrame) {
+    FramePtr frame = makeFrame("payload");
+    Event::DataLoader loader;
+    CountingConverterPtr converter(new CountingConverter());
+    {
+        protocol::Notification notification;
+        ReceivedFrame received(frame, notification);
+        loader = received.getDataLoader(converter);
+    }
+    EXPECT_EQ("payload", *boost::static_pointer_cast<string>(loader()));
+    EXPECT_EQ(1u, converter->deserialized);
+}
+
+TEST(ReceivedFrameTest, testPayloadIsNotCopied) {
+    const string payload(1000000, 'x');
+    FramePtr frame = makeFrame(payload);
+    protocol::Notification notification;
+    ReceivedFrame received(frame, notification);
+    const char* parsed = received.getNotification().data().data();
+
+    // The payload is moved out of the notification into the event.
+    EventPtr event = received.getEvent();
+    EXPECT_EQ(event, received.getEvent());
+    EXPECT_TRUE(notification.data().empty());
+    boost::shared_ptr<string> data
+        = boost::static_pointer_cast<string>(event->getData());
+    EXPECT_EQ(payload, *data);
+    EXPECT_EQ(parsed, data->data());
+    EXPECT_EQ("counting", event->getMetaData().getUserInfo("rsb.wire-schema"));
+
+    // The converter receives the payload of the event itself.
+    CountingConverterPtr converter(new CountingConverter());
+    received.getDataLoader(converter)();
+    EXPECT_EQ(data.get(), converter->lastWire);
+}
+
+TEST(ReceivedFrameTest, testScopeWithoutParsing) {
+    FramePtr frame = makeFrame("payload");
+    protocol::Notification notification;
+    ReceivedFrame received(frame, notification);
+
+    // Only the scope is read until the event is requested.
+    EXPECT_EQ(Scope("/foo/bar"), received.getScope());
+    EXPECT_FALSE(notification.has_scope());
+    EXPECT_EQ(frame, received.getFrame());
+
+    EXPECT_EQ(Scope("/foo/bar"), received.getEvent()->getScope());
+    EXPECT_TRUE(notification.has_scope());
+}
+
+TEST(ReceivedFrameTest, testMalformedFrame) {
+    // The scope of frames lacking other required fields can be read.
+    // Parsing them fails only when the event is requested.
+    FramePtr frame = makeScopeOnlyFrame("/foo/");
+    protocol::Notification notification;
+    ReceivedFrame received(frame, notification);
+    EXPECT_EQ(Scope("/foo"), received.getScope());
+    EXPECT_THROW(received.getEvent(), protocol::ProtocolException);
+
+    // Frames without scope are rejected immediately.
+    FramePtr empty(new string(4, '\0'));
+    EXPECT_THROW(ReceivedFrame(empty, notification), protocol::ProtocolException);
+}
@@ -0,0 +1,105 @@
+/* ============================================================
+ *
+ * This file is part of the RSB project
+ *
+ * Copyright (C) 2018 Jan Moringen <jmoringe@techfak.uni-bielefeld.de>
+ *
+ * This file may be licensed under the terms of the
+ * GNU Lesser General Public License Version 3 (the ``LGPL''),
+ * or (at your option) any later version.
+ *
+ * Software distributed under the License is distributed
+ * on an ``AS IS'' basis, WITHOUT WARRANTY OF ANY KIND, either
+ * express or implied. See the LGPL for the specific language
+ * governing rights and limitations.
+ *
+ * You should have received a copy of the LGPL along with this
+ * program. If not, go to http://www.gnu.org/licenses/lgpl.html
+ * or write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The development of this software was supported by:
+ *   CoR-Lab, Research Institute for Cognition and Robotics
+ *     Bielefeld University
+ *
+ * ============================================================ */
+
+#include <gtest/gtest.h>
+
+#include "rsb/Event.h"
+#include "rsb/EventId.h"
+#include "rsb/MetaData.h"
+#include "rsb/transport/socket/Serialization.h"
+
+using namespace std;
+using namespace rsb;
+using namespace rsb::transport::socket;
+
+namespace {
+
+// Produces a frame by serializing a protocol::Notification object.
+string referenceFrame(EventPtr      event,
+                      const string& wireSchema,
+                      const string& data) {
+    protocol::Notification notification;
+    eventToNotification(notification, event, wireSchema, data);
+    string body;
+    notification.SerializeToString(&body);
+
+    string frame(4, '\0');
+    frame[0] = (body.size() & 0x000000fful) >> 0;
+    frame[1] = (body.size() & 0x0000ff00ul) >> 8;
+    frame[2] = (body.size() & 0x00ff0000ul) >> 16;
+    frame[3] = (body.size() & 0xff000000ul) >> 24;
+    return frame + body;
+}
+
+}
+
+TEST(SerializationTest, testEventToFrameMinimal) {
+    EventPtr event(new Event(Scope("/"), boost::shared_ptr<string>(new string()),
+                             "bytes"));
+    event->setId(rsc::misc::UUID(), 0);
+
+    EXPECT_EQ(referenceFrame(event, "", ""), *eventToFrame(event, "", ""));
+}
+
+TEST(SerializationTest, testEventToFrameComplete) {
+    // Large payload, sequence number and times exercise multi-byte
+    // varints.
+    const string data(200000, 'x');
+    EventPtr event(new Event(Scope("/a/scope/"),
+                             boost::shared_ptr<string>(new string(data)),
+                             "bytes", "REQUEST"));
+    event->setId(rsc::misc::UUID(), 0xfffffffful);
+    event->mutableMetaData().setCreateTime((boost::uint64_t) 1234567890123456ull);
+    event->mutableMetaData().setSendTime((boost::uint64_t) 1234567890123457ull);
+    event->mutableMetaData().setUserInfo("key", "value");
+    event->mutableMetaData().setUserInfo("other", string(300, 'v'));
+    event->mutableMetaData().setUserTime("time", (boost::uint64_t) 42);
+    event->addCause(EventId(rsc::misc::UUID(), 1));
+    event->addCause(EventId(rsc::misc::UUID(), 300));
+
+    FramePtr frame = eventToFrame(event, ".*", data);
+    EXPECT_EQ(referenceFrame(event, ".*", data), *frame);
+
+    protocol::Notification notification;
+    ASSERT_TRUE(notification.ParseFromArray(frame->data() + 4, frame->size() - 4));
+    EventPtr decoded = notificationToEvent(notification);
+    EXPECT_EQ(*event->getScopePtr(), *decoded->getScopePtr());
+    EXPECT_EQ("REQUEST", decoded->getMethod());
+    EXPECT_EQ(event->getId(), decoded->getId());
+    EXPECT_EQ(event->getCauses(), decoded->getCauses());
+    EXPECT_EQ("value", decoded->getMetaData().getUserInfo("key"));
+    EXPECT_EQ(data, *boost::static_pointer_cast<string>(decoded->getData()));
+}
+
+TEST(SerializationTest, testCheckFrameSize) {
+    // Encoding a notification of the maximum size would require
+    // 1 GiB of memory, so the size check is tested separately.
+    EXPECT_NO_THROW(checkFrameSize(0));
+    EXPECT_NO_THROW(checkFrameSize(FRAME_LENGTH_MASK));
+    EXPECT_THROW(checkFrameSize((size_t) FRAME_LENGTH_MASK + 1),
+                 invalid_argument);
+    EXPECT_THROW(checkFrameSize(0xfffffffful), invalid_argument);
+}
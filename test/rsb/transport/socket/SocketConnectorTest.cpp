@@ -27,16 +27,27 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include "rsb/Handler.h"
+
 #include "rsb/converter/Repository.h"
+#include "rsb/converter/PredicateConverterList.h"
+#include "rsb/converter/ByteArrayConverter.h"
+#include "rsb/converter/StringConverter.h"
 
 #include "rsb/transport/socket/InConnector.h"
 #include "rsb/transport/socket/OutConnector.h"
 
 #include "testconfig.h"
 #include "../ConnectorTest.h"
+#include "../../InformerTask.h"
 
 using namespace std;
 using namespace testing;
+using namespace rsb;
 using namespace rsb::converter;
 
 static int dummy
@@ -45,13 +56,20 @@ __attribute__((used))
 #endif
 = pullInConnectorTest();
 
+rsb::transport::socket::BusOptions socketOptions(const string& path = "") {
+    rsb::transport::socket::BusOptions options;
+    options.host = "localhost";
+    options.port = SOCKET_PORT;
+    options.path = path;
+    return options;
+}
+
 rsb::transport::InConnectorPtr createSocketInConnector() {
     return rsb::transport::InConnectorPtr(
             new rsb::transport::socket::InConnector(
                     rsb::transport::socket::getDefaultFactory(),
                     converterRepository<string>()->getConvertersForDeserialization(),
-                    "localhost", SOCKET_PORT,
-                    rsb::transport::socket::SERVER_AUTO, true, true));
+                    socketOptions()));
 }
 
 rsb::transport::OutConnectorPtr createSocketOutConnector() {
@@ -59,8 +77,7 @@ rsb::transport::OutConnectorPtr createSocketOutConnector() {
             new rsb::transport::socket::OutConnector(
                     rsb::transport::socket::getDefaultFactory(),
                     converterRepository<string>()->getConvertersForSerialization(),
-                    "localhost", SOCKET_PORT,
-                    rsb::transport::socket::SERVER_AUTO, true, true));
+                    socketOptions()));
 }
 
 const ConnectorTestSetup socketSetup(createSocketInConnector,
@@ -68,3 +85,151 @@ const ConnectorTestSetup socketSetup(createSocketInConnector,
 
 INSTANTIATE_TEST_CASE_P(SocketConnector, ConnectorTest,
         ::testing::Values(socketSetup));
+
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+
+string localSocketPath() {
+    return "@rsb-test-" + boost::lexical_cast<string>(SOCKET_PORT);
+}
+
+rsb::transport::InConnectorPtr createLocalSocketInConnector() {
+    return rsb::transport::InConnectorPtr(
+            new rsb::transport::socket::InConnector(
+                    rsb::transport::socket::getDefaultFactory(),
+                    converterRepository<string>()->getConvertersForDeserialization(),
+                    socketOptions(localSocketPath())));
+}
+
+rsb::transport::OutConnectorPtr createLocalSocketOutConnector() {
+    return rsb::transport::OutConnectorPtr(
+            new rsb::transport::socket::OutConnector(
+                    rsb::transport::socket::getDefaultFactory(),
+                    converterRepository<string>()->getConvertersForSerialization(),
+                    socketOptions(localSocketPath())));
+}
+
+const ConnectorTestSetup localSocketSetup(createLocalSocketInConnector,
+                                          createLocalSocketOutConnector);
+
+INSTANTIATE_TEST_CASE_P(LocalSocketConnector, ConnectorTest,
+        ::testing::Values(localSocketSetup));
+
+#endif
+
+TEST(SocketConnectorTest, testLocalDeliveryWithDifferentConverter) {
+    // The receiving connector only knows the bytearray converter,
+    // which produces a different data type than the sending
+    // connector's std::string data. Local delivery must not hand
+    // the sender's data object to the receiver in that case.
+    ConverterPredicatePtr always(new AlwaysApplicable());
+    Converter<string>::Ptr byteArray(new ByteArrayConverter());
+    list< pair<ConverterPredicatePtr, Converter<string>::Ptr> > converters;
+    converters.push_back(make_pair(always, byteArray));
+    ConverterSelectionStrategy<string>::Ptr deserialization(
+            new PredicateConverterList<string>(converters.begin(),
+                                               converters.end()));
+
+    rsb::transport::InConnectorPtr in(
+            new rsb::transport::socket::InConnector(
+                    rsb::transport::socket::getDefaultFactory(),
+                    deserialization, socketOptions()));
+    const Scope scope("/localdelivery/converter");
+    in->setScope(scope);
+    in->activate();
+    test::WaitingObserver observer(1, scope);
+    in->addHandler(HandlerPtr(new EventFunctionHandler(
+            boost::bind(&test::WaitingObserver::handler, &observer, _1))));
+
+    rsb::transport::OutConnectorPtr out = createSocketOutConnector();
+    out->activate();
+
+    EventPtr event(new Event(scope,
+                             boost::shared_ptr<string>(new string("foo")),
+                             rsc::runtime::typeName<string>()));
+    out->handle(event);
+
+    ASSERT_TRUE(observer.waitReceived(10000));
+    EventPtr received = observer.getEvents()[0];
+    EXPECT_EQ(byteArray->getDataType(), received->getType());
+    EXPECT_EQ("foo", *boost::static_pointer_cast<string>(received->getData()));
+    EXPECT_EQ(StringConverter().getWireSchema(),
+              received->getMetaData().getUserInfo("rsb.wire-schema"));
+
+    out->deactivate();
+    in->deactivate();
+}
+
+namespace {
+
+/**
+ * A converter for std::string payloads which counts how often it
+ * serializes payloads.
+ */
+class CountingConverter: public Converter<string> {
+public:
+    CountingConverter() :
+        Converter<string>(rsc::runtime::typeName<string>(), "counting", true),
+        serialized(0) {
+    }
+
+    string serialize(const AnnotatedData& data, string& wire) {
+        ++this->serialized;
+        wire = *boost::static_pointer_cast<string>(data.second);
+        return getWireSchema();
+    }
+
+    AnnotatedData deserialize(const string& /*wireSchema*/,
+                              const string& wire) {
+        return make_pair(getDataType(), VoidPtr(new string(wire)));
+    }
+
+    unsigned int serialized;
+};
+
+ConverterSelectionStrategy<string>::Ptr alwaysUse(Converter<string>::Ptr converter) {
+    ConverterPredicatePtr always(new AlwaysApplicable());
+    list< pair<ConverterPredicatePtr, Converter<string>::Ptr> > converters;
+    converters.push_back(make_pair(always, converter));
+    return ConverterSelectionStrategy<string>::Ptr(
+            new PredicateConverterList<string>(converters.begin(),
+                                               converters.end()));
+}
+
+}
+
+TEST(SocketConnectorTest, testLocalDeliveryWithoutSerialization) {
+    // Both connectors use the same converter. Local delivery selects
+    // it via its declared wire-schema and passes the original payload
+    // without serializing it.
+    boost::shared_ptr<CountingConverter> counting(new CountingConverter());
+
+    rsb::transport::InConnectorPtr in(
+            new rsb::transport::socket::InConnector(
+                    rsb::transport::socket::getDefaultFactory(),
+                    alwaysUse(counting), socketOptions()));
+    const Scope scope("/localdelivery/serialization");
+    in->setScope(scope);
+    in->activate();
+    test::WaitingObserver observer(1, scope);
+    in->addHandler(HandlerPtr(new EventFunctionHandler(
+            boost::bind(&test::WaitingObserver::handler, &observer, _1))));
+
+    rsb::transport::OutConnectorPtr out(
+            new rsb::transport::socket::OutConnector(
+                    rsb::transport::socket::getDefaultFactory(),
+                    alwaysUse(counting), socketOptions()));
+    out->activate();
+
+    boost::shared_ptr<string> data(new string("foo"));
+    EventPtr event(new Event(scope, data, rsc::runtime::typeName<string>()));
+    out->handle(event);
+
+    ASSERT_TRUE(observer.waitReceived(10000));
+    EventPtr received = observer.getEvents()[0];
+    EXPECT_EQ(data, received->getData());
+    EXPECT_EQ("counting", received->getMetaData().getUserInfo("rsb.wire-schema"));
+    EXPECT_EQ(0u, counting->serialized);
+
+    out->deactivate();
+    in->deactivate();
+}
@@ -44,6 +44,18 @@ using namespace rsb::transport::socket;
 using namespace rsb::converter;
 using namespace testing;
 
+namespace {
+
+BusOptions routingOptions(Server server) {
+    BusOptions options;
+    options.host   = "localhost";
+    options.port   = SOCKET_PORT;
+    options.server = server;
+    return options;
+}
+
+}
+
 TEST(SocketServerRoutingTest, testEventRouting) {
 
     ::rsb::getFactory();
@@ -52,22 +64,19 @@ TEST(SocketServerRoutingTest, testEventRouting) {
             new rsb::transport::socket::OutConnector(
                     getDefaultFactory(),
                     converterRepository<string>()->getConvertersForSerialization(),
-                    "localhost", SOCKET_PORT, rsb::transport::socket::SERVER_YES,
-                    true, true));
+                    routingOptions(SERVER_YES)));
 
     rsb::transport::InConnectorPtr clientReceiver(
             new rsb::transport::socket::InConnector(
                     getDefaultFactory(),
                     converterRepository<string>()->getConvertersForDeserialization(),
-                    "localhost", SOCKET_PORT, rsb::transport::socket::SERVER_NO,
-                    true, true));
+                    routingOptions(SERVER_NO)));
 
     rsb::transport::InConnectorPtr serverReceiver(
             new rsb::transport::socket::InConnector(
                     getDefaultFactory(),
                     converterRepository<string>()->getConvertersForDeserialization(),
-                    "localhost", SOCKET_PORT,
-                    rsb::transport::socket::SERVER_YES, true, true));
+                    routingOptions(SERVER_YES)));
 
     Scope scope("/test/scope");
 